@@ -36,6 +36,9 @@
 #include "src/support/test.h"
 #include "src/module/llvm_pass.h"
 
+// longest value of a -flag=value argument, the file and folder settings hold this much
+#define MAX_FLAG_VALUE 300
+
 void print_help_msg(uint32_t argc, char* argv[], uint32_t num_generations, uint32_t num_population_size, uint32_t percent_crossover, uint32_t percent_mutation, uint32_t percent_elite, uint32_t tournament_size, bool visualization);
 void print_launch_msg(uint32_t num_generations, uint32_t num_population_size, uint32_t percent_crossover, uint32_t percent_mutation, uint32_t percent_elite, uint32_t tournament_size, bool visualization);
 void process_params(uint32_t argc, char* argv[], uint32_t *num_generations, uint32_t *num_population_size, uint32_t *percent_crossover, uint32_t *percent_mutation, uint32_t *percent_elite, uint32_t *tournament_size, bool *visualization);
@@ -48,6 +51,9 @@ osaka_object_typ set_obj_type(uint32_t argc, char* argv[]);
 bool check_test(uint32_t argc, char* argv[]);
 bool check_caching(uint32_t argc, char* argv[]);
 char* set_cache_id(uint32_t argc, char* argv[], char* temp);
+bool get_flag_value(uint32_t argc, char* argv[], const char* flag, char* value);
+void get_flag_switch(uint32_t argc, char* argv[], const char* flag, bool* setting);
+void set_eval_settings(uint32_t argc, char* argv[]);
 void log_results_to_summary(uint32_t argc, char* argv[], const char* cache_id, uint32_t num_generations, uint32_t num_population_size, uint32_t percent_crossover, uint32_t percent_mutation, uint32_t percent_elite, uint32_t tournament_size, bool visualization, double shackleton_time, double* track_fitness, const char** levels, const int num_levels, int gen_evolved);
 void free_all(bool llvm_optimizing, char** src_files, uint32_t num_src_files, double* track_fitness, const char** levels);
 
@@ -114,6 +120,7 @@ int main(uint32_t argc, char* argv[]) {
     test = check_test(argc, argv);
     caching = check_caching(argc, argv);
     cache_id = set_cache_id(argc, argv, temp);
+    set_eval_settings(argc, argv);
 
     // --------------------------------------------------------------------------------
     // Reading test and source files --------------------------------------------------
@@ -131,7 +138,7 @@ int main(uint32_t argc, char* argv[]) {
     // --------------------------------------------------------------------------------
     // Tests --------------------------------------------------------------------------
     if (test) {
-        test_master(num_generations, num_population_size, indiv_size, tournament_size, percent_mutation, percent_crossover, percent_elite, curr_type, visualization, test_file, src_files, num_src_files, caching, track_fitness);
+        test_master(num_generations, num_population_size, indiv_size, tournament_size, percent_mutation, percent_crossover, percent_elite, curr_type, visualization, test_file, src_files, num_src_files, caching, track_fitness, cache_id, levels, num_levels);
     }
 
     // --------------------------------------------------------------------------------
@@ -163,7 +170,44 @@ void print_help_msg(uint32_t argc, char* argv[], uint32_t num_generations, uint3
                 printf("\t-parameters_file\t: Specifies that an input file at src/files/parameters.txt will be used to change some of the parameters for evolution.\n");
                 printf("\t-test\t\t\t: Enables the testing script for Shackleton to be run. Will be run regardless of other parameters specified.\n");
                 printf("\t-llvm_optimize\t\t: Specifies that the LLVM integrated portion of the tool will be used to optimize LLVM using evolution.\n\t\t\t\t  This option automatically sets the object type needed to LLVM_PASS\n");
-                printf("\t-cache\t\t\t: Caches information for each evolutionary run into files. This means something different depending on the object type being used.\n\n");
+                printf("\t-cache\t\t\t: Caches information for each evolutionary run into files. This means something different depending on the object type being used.\n");
+                printf("\t-workers=N\t\t: Number of individuals of a population that are compiled with opt at the same time. Defaults to 1.\n");
+                printf("\t-exec_mode=MODE\t\t: How individuals and baselines are timed. native (default) builds an executable with llc and clang++ once and times it,\n\t\t\t\t  jit times lli on the bitcode. Falls back to jit if no executable can be built.\n");
+                printf("\t-measure_cores=LIST\t: Cores reserved for the timed runs, e.g. 2,3 or 28-31. One individual is timed per core, and opt is kept off these cores\n\t\t\t\t  so compiling can overlap with timing. By default nothing is reserved and a batch is fully compiled before it is timed.\n");
+                printf("\t-ir_reuse=on|off\t: Whether an individual whose optimized module is byte-identical to one already timed reuses its runs instead of being timed.\n\t\t\t\t  Defaults to on, hit and miss counts are printed at the end of the run.\n");
+                printf("\t-min_runs=N\t\t: Times every individual at least N times, then stops as soon as the 95%% confidence interval of its runtime\n\t\t\t\t  lies fully above or below the worst elite, or is narrower than -ci_precision. Defaults to 0, every individual gets all runs.\n");
+                printf("\t-max_runs=N\t\t: Most timed runs of an individual. Defaults to 40.\n");
+                printf("\t-ci_precision=P\t\t: Relative half-width of the confidence interval at which -min_runs stops timing. Defaults to 0.01.\n");
+                printf("\t-perf_counters=on|off\t: Reads instructions, cycles, branch misses and cache misses of every timed run with perf_event_open. Defaults to off.\n");
+                printf("\t-fitness_metric=METRIC\t: What fitness measures: time (default, seconds), instructions or cycles (millions per run). The counter\n\t\t\t\t  metrics turn -perf_counters on and fall back to time if counters are not available, e.g. in containers.\n");
+                printf("\t-timeout_factor=F\t: Kills a timed run, and everything it started, after F times the wall time of the fastest baseline (at least 1 s).\n\t\t\t\t  The individual is marked as timed out. Defaults to 10, 0 turns the timeout off.\n");
+                printf("\t-mem_limit=MB\t\t: Address space limit of every timed run in megabytes. Defaults to 0 (no limit).\n");
+                printf("\t-warmup_runs=N\t\t: Untimed runs of every individual and baseline before its first timed run. Defaults to 0.\n");
+                printf("\t-interleave=on|off\t: Takes the timed runs of the individuals on a measurement core in turns instead of one after the other. Defaults to on.\n");
+                printf("\t-control_level=LEVEL\t: Baseline level timed alongside every population to track drift of the machine. Defaults to O3.\n");
+                printf("\t-control_runs=N\t\t: Runs of the control level per population, 0 to time every baseline level again every 5 generations. Defaults to 5.\n");
+                printf("\t-fitness_store=FILE\t: Store of measured pass sequences shared with earlier and concurrent runs on the same target.\n");
+                printf("\t-checkpoint_every=N\t: Writes the state of the run to checkpoint.bin in its run folder every N generations, 0 for never. Defaults to 1.\n");
+                printf("\t-fitness_estimator=EST\t: How the runtimes of an individual become its fitness: mean (default), median, trimmed (mean without\n\t\t\t\t  the -trim fraction at each end) or min (mean of the fastest run of every -min_of consecutive runs).\n");
+                printf("\t-trim=F\t\t\t: Fraction trimmed from each end by -fitness_estimator=trimmed. Defaults to 0.1.\n");
+                printf("\t-min_of=K\t\t: Runs per group of -fitness_estimator=min. Defaults to 5.\n");
+                printf("\t-fitness_interval=M\t: How the 95%% confidence interval of every fitness is found: analytic (default) or bootstrap.\n");
+                printf("\t-bootstrap=N\t\t: Resamples of -fitness_interval=bootstrap. Defaults to 200.\n");
+                printf("\t-compare_intervals=on|off: Ranks elites, tournament contestants and offspring by the upper end of their interval, so an individual\n\t\t\t\t  only wins with a runtime that is reliably low. Defaults to off.\n");
+                printf("\t-racing=on|off\t\t: Times the offspring of a mating against each other, stops timing the ones another offspring beats\n\t\t\t\t  beyond doubt and gives their runs to the close ones. Defaults to off.\n");
+                printf("\t-race_tournaments=on|off: Times tournament contestants whose interval overlaps the winner's against it once more. Defaults to off.\n");
+                printf("\t-race_min_runs=N\t: Runs of a raced individual before it can be stopped. Defaults to 5.\n");
+                printf("\t-proxy_filter=on|off\t: Scores the optimized module of every new individual from its IR and only times it if the score is\n\t\t\t\t  within -proxy_margin of the worst score of the elites. Defaults to off.\n");
+                printf("\t-proxy_margin=F\t\t: Fraction above the worst score of the elites that is still timed. Defaults to 0.1.\n");
+                printf("\t-proxy_mca=on|off\t: Scores modules by the cycles llvm-mca predicts for their code, loops weighted, instead of by instruction\n\t\t\t\t  counts. Needs llc and llvm-mca. Defaults to off.\n");
+                printf("\t-reeval_ucb=on|off\t: Times individuals again by how wide their interval is while its low end reaches the worst elite,\n\t\t\t\t  instead of by a 25%% chance. Individuals clearly worse than the elites are not timed again. Defaults to off.\n");
+                printf("\t-reeval_budget=F\t: With -reeval_ucb, fraction of the individuals of a batch timed before that may be timed again.\n\t\t\t\t  Defaults to 0.25.\n");
+                printf("\t-surrogate=on|off\t: Learns the runtime of pass sequences from every evaluation and only times the new offspring, and keeps\n\t\t\t\t  the new random individuals, it predicts to be fastest. Defaults to off.\n");
+                printf("\t-surrogate_keep=F\t: Fraction of the new offspring that is timed, at least one for every place they compete for,\n\t\t\t\t  and of the random candidates that is kept. Defaults to 0.5.\n");
+                printf("\t-surrogate_min_samples=N: Evaluations learned before the surrogate model ranks anything. Defaults to 20.\n");
+                printf("\t-steady_state=on|off\t: Breeds an offspring into every free -workers slot and lets it replace the worst individual\n\t\t\t\t  if it is better, instead of evaluating generation by generation. Needs LLVM_PASS individuals.\n\t\t\t\t  Defaults to off.\n");
+                printf("\t-sample_memory=MB\t: Megabytes of measured runtimes kept in memory, those of individuals no longer timed are moved to samples.bin in the run folder.\n\t\t\t\t  Needs -cache, 0 keeps every runtime in memory. Defaults to 64.\n");
+                printf("\t-resume=FOLDER\t\t: Continues the run in FOLDER from its last checkpoint. Needs -cache and the parameters of that run.\n\n");
                 printf("The Shackleton framework has a set number of object types available to evolve. If you would like to use different types than the ones listed below,"
                                         " you can use the Editor tool found at src/editor_tool to add new object types. Please follow the instructions for using that tool given in the"
                                         " README of the github repository in that subdirectory. Here are the currently available object types:\n\n");
@@ -556,6 +600,253 @@ char* set_cache_id(uint32_t argc, char* argv[], char* temp) {
     return temp;
 }
 
+bool get_flag_value(uint32_t argc, char* argv[], const char* flag, char* value) {
+    int flag_len = strlen(flag);
+    for (uint32_t curr = 1; curr < argc; curr++) {
+        if (strncmp(argv[curr], flag, flag_len) == 0 && argv[curr][flag_len] == '=') {
+            // a value cut short would silently name another file or folder
+            if (strlen(argv[curr] + flag_len + 1) >= MAX_FLAG_VALUE) {
+                printf("The value of %s must be shorter than %d characters.\n\nAborting code\n\n", flag, MAX_FLAG_VALUE);
+                exit(0);
+            }
+            strcpy(value, argv[curr] + flag_len + 1);
+            return true;
+        }
+    }
+    return false;
+}
+
+// sets setting from flag=on or flag=off, leaves it alone if the flag is not given
+void get_flag_switch(uint32_t argc, char* argv[], const char* flag, bool* setting) {
+    char value[MAX_FLAG_VALUE];
+    if (get_flag_value(argc, argv, flag, value)) {
+        if (strcmp(value, "on") == 0) {
+            *setting = true;
+        } else if (strcmp(value, "off") == 0) {
+            *setting = false;
+        } else {
+            printf("%s must be either on or off.\n\nAborting code\n\n", flag);
+            exit(0);
+        }
+    }
+}
+
+void set_eval_settings(uint32_t argc, char* argv[]) {
+    char value[MAX_FLAG_VALUE];
+    if (get_flag_value(argc, argv, "-workers", value)) {
+        eval_settings.num_workers = atoi(value);
+        if (eval_settings.num_workers < 1) {
+            printf("-workers must be a positive number.\n\nAborting code\n\n");
+            exit(0);
+        }
+    }
+    if (get_flag_value(argc, argv, "-exec_mode", value)) {
+        if (strcmp(value, "native") == 0) {
+            eval_settings.exec_mode = EXEC_NATIVE;
+        } else if (strcmp(value, "jit") == 0) {
+            eval_settings.exec_mode = EXEC_JIT;
+        } else {
+            printf("-exec_mode must be either native or jit.\n\nAborting code\n\n");
+            exit(0);
+        }
+    }
+    if (get_flag_value(argc, argv, "-measure_cores", value)) {
+        if (!evaluation_set_measure_cores(value)) {
+            printf("-measure_cores must be a list of cores such as 2,3 or 28-31.\n\nAborting code\n\n");
+            exit(0);
+        }
+    }
+    get_flag_switch(argc, argv, "-ir_reuse", &eval_settings.ir_reuse);
+    if (get_flag_value(argc, argv, "-min_runs", value)) {
+        eval_settings.min_runs = atoi(value);
+        if (eval_settings.min_runs < 2) {
+            printf("-min_runs must be at least 2.\n\nAborting code\n\n");
+            exit(0);
+        }
+    }
+    if (get_flag_value(argc, argv, "-max_runs", value)) {
+        eval_settings.max_runs = atoi(value);
+        if (eval_settings.max_runs < 1 || eval_settings.max_runs < eval_settings.min_runs) {
+            printf("-max_runs must be a positive number and not below -min_runs.\n\nAborting code\n\n");
+            exit(0);
+        }
+    }
+    if (get_flag_value(argc, argv, "-ci_precision", value)) {
+        eval_settings.ci_precision = atof(value);
+        if (eval_settings.ci_precision <= 0) {
+            printf("-ci_precision must be a positive fraction such as 0.01.\n\nAborting code\n\n");
+            exit(0);
+        }
+    }
+    get_flag_switch(argc, argv, "-perf_counters", &eval_settings.perf_counters);
+    if (get_flag_value(argc, argv, "-fitness_metric", value)) {
+        if (strcmp(value, "time") == 0) {
+            eval_settings.metric = METRIC_TIME;
+        } else if (strcmp(value, "instructions") == 0) {
+            eval_settings.metric = METRIC_INSTRUCTIONS;
+            eval_settings.perf_counters = true;
+        } else if (strcmp(value, "cycles") == 0) {
+            eval_settings.metric = METRIC_CYCLES;
+            eval_settings.perf_counters = true;
+        } else {
+            printf("-fitness_metric must be time, instructions or cycles.\n\nAborting code\n\n");
+            exit(0);
+        }
+    }
+    if (get_flag_value(argc, argv, "-timeout_factor", value)) {
+        eval_settings.timeout_factor = atof(value);
+        if (eval_settings.timeout_factor < 0) {
+            printf("-timeout_factor must be zero or a positive number.\n\nAborting code\n\n");
+            exit(0);
+        }
+    }
+    if (get_flag_value(argc, argv, "-mem_limit", value)) {
+        eval_settings.mem_limit = atol(value);
+        if (eval_settings.mem_limit < 0) {
+            printf("-mem_limit must be zero or a positive number of megabytes.\n\nAborting code\n\n");
+            exit(0);
+        }
+    }
+    if (get_flag_value(argc, argv, "-warmup_runs", value)) {
+        eval_settings.warmup_runs = atoi(value);
+        if (eval_settings.warmup_runs < 0) {
+            printf("-warmup_runs must be zero or a positive number.\n\nAborting code\n\n");
+            exit(0);
+        }
+    }
+    get_flag_switch(argc, argv, "-interleave", &eval_settings.interleave);
+    if (get_flag_value(argc, argv, "-control_level", value)) {
+        if (strlen(value) >= sizeof(eval_settings.control_level)) {
+            printf("-control_level must be an optimization level such as O3.\n\nAborting code\n\n");
+            exit(0);
+        }
+        strcpy(eval_settings.control_level, value);
+    }
+    if (get_flag_value(argc, argv, "-control_runs", value)) {
+        eval_settings.control_runs = atoi(value);
+        if (eval_settings.control_runs < 0) {
+            printf("-control_runs must be zero or a positive number.\n\nAborting code\n\n");
+            exit(0);
+        }
+    }
+    if (get_flag_value(argc, argv, "-fitness_store", value)) {
+        if (strlen(value) == 0 || strlen(value) >= sizeof(eval_settings.store_file)) {
+            printf("-fitness_store must be a file name.\n\nAborting code\n\n");
+            exit(0);
+        }
+        strcpy(eval_settings.store_file, value);
+    }
+    if (get_flag_value(argc, argv, "-checkpoint_every", value)) {
+        checkpoint_settings.every = atoi(value);
+        if (checkpoint_settings.every < 0) {
+            printf("-checkpoint_every must be zero or a positive number.\n\nAborting code\n\n");
+            exit(0);
+        }
+    }
+    if (get_flag_value(argc, argv, "-fitness_estimator", value)) {
+        const char* estimators[] = {"mean", "median", "trimmed", "min"};
+        int e = 0;
+        while (e < 4 && strcmp(value, estimators[e]) != 0) {
+            e++;
+        }
+        if (e == 4) {
+            printf("-fitness_estimator must be mean, median, trimmed or min.\n\nAborting code\n\n");
+            exit(0);
+        }
+        estimator_settings.estimator = (fitness_estimator)e;
+    }
+    if (get_flag_value(argc, argv, "-trim", value)) {
+        estimator_settings.trim = atof(value);
+        if (estimator_settings.trim < 0 || estimator_settings.trim >= 0.5) {
+            printf("-trim must be at least 0 and below 0.5.\n\nAborting code\n\n");
+            exit(0);
+        }
+    }
+    if (get_flag_value(argc, argv, "-min_of", value)) {
+        if (atoi(value) < 1) {
+            printf("-min_of must be a positive number.\n\nAborting code\n\n");
+            exit(0);
+        }
+        estimator_settings.min_of = atoi(value);
+    }
+    if (get_flag_value(argc, argv, "-fitness_interval", value)) {
+        if (strcmp(value, "analytic") == 0) {
+            estimator_settings.interval = INTERVAL_ANALYTIC;
+        } else if (strcmp(value, "bootstrap") == 0) {
+            estimator_settings.interval = INTERVAL_BOOTSTRAP;
+        } else {
+            printf("-fitness_interval must be analytic or bootstrap.\n\nAborting code\n\n");
+            exit(0);
+        }
+    }
+    if (get_flag_value(argc, argv, "-bootstrap", value)) {
+        if (atoi(value) < 1) {
+            printf("-bootstrap must be a positive number.\n\nAborting code\n\n");
+            exit(0);
+        }
+        estimator_settings.resamples = atoi(value);
+    }
+    get_flag_switch(argc, argv, "-compare_intervals", &estimator_settings.compare_intervals);
+    get_flag_switch(argc, argv, "-racing", &eval_settings.racing);
+    get_flag_switch(argc, argv, "-race_tournaments", &eval_settings.race_tournaments);
+    if (get_flag_value(argc, argv, "-race_min_runs", value)) {
+        if (atoi(value) < 2) {
+            printf("-race_min_runs must be at least 2.\n\nAborting code\n\n");
+            exit(0);
+        }
+        eval_settings.race_min_runs = atoi(value);
+    }
+    get_flag_switch(argc, argv, "-proxy_filter", &eval_settings.proxy_filter);
+    if (get_flag_value(argc, argv, "-proxy_margin", value)) {
+        eval_settings.proxy_margin = atof(value);
+        if (eval_settings.proxy_margin < 0) {
+            printf("-proxy_margin must be zero or a positive fraction.\n\nAborting code\n\n");
+            exit(0);
+        }
+    }
+    get_flag_switch(argc, argv, "-proxy_mca", &eval_settings.proxy_mca);
+    get_flag_switch(argc, argv, "-reeval_ucb", &eval_settings.reeval_ucb);
+    if (get_flag_value(argc, argv, "-reeval_budget", value)) {
+        eval_settings.reeval_budget = atof(value);
+        if (eval_settings.reeval_budget < 0 || eval_settings.reeval_budget > 1) {
+            printf("-reeval_budget must be a fraction between 0 and 1.\n\nAborting code\n\n");
+            exit(0);
+        }
+    }
+    get_flag_switch(argc, argv, "-surrogate", &surrogate_settings.enabled);
+    if (get_flag_value(argc, argv, "-surrogate_keep", value)) {
+        surrogate_settings.keep = atof(value);
+        if (surrogate_settings.keep <= 0 || surrogate_settings.keep > 1) {
+            printf("-surrogate_keep must be a fraction above 0 and at most 1.\n\nAborting code\n\n");
+            exit(0);
+        }
+    }
+    if (get_flag_value(argc, argv, "-surrogate_min_samples", value)) {
+        if (atoi(value) < 1) {
+            printf("-surrogate_min_samples must be a positive number.\n\nAborting code\n\n");
+            exit(0);
+        }
+        surrogate_settings.min_samples = atoi(value);
+    }
+    get_flag_switch(argc, argv, "-steady_state", &evolution_settings.steady_state);
+    if (get_flag_value(argc, argv, "-sample_memory", value)) {
+        if (atoi(value) < 0) {
+            printf("-sample_memory must be zero or a positive number of megabytes.\n\nAborting code\n\n");
+            exit(0);
+        }
+        sample_settings.memory_mb = atoi(value);
+    }
+    if (get_flag_value(argc, argv, "-resume", value)) {
+        if (strlen(value) == 0 || strlen(value) >= sizeof(checkpoint_settings.resume_folder) || access(value, F_OK) != 0) {
+            printf("-resume must be the run folder of an earlier run.\n\nAborting code\n\n");
+            exit(0);
+        }
+        strcpy(checkpoint_settings.resume_folder, value);
+    }
+    evaluation_check_counters();
+    evaluation_print_settings();
+}
+
 void log_results_to_summary(uint32_t argc, char* argv[], const char* cache_id, \
                             uint32_t num_generations, uint32_t num_population_size, \
                             uint32_t percent_crossover, uint32_t percent_mutation, \
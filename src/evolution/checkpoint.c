@@ -0,0 +1,475 @@
+#include <unistd.h>
+#include "checkpoint.h"
+#include "evaluation.h"
+#include "generation.h"
+#include "genome.h"
+#include "../module/llvm_pass.h"
+
+#define CHECKPOINT_MAGIC 0x35504b4348534b53ULL
+#define CHECKPOINT_FILE "/checkpoint.bin"
+#define CHECKPOINT_NODES_FILE "/checkpoint_nodes.bin"
+
+CheckpointSettings checkpoint_settings = {.every = 1, .resume_folder = ""};
+
+/*
+ * What the last record of an individual in the node log was written with, it gets
+ * a new record once one of them changes
+ */
+typedef struct CheckpointMark {
+    int num_eval;               //-1 if the individual has no record
+    int tot_gen;
+    double fitness;
+    double proxy;
+} CheckpointMark;
+
+// state of rand(), kept in a buffer of our own so it can be written out and read back
+static char rand_state[256];
+static char scratch_rand_state[256];
+static bool read_ok = true;
+
+// the node log of the run folder checkpoints are written to, records are only appended to it
+static CheckpointMark* marks = NULL;
+static int marks_capacity = 0;
+static int num_marks = 0;
+static long nodes_length = 0;           //Bytes of the node log the last checkpoint covers
+static char nodes_file[400] = "";
+
+static void checkpoint_write(FILE* f, const void* data, size_t size) {
+
+    fwrite(data, size, 1, f);
+
+}
+
+static void checkpoint_read(FILE* f, void* data, size_t size) {
+
+    if (size > 0 && fread(data, size, 1, f) != 1) {
+        read_ok = false;
+        memset(data, 0, size);
+    }
+
+}
+
+/*
+ * Pass sequences are written as the catalog index of every pass, the objects hold
+ * pointers that mean nothing to another process. Names would not do: a pass can
+ * appear in the catalog more than once, and individuals are compared by index
+ */
+static void checkpoint_write_genome(FILE* f, node_str* seq) {
+
+    Genome* genome = genome_from_individual(seq);
+
+    checkpoint_write(f, &genome->length, sizeof(genome->length));
+    checkpoint_write(f, genome->pass, genome->length);
+    genome_free(genome);
+
+}
+
+static node_str* checkpoint_read_genome(FILE* f) {
+
+    uint32_t len = 0;
+
+    checkpoint_read(f, &len, sizeof(len));
+    if (!read_ok || len == 0 || len > 100000) {
+        read_ok = false;
+        return NULL;
+    }
+    Genome* genome = genome_alloc(len);
+    checkpoint_read(f, genome->pass, len);
+    for (uint32_t p = 0; p < len; p++) {
+        if (genome->pass[p] >= LLVM_NUM_PASSES) {
+            read_ok = false;
+        }
+    }
+    node_str* seq = read_ok ? genome_to_individual(genome) : NULL;
+    genome_free(genome);
+    return seq;
+
+}
+
+/*
+ * A node record holds the summary of an individual and where its runtimes are in
+ * samples.bin, the runtimes themselves stay in that file
+ */
+static void checkpoint_write_node(FILE* f, DataNode* d) {
+
+    bool runs_kept = node_reads_runs();
+
+    checkpoint_write_genome(f, d->seq);
+    checkpoint_write(f, &d->seq_id, sizeof(d->seq_id));
+    checkpoint_write(f, &d->fitness, sizeof(d->fitness));
+    checkpoint_write(f, &d->fitness_low, sizeof(d->fitness_low));
+    checkpoint_write(f, &d->fitness_high, sizeof(d->fitness_high));
+    checkpoint_write(f, &d->proxy, sizeof(d->proxy));
+    checkpoint_write(f, &d->tot_gen, sizeof(d->tot_gen));
+    checkpoint_write(f, &d->num_eval, sizeof(d->num_eval));
+    // the totals count the folded evaluations, whose rows are gone
+    checkpoint_write(f, &d->total_run, sizeof(d->total_run));
+    checkpoint_write(f, &d->total_time, sizeof(d->total_time));
+    checkpoint_write(f, &d->total_var, sizeof(d->total_var));
+    checkpoint_write(f, &d->stats, sizeof(d->stats));
+    checkpoint_write(f, &d->folded, sizeof(d->folded));
+    checkpoint_write(f, &d->folded_runs, sizeof(d->folded_runs));
+    checkpoint_write(f, &d->folded_time, sizeof(d->folded_time));
+    checkpoint_write(f, &runs_kept, sizeof(runs_kept));
+    checkpoint_write(f, &d->folded_at, sizeof(d->folded_at));
+    int num_rows = d->num_eval - d->folded;
+    checkpoint_write(f, d->sample_at, sizeof(uint64_t) * num_rows);
+    checkpoint_write(f, d->success_cts, sizeof(int) * num_rows);
+    checkpoint_write(f, d->avg_time, sizeof(double) * num_rows);
+    checkpoint_write(f, d->var, sizeof(double) * num_rows);
+    checkpoint_write(f, d->utime, sizeof(double) * num_rows);
+    checkpoint_write(f, d->stime, sizeof(double) * num_rows);
+    checkpoint_write(f, d->maxrss, sizeof(long) * num_rows);
+    checkpoint_write(f, d->instructions, sizeof(double) * num_rows);
+    checkpoint_write(f, d->cycles, sizeof(double) * num_rows);
+    checkpoint_write(f, d->branch_misses, sizeof(double) * num_rows);
+    checkpoint_write(f, d->cache_misses, sizeof(double) * num_rows);
+    checkpoint_write(f, d->status, sizeof(eval_status) * num_rows);
+    checkpoint_write(f, d->gens, sizeof(int) * num_rows);
+
+}
+
+// runtimes have to lie within the first num_samples of samples.bin
+static DataNode* checkpoint_read_node(FILE* f, uint64_t num_samples) {
+
+    int seq_id = 0;
+    int num_eval = 0;
+    bool runs_kept = false;
+    node_str* seq = checkpoint_read_genome(f);
+
+    if (seq == NULL) {
+        return NULL;
+    }
+    checkpoint_read(f, &seq_id, sizeof(seq_id));
+    DataNode* d = node_new_allele(seq, seq_id);
+    generate_free_individual(seq);
+    checkpoint_read(f, &d->fitness, sizeof(d->fitness));
+    checkpoint_read(f, &d->fitness_low, sizeof(d->fitness_low));
+    checkpoint_read(f, &d->fitness_high, sizeof(d->fitness_high));
+    checkpoint_read(f, &d->proxy, sizeof(d->proxy));
+    checkpoint_read(f, &d->tot_gen, sizeof(d->tot_gen));
+    checkpoint_read(f, &num_eval, sizeof(num_eval));
+    checkpoint_read(f, &d->total_run, sizeof(d->total_run));
+    checkpoint_read(f, &d->total_time, sizeof(d->total_time));
+    checkpoint_read(f, &d->total_var, sizeof(d->total_var));
+    checkpoint_read(f, &d->stats, sizeof(d->stats));
+    checkpoint_read(f, &d->folded, sizeof(d->folded));
+    checkpoint_read(f, &d->folded_runs, sizeof(d->folded_runs));
+    checkpoint_read(f, &d->folded_time, sizeof(d->folded_time));
+    checkpoint_read(f, &runs_kept, sizeof(runs_kept));
+    checkpoint_read(f, &d->folded_at, sizeof(d->folded_at));
+    if (num_eval < 0 || d->folded < 0 || d->folded > num_eval || num_eval - d->folded >= NODE_MAX_ROWS || d->folded_runs < 0) {
+        read_ok = false;
+        d->folded = 0;
+        num_eval = 0;
+    }
+    if (read_ok && node_reads_runs() && d->folded_runs > 0 && (!runs_kept || d->folded_at + d->folded_runs > num_samples)) {
+        printf("The checkpoint was written by a run with another fitness estimator, resume with the same one.\n\nAborting code\n\n");
+        exit(0);
+    }
+    // the arrays grow exactly as in node_record_data
+    for (d->num_eval = d->folded + 1; d->num_eval <= num_eval; d->num_eval++) {
+        node_check_overflow(d);
+    }
+    d->num_eval = num_eval;
+    int num_rows = num_eval - d->folded;
+    checkpoint_read(f, d->sample_at, sizeof(uint64_t) * num_rows);
+    checkpoint_read(f, d->success_cts, sizeof(int) * num_rows);
+    checkpoint_read(f, d->avg_time, sizeof(double) * num_rows);
+    checkpoint_read(f, d->var, sizeof(double) * num_rows);
+    checkpoint_read(f, d->utime, sizeof(double) * num_rows);
+    checkpoint_read(f, d->stime, sizeof(double) * num_rows);
+    checkpoint_read(f, d->maxrss, sizeof(long) * num_rows);
+    checkpoint_read(f, d->instructions, sizeof(double) * num_rows);
+    checkpoint_read(f, d->cycles, sizeof(double) * num_rows);
+    checkpoint_read(f, d->branch_misses, sizeof(double) * num_rows);
+    checkpoint_read(f, d->cache_misses, sizeof(double) * num_rows);
+    checkpoint_read(f, d->status, sizeof(eval_status) * num_rows);
+    checkpoint_read(f, d->gens, sizeof(int) * num_rows);
+    for (int e = 0; e < num_rows; e++) {
+        if (d->success_cts[e] < 0 || d->sample_at[e] + d->success_cts[e] > num_samples) {
+            read_ok = false;
+            d->num_eval = d->folded;
+        }
+    }
+    if (!read_ok) {
+        free_node(d);
+        return NULL;
+    }
+    return d;
+
+}
+
+// whether the node log already holds d as it is now
+static bool checkpoint_marked(DataNode* d) {
+
+    if (d->seq_id >= num_marks) {
+        return false;
+    }
+    CheckpointMark* m = &marks[d->seq_id];
+    return m->num_eval == d->num_eval && m->tot_gen == d->tot_gen && m->fitness == d->fitness && m->proxy == d->proxy;
+
+}
+
+static void checkpoint_mark(DataNode* d) {
+
+    if (d->seq_id >= marks_capacity) {
+        marks_capacity = marks_capacity == 0 ? 1024 : marks_capacity;
+        while (marks_capacity <= d->seq_id) {
+            marks_capacity *= 2;
+        }
+        marks = realloc(marks, sizeof(CheckpointMark) * marks_capacity);
+    }
+    while (num_marks <= d->seq_id) {
+        marks[num_marks++].num_eval = -1;
+    }
+    marks[d->seq_id] = (CheckpointMark){.num_eval = d->num_eval, .tot_gen = d->tot_gen, .fitness = d->fitness, .proxy = d->proxy};
+
+}
+
+// the next checkpoint starts a new node log
+static void checkpoint_forget() {
+
+    free(marks);
+    marks = NULL;
+    marks_capacity = 0;
+    num_marks = 0;
+    nodes_length = 0;
+    strcpy(nodes_file, "");
+
+}
+
+/*
+ * Moves rand() onto a state buffer that checkpoints can save. Seeded from
+ * rand() itself, so a run started with srand keeps depending on its seed
+ */
+void checkpoint_init_random() {
+
+    initstate((unsigned int)rand(), rand_state, sizeof(rand_state));
+
+}
+
+bool checkpoint_resuming() {
+
+    return strlen(checkpoint_settings.resume_folder) > 0;
+
+}
+
+bool checkpoint_due(int gen) {
+
+    return checkpoint_settings.every > 0 && (gen + 1) % checkpoint_settings.every == 0;
+
+}
+
+/*
+ * Appends a record for every individual that changed since the last checkpoint to the
+ * node log, makes sure samples.bin holds every runtime, then writes the rest of the
+ * state to a temporary file and renames it over the last checkpoint. The checkpoint
+ * names how much of both files it covers, so a crash while writing leaves the previous
+ * checkpoint intact and the cost of a checkpoint follows what the generation changed
+ */
+void checkpoint_save(char* main_folder, EvolutionState* state) {
+
+    char file[400];
+    char tmp_file[410];
+    char log_file[400];
+    uint64_t magic = CHECKPOINT_MAGIC;
+
+    if (state->ot != LLVM_PASS) {
+        return;
+    }
+    snprintf(file, sizeof(file), "%s%s", main_folder, CHECKPOINT_FILE);
+    snprintf(tmp_file, sizeof(tmp_file), "%s.tmp", file);
+    snprintf(log_file, sizeof(log_file), "%s%s", main_folder, CHECKPOINT_NODES_FILE);
+    if (strcmp(log_file, nodes_file) != 0) {
+        checkpoint_forget();
+        strcpy(nodes_file, log_file);
+    }
+    if (!samples_flush()) {
+        printf("Could not write the runtimes of checkpoint %s\n", file);
+        return;
+    }
+    uint64_t num_samples = samples_length();
+
+    // records past nodes_length belong to no checkpoint and are written over
+    FILE* log = fopen(nodes_file, nodes_length == 0 ? "wb" : "r+b");
+    if (log == NULL || fseek(log, nodes_length, SEEK_SET) != 0) {
+        printf("Could not write checkpoint %s\n", nodes_file);
+        if (log != NULL) {
+            fclose(log);
+        }
+        return;
+    }
+    for (int i = 0; i < *state->max_id; i++) {
+        if (!checkpoint_marked((*state->all_indiv)[i])) {
+            checkpoint_write_node(log, (*state->all_indiv)[i]);
+        }
+    }
+    long log_length = ftell(log);
+    bool written = fflush(log) == 0 && fsync(fileno(log)) == 0 && log_length >= 0;
+    written = fclose(log) == 0 && written;
+    FILE* f = written ? fopen(tmp_file, "wb") : NULL;
+    if (f == NULL) {
+        printf("Could not write checkpoint %s\n", written ? tmp_file : nodes_file);
+        return;
+    }
+
+    checkpoint_write(f, &magic, sizeof(magic));
+    checkpoint_write(f, &state->next_gen, sizeof(state->next_gen));
+    checkpoint_write(f, &state->pop_size, sizeof(state->pop_size));
+    checkpoint_write(f, &state->num_gens, sizeof(state->num_gens));
+    checkpoint_write(f, &state->ot, sizeof(state->ot));
+    checkpoint_write(f, &state->num_elites, sizeof(state->num_elites));
+    checkpoint_write(f, &state->num_levels, sizeof(state->num_levels));
+
+    // setstate stores the position of the running generator in its buffer
+    setstate(rand_state);
+    checkpoint_write(f, rand_state, sizeof(rand_state));
+
+    checkpoint_write(f, state->current_gen_id, sizeof(int) * state->pop_size);
+    checkpoint_write(f, state->fitness_values, sizeof(double) * state->pop_size);
+    checkpoint_write(f, state->elite_indx, sizeof(int) * state->num_elites);
+    checkpoint_write(f, state->elite_id, sizeof(int) * state->num_elites);
+    checkpoint_write(f, state->track_fitness, sizeof(double) * (state->num_levels + 1 + state->num_gens));
+    checkpoint_write(f, state->lowest, sizeof(double));
+    checkpoint_write(f, state->stale_counter, sizeof(int));
+    checkpoint_write(f, state->max_id, sizeof(int));
+    checkpoint_write(f, &num_samples, sizeof(num_samples));
+    checkpoint_write(f, &log_length, sizeof(log_length));
+    evaluation_save_state(f);
+
+    written = fflush(f) == 0 && fsync(fileno(f)) == 0;
+    written = fclose(f) == 0 && written;
+    if (!written || rename(tmp_file, file) != 0) {
+        printf("Could not write checkpoint %s\n", file);
+        unlink(tmp_file);
+        return;
+    }
+    for (int i = 0; i < *state->max_id; i++) {
+        checkpoint_mark((*state->all_indiv)[i]);
+    }
+    nodes_length = log_length;
+
+}
+
+/*
+ * Restores the state of the last checkpoint in a run folder. The parameters of
+ * the evolution have to be the ones of the checkpointed run
+ */
+void checkpoint_load(char* main_folder, EvolutionState* state) {
+
+    char file[400];
+    uint64_t magic = 0;
+    uint32_t pop_size = 0, num_gens = 0, num_elites = 0;
+    osaka_object_typ ot = NOTSET;
+    int num_levels = 0;
+    int max_id = 0;
+    uint64_t num_samples = 0;
+    long log_length = 0;
+    char log_file[400];
+
+    sprintf(file, "%s%s", main_folder, CHECKPOINT_FILE);
+    FILE* f = fopen(file, "rb");
+    if (f == NULL) {
+        printf("There is no checkpoint %s to resume from.\n\nAborting code\n\n", file);
+        exit(0);
+    }
+    read_ok = true;
+    checkpoint_read(f, &magic, sizeof(magic));
+    checkpoint_read(f, &state->next_gen, sizeof(state->next_gen));
+    checkpoint_read(f, &pop_size, sizeof(pop_size));
+    checkpoint_read(f, &num_gens, sizeof(num_gens));
+    checkpoint_read(f, &ot, sizeof(ot));
+    checkpoint_read(f, &num_elites, sizeof(num_elites));
+    checkpoint_read(f, &num_levels, sizeof(num_levels));
+    if (!read_ok || magic != CHECKPOINT_MAGIC) {
+        printf("%s is not a checkpoint.\n\nAborting code\n\n", file);
+        exit(0);
+    }
+    if (pop_size != state->pop_size || num_gens != state->num_gens || ot != state->ot || num_elites != state->num_elites || num_levels != state->num_levels) {
+        printf("The checkpoint was written by a run with %u generations of %u individuals and %u elites, resume with the same parameters.\n\nAborting code\n\n", num_gens, pop_size, num_elites);
+        exit(0);
+    }
+
+    // setstate first stores the position of the running generator in its buffer, so if that
+    // is rand_state the generator is moved off it before the saved state is copied in
+    char saved_rand_state[sizeof(rand_state)];
+    checkpoint_read(f, saved_rand_state, sizeof(saved_rand_state));
+    initstate(1, scratch_rand_state, sizeof(scratch_rand_state));
+    memcpy(rand_state, saved_rand_state, sizeof(rand_state));
+    setstate(rand_state);
+
+    checkpoint_read(f, state->current_gen_id, sizeof(int) * pop_size);
+    checkpoint_read(f, state->fitness_values, sizeof(double) * pop_size);
+    checkpoint_read(f, state->elite_indx, sizeof(int) * num_elites);
+    checkpoint_read(f, state->elite_id, sizeof(int) * num_elites);
+    checkpoint_read(f, state->track_fitness, sizeof(double) * (num_levels + 1 + num_gens));
+    checkpoint_read(f, state->lowest, sizeof(double));
+    checkpoint_read(f, state->stale_counter, sizeof(int));
+    checkpoint_read(f, &max_id, sizeof(int));
+    if (max_id < 0 || max_id > 100000000) {
+        read_ok = false;
+        max_id = 0;
+    }
+    while (*state->hash_cap <= max_id) {
+        *state->all_indiv = realloc(*state->all_indiv, sizeof(DataNode*) * *state->hash_cap * 2);
+        *state->hash_cap *= 2;
+    }
+    checkpoint_read(f, &num_samples, sizeof(num_samples));
+    checkpoint_read(f, &log_length, sizeof(log_length));
+    evaluation_load_state(f);
+    fclose(f);
+    if (read_ok && !samples_resume(main_folder, num_samples)) {
+        printf("The runtimes of checkpoint %s are missing from samples.bin.\n\nAborting code\n\n", file);
+        exit(0);
+    }
+
+    // later records of an individual replace earlier ones, records past the checkpoint are dropped
+    snprintf(log_file, sizeof(log_file), "%s%s", main_folder, CHECKPOINT_NODES_FILE);
+    f = read_ok ? fopen(log_file, "rb") : NULL;
+    read_ok = f != NULL && log_length >= 0;
+    DataNode** all_indiv = *state->all_indiv;
+    memset(all_indiv, 0, sizeof(DataNode*) * *state->hash_cap);
+    while (read_ok && ftell(f) < log_length) {
+        DataNode* d = checkpoint_read_node(f, num_samples);
+        if (d == NULL || d->seq_id < 0 || d->seq_id >= max_id) {
+            read_ok = false;
+        } else {
+            if (all_indiv[d->seq_id] != NULL) {
+                free_node(all_indiv[d->seq_id]);
+            }
+            all_indiv[d->seq_id] = d;
+        }
+    }
+    read_ok = read_ok && ftell(f) == log_length && truncate(log_file, log_length) == 0;
+    if (f != NULL) {
+        fclose(f);
+    }
+    for (int i = 0; i < max_id && read_ok; i++) {
+        read_ok = all_indiv[i] != NULL;
+    }
+    *state->max_id = read_ok ? max_id : 0;
+
+    for (uint32_t k = 0; k < pop_size && read_ok; k++) {
+        if (state->current_gen_id[k] < 0 || state->current_gen_id[k] >= max_id) {
+            read_ok = false;
+        }
+    }
+    if (!read_ok) {
+        printf("Checkpoint %s is damaged.\n\nAborting code\n\n", file);
+        exit(0);
+    }
+    // the population refers to the individuals it consists of
+    for (uint32_t k = 0; k < pop_size; k++) {
+        state->current_generation[k] = (*state->all_indiv)[state->current_gen_id[k]]->seq;
+    }
+    // the next checkpoint appends to the node log
+    checkpoint_forget();
+    strcpy(nodes_file, log_file);
+    for (int i = 0; i < max_id; i++) {
+        checkpoint_mark((*state->all_indiv)[i]);
+    }
+    nodes_length = log_length;
+    printf("Resuming %s at generation %d\n", main_folder, state->next_gen + 1);
+
+}
@@ -0,0 +1,53 @@
+#ifndef EVOLUTION_CHECKPOINT_H_
+#define EVOLUTION_CHECKPOINT_H_
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include "../osaka/osaka.h"
+#include "indivdata.h"
+
+/*
+ * How often the state of an evolutionary run is written to its run folder,
+ * and the run folder to continue from
+ */
+typedef struct CheckpointSettings {
+    int every;                  //Generations between checkpoints, 0 for none
+    char resume_folder[300];    //Run folder of the checkpoint to continue from, "" to start a new run
+} CheckpointSettings;
+
+extern CheckpointSettings checkpoint_settings;
+
+/*
+ * Everything the evolution needs to continue after the last finished generation.
+ * The pointers are owned by the evolution, a resume fills them in
+ */
+typedef struct EvolutionState {
+    int next_gen;               //Generation the run continues with
+    uint32_t pop_size;
+    uint32_t num_gens;
+    osaka_object_typ ot;
+    uint32_t num_elites;
+    int num_levels;
+    node_str** current_generation;
+    int* current_gen_id;
+    double* fitness_values;
+    int* elite_indx;
+    int* elite_id;
+    DataNode*** all_indiv;      //Every individual seen so far, dimension: hash_cap
+    int* max_id;
+    int* hash_cap;
+    double* track_fitness;      //Dimension: num_levels + 1 + num_gens
+    double* lowest;
+    int* stale_counter;
+} EvolutionState;
+
+void checkpoint_init_random();
+bool checkpoint_resuming();
+bool checkpoint_due(int gen);
+void checkpoint_save(char* main_folder, EvolutionState* state);
+void checkpoint_load(char* main_folder, EvolutionState* state);
+
+#endif /* EVOLUTION_CHECKPOINT_H_ */
@@ -112,19 +112,9 @@ void crossover_onepoint_macro(node_str* osaka1, node_str* osaka2, bool vis) {
         visualization_print_individual_concise_details_from_nth(osaka2, random);
     }
 
-    // the same point is used in both osaka sequences
-    node_str* nth_osaka1 = osaka_nthnode(osaka1, random);
-    node_str* nth_osaka2 = osaka_nthnode(osaka2, random);
-
-    // swap is implemented by changing the "last" and "next" pointers
-    // starting with the "next" pointers of the last nodes
-    node_str* osaka1_last = LAST(nth_osaka1);
-    node_str* osaka2_last = LAST(nth_osaka2);
-    NEXT(osaka1_last) = nth_osaka2;
-    NEXT(osaka2_last) = nth_osaka1;
-    // and then the "last" pointers of the current nodes
-    LAST(nth_osaka1) = osaka2_last;
-    LAST(nth_osaka2) = osaka1_last;
+    // the same point is used in both osaka sequences, swap is implemented
+    // by changing the "last" and "next" pointers around the nth nodes
+    osaka_splice(osaka1, osaka2, random);
 
     if (vis) {
         printf("\n\nIndividual 1 after crossover: --------------------------------------------------------\n\n");
@@ -278,33 +268,10 @@ void crossover_twopoint_diff(node_str* osaka1, node_str* osaka2, bool vis) {
         visualization_print_individual_concise_details_from_nth(osaka2, second);
     }
 
-    // the same point is used in both osaka sequences
-    node_str* nth_osaka1 = osaka_nthnode(osaka1, random1);
-    node_str* nth_osaka2 = osaka_nthnode(osaka2, random1);
-
-    // swap is implemented by changing the "last" and "next" pointers
-    // starting with the "next" pointers of the last nodes
-    node_str* osaka1_last = LAST(nth_osaka1);
-    node_str* osaka2_last = LAST(nth_osaka2);
-    NEXT(osaka1_last) = nth_osaka2;
-    NEXT(osaka2_last) = nth_osaka1;
-    // and then the "last" pointers of the current nodes
-    LAST(nth_osaka1) = osaka2_last;
-    LAST(nth_osaka2) = osaka1_last;
-
-    // the same point is used in both osaka sequences
-    node_str* nth_osaka3 = osaka_nthnode(osaka_findheadnode(nth_osaka1), random2);
-    node_str* nth_osaka4 = osaka_nthnode(osaka_findheadnode(nth_osaka2), random2);
-
-    // swap is implemented by changing the "last" and "next" pointers
-    // starting with the "next" pointers of the last nodes
-    node_str* osaka3_last = LAST(nth_osaka3);
-    node_str* osaka4_last = LAST(nth_osaka4);
-    NEXT(osaka3_last) = nth_osaka4;
-    NEXT(osaka4_last) = nth_osaka3;
-    // and then the "last" pointers of the current nodes
-    LAST(nth_osaka3) = osaka4_last;
-    LAST(nth_osaka4) = osaka3_last;
+    // the same points are used in both osaka sequences, swap is implemented
+    // by changing the "last" and "next" pointers around the nth nodes
+    osaka_splice(osaka1, osaka2, random1);
+    osaka_splice(osaka1, osaka2, random2);
 
     if (vis) {
         printf("\n\nIndividual 1 after crossover: --------------------------------------------------------\n\n");
@@ -0,0 +1,1590 @@
+#define _GNU_SOURCE
+#include <math.h>
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+#include <ctype.h>
+#include "evaluation.h"
+#include "fitness.h"
+#include "../support/llvm.h"
+#include "../support/llvm_api.h"
+
+#define MIN_RUN_TIMEOUT 1.0     //Seconds, so launch jitter never kills a run of a very fast program
+#define MAX_BASELINES 16        //Most baseline optimization levels
+#define RACE_MAX_SHARE 2        //A raced individual gets at most this many times the runs it would get on its own
+
+EvalSettings eval_settings = {.num_workers = 1, .exec_mode = EXEC_NATIVE, .num_measure_cores = 0, .ir_reuse = true,
+                               .min_runs = 0, .max_runs = 0, .ci_precision = 0.01,
+                               .perf_counters = false, .metric = METRIC_TIME, .timeout_factor = 10, .mem_limit = 0,
+                               .warmup_runs = 0, .interleave = true, .control_level = "O3", .control_runs = 5,
+                               .store_file = "", .racing = false, .race_tournaments = false, .race_min_runs = 5,
+                               .proxy_filter = false, .proxy_margin = 0.1, .proxy_mca = false,
+                               .reeval_ucb = false, .reeval_budget = 0.25};
+
+// parsed linked module of every compile worker, kept across batches when built with LLVM_API=1
+static LLVMApiModule** api_modules = NULL;
+static char (*api_failed)[300] = NULL;     //Linked module each worker could not parse, empty if none
+static int num_api_modules = 0;
+
+// fitness of the worst elite of the last generation, UINT32_MAX before the first one is selected
+static double elite_threshold = UINT32_MAX;
+static double proxy_threshold = -1;         //Worst static proxy of the elites, -1 while no elite has one
+static uint64_t proxy_scored = 0;           //New individuals whose proxy was compared with the elites'
+static uint64_t proxy_filtered = 0;         //Of those, the ones that were not timed
+static uint64_t runs_timed = 0;     //Timed runs of individuals so far
+static uint64_t runs_capped = 0;    //Timed runs the same individuals would have had without early stopping
+// average wall time of the fastest baseline optimization level, 0 until one is timed
+static double baseline_time = 0.0;
+static uint64_t num_timeouts = 0;
+static uint64_t num_compile_failures = 0;
+// fitness of every baseline level when it was timed at start-up, in the order of the levels
+static double baseline_fitness[MAX_BASELINES];
+static int num_baselines = 0;
+static char control_command[1000] = "";    //Run command of the control level, empty until it is timed
+static double control_reference = 0.0;      //Average of the control level when the baselines were timed
+static double drift = 1.0;                  //Average of the control level in the last batch over control_reference
+static double drift_min = 1.0;
+static double drift_max = 1.0;
+static uint64_t control_samples = 0;        //Control runs taken alongside the batches so far
+static bool drift_measured = false;
+static bool store_opened = false;           //Whether opening the fitness store was tried
+static uint64_t race_eliminated = 0;        //Raced individuals whose timing stopped because another one was clearly faster
+static uint64_t race_runs = 0;              //Timed runs of raced individuals
+static uint64_t race_runs_capped = 0;       //Timed runs the same individuals would have had on their own
+static uint64_t reeval_candidates = 0;      //Individuals timed before that could have been timed again
+static uint64_t reeval_losers = 0;          //Of those, the ones clearly worse than the elites
+static uint64_t reeval_timed = 0;           //Of those, the ones the budget went to
+
+/*
+ * Timed runs of one job, owned by one measurement thread at a time
+ */
+typedef struct EvalSampling {
+    FitnessSampler sampler;
+    SampleStop stop;
+    int owner;                  //Measurement thread that takes the runs of the job, -1 before its first run
+    bool started;               //Whether the sampler is prepared
+    bool busy;                  //Whether a run of the job is in progress
+    bool done;
+    RunStats race_stats;        //Successful runs so far, what the race compares
+    uint32_t race_runs;         //Runs started so far
+} EvalSampling;
+
+/*
+ * State shared by the threads working on one batch, guarded by lock
+ */
+typedef struct EvalBatch {
+    EvalJob* jobs;
+    EvalSampling* sampling;     //Timed runs of every job, dimension: batch_size
+    uint32_t batch_size;
+    uint32_t num_measured;      //Jobs that are compiled and timed
+    uint32_t num_sampled;       //Jobs whose timed runs are done, when interleaving
+    bool control_on;            //Whether control runs are taken alongside the jobs
+    EvalSampling control;       //Runs of the control level, taken by measurement thread 0
+    uint32_t control_taken;     //Control runs started so far
+    uint32_t num_runs;          //Cap on the timed runs of one individual
+    LaunchLimits limits;        //Timeout and memory limit of every timed run
+    double threshold;           //Elite threshold the timed runs are compared against
+    char base_file[300];        //src/files/llvm/junk_output/<test file>_<cache_id>
+    uint32_t next_compile;      //Next job a compile worker picks up
+    uint32_t next_measure;      //Next job a measurement thread picks up, when not interleaving
+    bool pin_compile;           //Whether compile workers are kept off the measurement cores
+    cpu_set_t compile_cores;    //Cores the compile workers are pinned to if pin_compile
+    pthread_mutex_t lock;
+    pthread_cond_t compiled;    //Signalled every time a job finishes its compile step or its timed runs
+} EvalBatch;
+
+typedef struct EvalWorker {
+    EvalBatch* batch;
+    int id;                     //Worker number, names the scratch namespace <base_file>_w<id>
+    int core;                   //Core a measurement thread is pinned to, -1 if unpinned
+    pthread_t thread;
+} EvalWorker;
+
+/*
+ * Parses a core list such as "2,3" or "28-31" into the measurement cores.
+ * Returns false if the list is malformed
+ */
+bool evaluation_set_measure_cores(char* core_list) {
+
+    int num_cores = 0;
+    char* p = core_list;
+
+    while (*p != 0) {
+        if (!isdigit(*p)) {
+            return false;
+        }
+        int first = (int)strtol(p, &p, 10);
+        int last = first;
+        if (*p == '-') {
+            p++;
+            if (!isdigit(*p)) {
+                return false;
+            }
+            last = (int)strtol(p, &p, 10);
+        }
+        if (last < first) {
+            return false;
+        }
+        for (int c = first; c <= last; c++) {
+            if (num_cores == MAX_MEASURE_CORES) {
+                return false;
+            }
+            eval_settings.measure_cores[num_cores++] = c;
+        }
+        if (*p == ',') {
+            p++;
+        } else if (*p != 0) {
+            return false;
+        }
+    }
+    eval_settings.num_measure_cores = num_cores;
+    return true;
+
+}
+
+void evaluation_print_settings() {
+
+    printf("Evaluation workers: %d\n", eval_settings.num_workers);
+    printf("Execution mode: %s\n", eval_settings.exec_mode == EXEC_NATIVE ? "native" : "jit");
+    if (eval_settings.num_measure_cores == 0) {
+        printf("Measurement cores: not reserved, timed runs start once a batch is compiled\n");
+    } else {
+        printf("Measurement cores:");
+        for (int c = 0; c < eval_settings.num_measure_cores; c++) {
+            printf(" %d", eval_settings.measure_cores[c]);
+        }
+        printf("\n");
+    }
+    printf("Reuse of identical optimized modules: %s\n", eval_settings.ir_reuse ? "on" : "off");
+    if (eval_settings.min_runs > 0) {
+        printf("Adaptive sampling: at least %d runs, until the 95%% interval excludes the elite threshold or is within %.1f%% of the mean\n", eval_settings.min_runs, eval_settings.ci_precision * 100);
+    }
+    if (eval_settings.max_runs > 0) {
+        printf("Timed runs per individual: at most %d\n", eval_settings.max_runs);
+    }
+    if (estimator_settings.estimator != ESTIMATOR_MEAN || estimator_settings.interval != INTERVAL_ANALYTIC || estimator_settings.compare_intervals) {
+        const char* estimators[] = {"mean", "median", "trimmed mean", "mean of the minimum of every group of runs"};
+        printf("Fitness: %s, %s 95%% interval, ranked by %s\n", estimators[estimator_settings.estimator],
+               estimator_settings.interval == INTERVAL_BOOTSTRAP ? "bootstrap" : "analytic",
+               estimator_settings.compare_intervals ? "the upper end of the interval" : "the estimate");
+    }
+    if (eval_settings.perf_counters) {
+        const char* metrics[] = {"wall time (s)", "instructions (millions)", "cycles (millions)"};
+        printf("Hardware counters: on, fitness metric: %s\n", metrics[eval_settings.metric]);
+    }
+    if (eval_settings.timeout_factor > 0) {
+        printf("Run timeout: %.1f times the fastest baseline, at least %.1f s\n", eval_settings.timeout_factor, MIN_RUN_TIMEOUT);
+    }
+    if (eval_settings.mem_limit > 0) {
+        printf("Run memory limit: %ld MB\n", eval_settings.mem_limit);
+    }
+    if (eval_settings.warmup_runs > 0) {
+        printf("Warm-up runs: %d per individual, not timed\n", eval_settings.warmup_runs);
+    }
+    printf("Interleaved timed runs: %s\n", eval_settings.interleave ? "on" : "off");
+    if (eval_settings.proxy_filter) {
+        printf("Proxy filter: new individuals are timed only within %.0f%% of the worst %s of the elites\n", eval_settings.proxy_margin * 100, eval_settings.proxy_mca ? "llvm-mca throughput" : "weighted instruction count");
+    }
+    if (eval_settings.reeval_ucb) {
+        printf("Re-evaluation: up to %.0f%% of the individuals timed before, the widest intervals that reach the elites first\n", eval_settings.reeval_budget * 100);
+    }
+    if (eval_settings.racing || eval_settings.race_tournaments) {
+        printf("Racing: offspring %s, tournaments %s, at least %d runs before an individual is eliminated\n", eval_settings.racing ? "on" : "off", eval_settings.race_tournaments ? "on" : "off", eval_settings.race_min_runs);
+    }
+    if (eval_settings.control_runs > 0) {
+        printf("Drift control: %d runs of %s per batch, the baselines are timed once\n", eval_settings.control_runs, eval_settings.control_level);
+    }
+    if (strlen(eval_settings.store_file) > 0) {
+        printf("Fitness store: %s\n", eval_settings.store_file);
+    }
+
+}
+
+/*
+ * Most runtimes a single evaluation can record, raced individuals may take up to
+ * RACE_MAX_SHARE times the runs they would get on their own
+ */
+uint32_t evaluation_max_runs(uint32_t num_runs) {
+
+    uint32_t max_runs = eval_settings.max_runs > 0 ? eval_settings.max_runs : num_runs;
+    if (eval_settings.racing || eval_settings.race_tournaments) {
+        max_runs *= RACE_MAX_SHARE;
+    }
+    return max_runs > num_runs ? max_runs : num_runs;
+
+}
+
+void evaluation_set_elite_threshold(double threshold) {
+
+    elite_threshold = threshold;
+
+}
+
+void evaluation_set_proxy_threshold(double threshold) {
+
+    proxy_threshold = threshold;
+
+}
+
+void evaluation_set_baseline_time(double elapsed) {
+
+    if (baseline_time == 0.0 || elapsed < baseline_time) {
+        baseline_time = elapsed;
+    }
+
+}
+
+/*
+ * Remembers a baseline level as it was timed at start-up. Levels are added in
+ * order, and the control level also keeps its command to be timed again later
+ */
+void evaluation_add_baseline(const char* level, double fitness, double avg_time, char* run_command) {
+
+    if (num_baselines < MAX_BASELINES) {
+        baseline_fitness[num_baselines++] = fitness;
+    }
+    if (eval_settings.control_runs > 0 && strcmp(level, eval_settings.control_level) == 0 && avg_time > 0) {
+        strcpy(control_command, run_command);
+        control_reference = avg_time;
+    }
+
+}
+
+/*
+ * Estimates the baselines from their start-up fitness and the drift the control
+ * level saw in the last batch, instead of timing every level again.
+ * Returns false if there is no estimate, the levels then have to be timed
+ */
+bool evaluation_drift_baselines(double* track_fitness, int num_levels, double* ratio) {
+
+    if (!drift_measured || num_levels != num_baselines) {
+        return false;
+    }
+    for (int i = 0; i < num_levels; i++) {
+        track_fitness[i] = baseline_fitness[i] * drift;
+    }
+    *ratio = drift;
+    return true;
+
+}
+
+/*
+ * Points the control level at its rebuilt executable after a resume, its
+ * start-up measurements come from the checkpoint
+ */
+void evaluation_restore_baseline(const char* level, char* run_command) {
+
+    if (eval_settings.control_runs > 0 && strcmp(level, eval_settings.control_level) == 0 && control_reference > 0) {
+        strcpy(control_command, run_command);
+    }
+
+}
+
+/*
+ * The measurements that outlive a batch, written into checkpoints. Caches such
+ * as the IR table are not saved, a resumed run only fills them again
+ */
+void evaluation_save_state(FILE* f) {
+
+    fwrite(&elite_threshold, sizeof(elite_threshold), 1, f);
+    fwrite(&runs_timed, sizeof(runs_timed), 1, f);
+    fwrite(&runs_capped, sizeof(runs_capped), 1, f);
+    fwrite(&baseline_time, sizeof(baseline_time), 1, f);
+    fwrite(&num_timeouts, sizeof(num_timeouts), 1, f);
+    fwrite(&num_compile_failures, sizeof(num_compile_failures), 1, f);
+    fwrite(&num_baselines, sizeof(num_baselines), 1, f);
+    fwrite(baseline_fitness, sizeof(baseline_fitness), 1, f);
+    fwrite(&control_reference, sizeof(control_reference), 1, f);
+    fwrite(&drift, sizeof(drift), 1, f);
+    fwrite(&drift_min, sizeof(drift_min), 1, f);
+    fwrite(&drift_max, sizeof(drift_max), 1, f);
+    fwrite(&control_samples, sizeof(control_samples), 1, f);
+    fwrite(&drift_measured, sizeof(drift_measured), 1, f);
+    fwrite(&proxy_threshold, sizeof(proxy_threshold), 1, f);
+
+}
+
+void evaluation_load_state(FILE* f) {
+
+    bool ok = true;
+
+    ok = ok && fread(&elite_threshold, sizeof(elite_threshold), 1, f) == 1;
+    ok = ok && fread(&runs_timed, sizeof(runs_timed), 1, f) == 1;
+    ok = ok && fread(&runs_capped, sizeof(runs_capped), 1, f) == 1;
+    ok = ok && fread(&baseline_time, sizeof(baseline_time), 1, f) == 1;
+    ok = ok && fread(&num_timeouts, sizeof(num_timeouts), 1, f) == 1;
+    ok = ok && fread(&num_compile_failures, sizeof(num_compile_failures), 1, f) == 1;
+    ok = ok && fread(&num_baselines, sizeof(num_baselines), 1, f) == 1;
+    ok = ok && fread(baseline_fitness, sizeof(baseline_fitness), 1, f) == 1;
+    ok = ok && fread(&control_reference, sizeof(control_reference), 1, f) == 1;
+    ok = ok && fread(&drift, sizeof(drift), 1, f) == 1;
+    ok = ok && fread(&drift_min, sizeof(drift_min), 1, f) == 1;
+    ok = ok && fread(&drift_max, sizeof(drift_max), 1, f) == 1;
+    ok = ok && fread(&control_samples, sizeof(control_samples), 1, f) == 1;
+    ok = ok && fread(&drift_measured, sizeof(drift_measured), 1, f) == 1;
+    ok = ok && fread(&proxy_threshold, sizeof(proxy_threshold), 1, f) == 1;
+    if (!ok || num_baselines < 0 || num_baselines > MAX_BASELINES) {
+        printf("The evaluation state of the checkpoint is damaged.\n\nAborting code\n\n");
+        exit(0);
+    }
+
+}
+
+typedef struct BaselineBuild {
+    char** opt_commands;
+    char** bc_commands;
+    int num_levels;
+    int next;                   //Next level a thread builds
+    pthread_mutex_t lock;
+} BaselineBuild;
+
+static void* evaluation_build_worker(void* arg) {
+
+    BaselineBuild* build = (BaselineBuild*)arg;
+
+    while (true) {
+        pthread_mutex_lock(&build->lock);
+        int i = build->next++;
+        pthread_mutex_unlock(&build->lock);
+        if (i >= build->num_levels) {
+            break;
+        }
+        llvm_run_command(build->opt_commands[i]);
+        llvm_run_command(build->bc_commands[i]);
+    }
+    return NULL;
+
+}
+
+/*
+ * Runs the opt and build commands of the baseline levels on the evaluation
+ * workers, the levels do not depend on each other
+ */
+void evaluation_build_baselines(char** opt_commands, char** bc_commands, int num_levels) {
+
+    BaselineBuild build = {opt_commands, bc_commands, num_levels, 0};
+    int num_threads = eval_settings.num_workers < num_levels ? eval_settings.num_workers : num_levels;
+    pthread_t threads[num_threads > 0 ? num_threads : 1];
+
+    pthread_mutex_init(&build.lock, NULL);
+    for (int t = 0; t < num_threads; t++) {
+        pthread_create(&threads[t], NULL, evaluation_build_worker, &build);
+    }
+    for (int t = 0; t < num_threads; t++) {
+        pthread_join(threads[t], NULL);
+    }
+    pthread_mutex_destroy(&build.lock);
+
+}
+
+/*
+ * Limits of every timed run of an individual. There is no timeout before the
+ * baselines have been timed, they are what the timeout is derived from
+ */
+static void evaluation_limits(LaunchLimits* limits) {
+
+    limits->timeout = 0.0;
+    if (eval_settings.timeout_factor > 0 && baseline_time > 0) {
+        limits->timeout = eval_settings.timeout_factor * baseline_time;
+        if (limits->timeout < MIN_RUN_TIMEOUT) {
+            limits->timeout = MIN_RUN_TIMEOUT;
+        }
+    }
+    limits->mem_limit = eval_settings.mem_limit;
+
+}
+
+/*
+ * Turns the counters off again if perf_event_open is not allowed here, fitness
+ * then falls back to wall time for the whole run
+ */
+void evaluation_check_counters() {
+
+    char reason[200];
+
+    if (!eval_settings.perf_counters) {
+        return;
+    }
+    if (!launcher_counters_available(reason)) {
+        printf("Hardware performance counters are not available (%s), measuring wall time instead\n", reason);
+        eval_settings.perf_counters = false;
+        eval_settings.metric = METRIC_TIME;
+    }
+
+}
+
+/*
+ * The native mode needs llc and clang++ to produce a working executable.
+ * The unoptimized linked module is built once before anything is timed, and
+ * if that fails the whole run, baselines included, falls back to lli
+ */
+void evaluation_check_exec_mode(char* test_file, const char* cache_id) {
+
+    char ll_file[300];
+    char build_command[1000];
+    char run_command[1000];
+
+    if (eval_settings.exec_mode != EXEC_NATIVE) {
+        return;
+    }
+    llvm_form_base_file(test_file, cache_id, ll_file);
+    strcat(ll_file, "_linked.ll");
+    llvm_form_measure_commands(ll_file, true, build_command, run_command);
+    if (llvm_run_command(build_command) != 0) {
+        printf("Could not build a native executable with llc and clang++, timing with lli instead\n");
+        eval_settings.exec_mode = EXEC_JIT;
+    }
+
+}
+
+/*
+ * Compile workers are only allowed to overlap with timed runs if they can be
+ * kept off the measurement cores, otherwise opt would add noise to the runtimes
+ */
+static bool evaluation_compile_cores(cpu_set_t* compile_cores) {
+
+    if (eval_settings.num_measure_cores == 0) {
+        return false;
+    }
+    if (sched_getaffinity(0, sizeof(cpu_set_t), compile_cores) != 0) {
+        return false;
+    }
+    for (int c = 0; c < eval_settings.num_measure_cores; c++) {
+        if (eval_settings.measure_cores[c] < CPU_SETSIZE) {
+            CPU_CLR(eval_settings.measure_cores[c], compile_cores);
+        }
+    }
+    return CPU_COUNT(compile_cores) > 0;
+
+}
+
+/*
+ * Scores the optimized module of a job once, and tells whether a new individual is
+ * left untimed because its score is clearly above the worst of the elites
+ */
+static bool evaluation_filter_job(EvalJob* job) {
+
+    DataNode* d = job->indiv_data;
+    ProxyStats stats;
+
+    if (d->proxy < 0 && proxy_measure(job->output_file, eval_settings.proxy_mca, &stats)) {
+        d->proxy = proxy_score(&stats);
+    }
+    if (d->num_eval > 0 || d->proxy < 0 || proxy_threshold < 0) {
+        return false;
+    }
+    return d->proxy > proxy_threshold * (1 + eval_settings.proxy_margin);
+
+}
+
+static void* evaluation_compile_worker(void* arg) {
+
+    EvalWorker* worker = (EvalWorker*)arg;
+    EvalBatch* batch = worker->batch;
+    char input_file[300];
+    char opt_command[5000];
+    char build_command[1000];
+    char job_id[50];
+
+    if (batch->pin_compile) {
+        pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &batch->compile_cores);
+    }
+
+    strcpy(input_file, batch->base_file);
+    strcat(input_file, "_linked.ll");
+
+    // the linked module is parsed once per worker and reused by all later batches,
+    // a module that failed to parse is not tried again and the worker falls back to opt
+    LLVMApiModule* api_module = NULL;
+    if (llvm_api_enabled() && strcmp(api_failed[worker->id], input_file) != 0) {
+        if (!llvm_api_loaded_from(api_modules[worker->id], input_file)) {
+            llvm_api_free(api_modules[worker->id]);
+            api_modules[worker->id] = llvm_api_load(input_file);
+            if (api_modules[worker->id] == NULL) {
+                strcpy(api_failed[worker->id], input_file);
+            }
+        }
+        api_module = api_modules[worker->id];
+    }
+
+    while (true) {
+        pthread_mutex_lock(&batch->lock);
+        while (batch->next_compile < batch->batch_size && (!batch->jobs[batch->next_compile].measure || batch->jobs[batch->next_compile].stored)) {
+            batch->next_compile++;
+        }
+        if (batch->next_compile == batch->batch_size) {
+            pthread_mutex_unlock(&batch->lock);
+            break;
+        }
+        EvalJob* job = &batch->jobs[batch->next_compile++];
+        pthread_mutex_unlock(&batch->lock);
+
+        // every worker writes into its own namespace, no two jobs share an output file
+        sprintf(job_id, "_w%d_j%ld", worker->id, (long)(job - batch->jobs));
+        strcpy(job->output_file, batch->base_file);
+        strcat(job->output_file, job_id);
+
+        job->status = EVAL_OK;
+
+        // a sequence the pass builder cannot run as one pipeline is optimized by opt instead
+        bool optimized = false;
+        if (api_module != NULL) {
+            size_t prefix = strlen(job->output_file);
+            strcat(job->output_file, "_shackleton.bc");
+            optimized = llvm_api_optimize(api_module, job->indiv, job->output_file);
+            if (!optimized) {
+                unlink(job->output_file);
+                job->output_file[prefix] = '\0';
+            }
+        }
+        if (!optimized) {
+            strcat(job->output_file, "_shackleton.ll");
+            // a failing opt must not leave an older module behind to be timed in its place
+            unlink(job->output_file);
+            llvm_form_opt_command(job->indiv, NULL, 0, input_file, job->output_file, opt_command);
+            optimized = llvm_run_command(opt_command) == 0;
+        }
+
+        // a new individual whose module looks clearly slower than the elites' is never timed
+        if (optimized && eval_settings.proxy_filter && evaluation_filter_job(job)) {
+            job->status = EVAL_FILTERED;
+        }
+
+        // pass sequences that produce a byte-identical module share one set of measurements.
+        // A first evaluation takes the runs of the module, a re-evaluation adds new runs to them
+        job->ir_entry = NULL;
+        job->reuse = false;
+        if (optimized && eval_settings.ir_reuse && job->status != EVAL_FILTERED) {
+            long size;
+            uint64_t hash = irtable_hash_file(job->output_file, &size);
+            if (size >= 0) {
+                bool found;
+                job->ir_entry = irtable_find_or_add(hash, size, &found);
+                job->reuse = found && job->indiv_data->num_eval == 0;
+            }
+            irtable_count(job->reuse, batch->num_runs);
+        }
+
+        // llc and linking, or llvm-as for lli, happen here and never inside the timed runs
+        llvm_form_measure_commands(job->output_file, eval_settings.exec_mode == EXEC_NATIVE, build_command, job->run_command);
+        if (job->reuse || job->status == EVAL_FILTERED) {
+            strcpy(build_command, "");
+        } else if (!optimized || (strlen(build_command) > 0 && llvm_run_command(build_command) != 0)) {
+            // nothing to time, the individual gets the maximum fitness without a single run
+            job->status = EVAL_COMPILE_FAILED;
+        }
+
+        pthread_mutex_lock(&batch->lock);
+        job->compiled = true;
+        pthread_cond_broadcast(&batch->compiled);
+        pthread_mutex_unlock(&batch->lock);
+    }
+    return NULL;
+
+}
+
+/*
+ * Prepares the timed runs of a job. Returns false if the job is not timed at all
+ */
+static bool evaluation_start_job(EvalBatch* batch, EvalJob* job, EvalSampling* sampling) {
+
+    if (job->reuse) {
+        // filled in from the IR table once every job of the batch is timed
+        unlink(job->output_file);
+        return false;
+    }
+    if (job->status == EVAL_COMPILE_FAILED || job->status == EVAL_FILTERED) {
+        return false;
+    }
+
+    // individuals are timed until their interval clears the elite threshold, at most num_runs times
+    sampling->stop = (SampleStop){eval_settings.min_runs, batch->threshold, eval_settings.ci_precision, 0};
+    SampleStop* rule = eval_settings.min_runs > 0 ? &sampling->stop : NULL;
+    // a raced job may take the runs that the jobs it eliminated left over
+    uint32_t num_runs = job->race >= 0 ? batch->num_runs * RACE_MAX_SHARE : batch->num_runs;
+    fitness_sampler_init(&sampling->sampler, job->run_command, num_runs, rule, &batch->limits, job->all_runtime);
+    return true;
+
+}
+
+static void evaluation_finish_job(EvalBatch* batch, EvalJob* job, EvalSampling* sampling) {
+
+    char bc_file[300];
+    char exe_file[300];
+    double tol = 0.95;
+
+    if (job->reuse) {
+        return;
+    }
+
+    if (job->status == EVAL_COMPILE_FAILED || job->status == EVAL_FILTERED) {
+        memset(&job->usage, 0, sizeof(LaunchResult));
+        job->success_runs = 0;
+        job->attempted_runs = 0;
+        job->avg_time = UINT32_MAX;
+    } else {
+        double total_time = fitness_sampler_finish(&sampling->sampler, &job->success_runs, &job->usage);
+        job->attempted_runs = sampling->sampler.attempted_runs;
+
+        // Added 6/21/2021
+        if (job->usage.timed_out) {
+            job->status = EVAL_TIMEOUT;
+            job->avg_time = UINT32_MAX;
+        } else if (job->success_runs < job->attempted_runs * tol) {
+            job->status = EVAL_RUN_FAILED;
+            job->avg_time = UINT32_MAX;
+        } else {
+            job->avg_time = total_time / job->success_runs;
+        }
+    }
+
+    strcpy(exe_file, job->output_file);
+    *strrchr(exe_file, '.') = 0;
+    strcpy(bc_file, exe_file);
+    strcat(bc_file, ".bc");
+    unlink(job->output_file);
+    unlink(bc_file);
+    unlink(exe_file);
+
+}
+
+static void evaluation_pin_measure_worker(EvalWorker* worker) {
+
+    if (worker->core >= 0) {
+        cpu_set_t core;
+        CPU_ZERO(&core);
+        CPU_SET(worker->core, &core);
+        if (pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &core) != 0) {
+            printf("Could not pin timed runs to core %d, measuring unpinned\n", worker->core);
+        }
+    }
+
+}
+
+// 95% t interval of the mean of the runs a raced job took so far in the batch
+static void evaluation_race_interval(RunStats* s, double* low, double* high) {
+
+    double half_width = runstats_t95(s->count - 1) * sqrt(runstats_var(s) / s->count);
+
+    *low = s->mean - half_width;
+    *high = s->mean + half_width;
+
+}
+
+/*
+ * Interval of the runs an IR table entry holds, for a member of a race that reuses
+ * them. False while the module has no successful runs from an earlier batch
+ */
+static bool evaluation_reuse_interval(IREntry* e, uint32_t min_runs, double* low, double* high) {
+
+    RunStats s;
+
+    if (e == NULL || !e->measured || e->status != EVAL_OK || (uint32_t)e->num_samples < min_runs) {
+        return false;
+    }
+    runstats_init(&s);
+    for (int r = 0; r < e->num_samples; r++) {
+        runstats_add(&s, e->runtimes[r]);
+    }
+    evaluation_race_interval(&s, low, high);
+    return true;
+
+}
+
+/*
+ * Whether a raced job takes no more runs, called with the batch locked. A job is
+ * eliminated once another member of its race is faster beyond doubt. Members that
+ * are not timed in the batch take part with the interval of their earlier runs,
+ * members that reuse a module of the IR table with the interval of its runs.
+ * Beyond its own share of runs a job only goes on while the race has runs left
+ * and a member with an interval still overlaps it. Only members that are compiled
+ * and actually timed add their share to the runs of the race, so racing never
+ * takes more runs than timing every member on its own
+ */
+static bool evaluation_race_over(EvalBatch* batch, uint32_t i) {
+
+    EvalJob* job = &batch->jobs[i];
+    EvalSampling* sampling = &batch->sampling[i];
+    uint32_t min_runs = eval_settings.race_min_runs > 1 ? eval_settings.race_min_runs : 2;
+    uint32_t race_runs = 0;
+    uint32_t race_budget = 0;
+    bool overlap = false;
+    double low, high;
+
+    if (sampling->race_stats.count < min_runs) {
+        return false;
+    }
+    evaluation_race_interval(&sampling->race_stats, &low, &high);
+    for (uint32_t j = 0; j < batch->batch_size; j++) {
+        EvalJob* other = &batch->jobs[j];
+        double other_low, other_high;
+        if (other->race != job->race || other->duplicate_of != -1) {
+            continue;
+        }
+        bool timed = other->measure && !other->stored && other->compiled && !other->reuse
+                     && other->status != EVAL_COMPILE_FAILED && other->status != EVAL_FILTERED;
+        if (timed) {
+            race_runs += batch->sampling[j].race_runs;
+            race_budget += batch->num_runs;
+        }
+        if (j == i) {
+            continue;
+        }
+        if (!other->measure && other->indiv_data->num_eval > 0 && other->indiv_data->fitness < UINT32_MAX) {
+            other_low = other->indiv_data->fitness_low;
+            other_high = other->indiv_data->fitness_high;
+        } else if (other->measure && other->compiled && other->reuse) {
+            if (!evaluation_reuse_interval(other->ir_entry, min_runs, &other_low, &other_high)) {
+                continue;
+            }
+        } else if (timed && batch->sampling[j].race_stats.count >= min_runs) {
+            evaluation_race_interval(&batch->sampling[j].race_stats, &other_low, &other_high);
+        } else {
+            continue;
+        }
+        if (other_high < low) {
+            race_eliminated++;
+            return true;
+        }
+        overlap = overlap || other_low <= high;
+    }
+    return sampling->race_runs >= batch->num_runs && (!overlap || race_runs >= race_budget);
+
+}
+
+/*
+ * One timed run of job i. The result of a raced job is added to the statistics
+ * of its race, which the other members read
+ */
+static bool evaluation_race_step(EvalBatch* batch, uint32_t i) {
+
+    EvalSampling* sampling = &batch->sampling[i];
+
+    if (batch->jobs[i].race < 0) {
+        return fitness_sampler_step(&sampling->sampler);
+    }
+    pthread_mutex_lock(&batch->lock);
+    if (evaluation_race_over(batch, i)) {
+        sampling->sampler.done = true;
+    }
+    pthread_mutex_unlock(&batch->lock);
+
+    uint32_t success_runs = sampling->sampler.success_runs;
+    bool more = fitness_sampler_step(&sampling->sampler);
+
+    pthread_mutex_lock(&batch->lock);
+    if (sampling->sampler.success_runs > success_runs) {
+        runstats_add(&sampling->race_stats, sampling->sampler.all_runtime[success_runs]);
+    }
+    sampling->race_runs = sampling->sampler.attempted_runs;
+    pthread_mutex_unlock(&batch->lock);
+    return more;
+
+}
+
+static void* evaluation_measure_worker(void* arg) {
+
+    EvalWorker* worker = (EvalWorker*)arg;
+    EvalBatch* batch = worker->batch;
+
+    evaluation_pin_measure_worker(worker);
+
+    while (true) {
+        pthread_mutex_lock(&batch->lock);
+        while (batch->next_measure < batch->batch_size && (!batch->jobs[batch->next_measure].measure || batch->jobs[batch->next_measure].stored)) {
+            batch->next_measure++;
+        }
+        if (batch->next_measure == batch->batch_size) {
+            pthread_mutex_unlock(&batch->lock);
+            break;
+        }
+        uint32_t i = batch->next_measure++;
+        EvalJob* job = &batch->jobs[i];
+        while (!job->compiled) {
+            pthread_cond_wait(&batch->compiled, &batch->lock);
+        }
+        pthread_mutex_unlock(&batch->lock);
+
+        if (evaluation_start_job(batch, job, &batch->sampling[i])) {
+            while (evaluation_race_step(batch, i)) {
+            }
+        }
+        evaluation_finish_job(batch, job, &batch->sampling[i]);
+    }
+    return NULL;
+
+}
+
+/*
+ * Takes one timed run of every compiled job in turn, so slow drift of the machine
+ * is spread evenly over the jobs instead of hitting whichever is timed during it.
+ * A job stays with the thread that took its first run, so all its runs share a core
+ */
+static void* evaluation_interleave_worker(void* arg) {
+
+    EvalWorker* worker = (EvalWorker*)arg;
+    EvalBatch* batch = worker->batch;
+    uint32_t next = 0;
+    uint32_t rounds = 0;
+
+    evaluation_pin_measure_worker(worker);
+
+    while (true) {
+        int picked = -1;
+        pthread_mutex_lock(&batch->lock);
+        // the control runs of thread 0 are spread evenly over the rounds of the batch
+        if (worker->id == 0 && batch->control_on && !batch->control.done &&
+            (uint64_t)rounds * eval_settings.control_runs >= (uint64_t)batch->control_taken * batch->num_runs) {
+            batch->control_taken++;
+            pthread_mutex_unlock(&batch->lock);
+            batch->control.done = !fitness_sampler_step(&batch->control.sampler);
+            continue;
+        }
+        while (batch->num_sampled < batch->num_measured) {
+            for (uint32_t k = 0; k < batch->batch_size && picked == -1; k++) {
+                uint32_t i = (next + k) % batch->batch_size;
+                EvalSampling* sampling = &batch->sampling[i];
+                if (batch->jobs[i].measure && !batch->jobs[i].stored && batch->jobs[i].compiled && !sampling->done && !sampling->busy &&
+                    (sampling->owner == -1 || sampling->owner == worker->id)) {
+                    picked = i;
+                }
+            }
+            if (picked != -1) {
+                break;
+            }
+            pthread_cond_wait(&batch->compiled, &batch->lock);
+        }
+        if (picked == -1) {
+            pthread_mutex_unlock(&batch->lock);
+            break;
+        }
+        EvalJob* job = &batch->jobs[picked];
+        EvalSampling* sampling = &batch->sampling[picked];
+        sampling->busy = true;
+        sampling->owner = worker->id;
+        // the round-robin cursor wrapped around, a new round of runs starts
+        if ((uint32_t)picked < next) {
+            rounds++;
+        }
+        next = picked + 1;
+        pthread_mutex_unlock(&batch->lock);
+
+        bool more;
+        if (!sampling->started) {
+            sampling->started = true;
+            more = evaluation_start_job(batch, job, sampling) && evaluation_race_step(batch, picked);
+        } else {
+            more = evaluation_race_step(batch, picked);
+        }
+        if (!more) {
+            evaluation_finish_job(batch, job, sampling);
+        }
+
+        pthread_mutex_lock(&batch->lock);
+        sampling->busy = false;
+        if (!more) {
+            sampling->done = true;
+            batch->num_sampled++;
+            // waiting threads exit once every job is done
+            pthread_cond_broadcast(&batch->compiled);
+        }
+        pthread_mutex_unlock(&batch->lock);
+    }
+    return NULL;
+
+}
+
+static void evaluation_run_threads(EvalWorker* workers, int num_workers, void* (*routine)(void*)) {
+
+    for (int w = 0; w < num_workers; w++) {
+        if (pthread_create(&workers[w].thread, NULL, routine, &workers[w]) != 0) {
+            printf("Could not start evaluation thread.\n\nAborting code\n\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+
+}
+
+static void evaluation_join_threads(EvalWorker* workers, int num_workers) {
+
+    for (int w = 0; w < num_workers; w++) {
+        pthread_join(workers[w].thread, NULL);
+    }
+
+}
+
+/*
+ * Takes the most recent runs of the identical module as the runs of the individual
+ */
+static void evaluation_reuse_job(EvalJob* job, uint32_t num_runs) {
+
+    IREntry* e = job->ir_entry;
+    double total_time = 0.0;
+
+    job->success_runs = irtable_get_samples(e, job->all_runtime, num_runs);
+    for (uint32_t r = 0; r < job->success_runs; r++) {
+        total_time += job->all_runtime[r];
+    }
+    job->status = e->status;
+    if (e->status != EVAL_OK || job->success_runs == 0) {
+        job->avg_time = UINT32_MAX;
+    } else {
+        job->avg_time = total_time / job->success_runs;
+    }
+    job->usage = e->usage;
+
+}
+
+void evaluation_print_stats() {
+
+    if (eval_settings.ir_reuse) {
+        irtable_print_stats();
+    }
+    printf("Failed evaluations: %lu compile failures, %lu timeouts\n", (unsigned long)num_compile_failures, (unsigned long)num_timeouts);
+    if (eval_settings.min_runs > 0) {
+        printf("Adaptive sampling: %lu timed runs instead of %lu\n", (unsigned long)runs_timed, (unsigned long)runs_capped);
+    }
+    if (proxy_scored > 0) {
+        printf("Proxy filter: %lu of %lu new individuals not timed\n", (unsigned long)proxy_filtered, (unsigned long)proxy_scored);
+    }
+    if (reeval_candidates > 0) {
+        printf("Re-evaluation: %lu of %lu individuals timed again, %lu clearly worse than the elites left alone\n", (unsigned long)reeval_timed, (unsigned long)reeval_candidates, (unsigned long)reeval_losers);
+    }
+    if (race_runs_capped > 0) {
+        printf("Racing: %lu individuals eliminated early, %lu timed runs instead of %lu\n", (unsigned long)race_eliminated, (unsigned long)race_runs, (unsigned long)race_runs_capped);
+    }
+    if (drift_measured) {
+        printf("Drift control: %lu runs of %s, %.3f to %.3f times its start-up time, %.3f in the last batch\n", (unsigned long)control_samples, eval_settings.control_level, drift_min, drift_max, drift);
+    }
+    if (fitstore_is_open()) {
+        fitstore_print_stats();
+    }
+
+}
+
+void evaluation_free() {
+
+    for (int w = 0; w < num_api_modules; w++) {
+        llvm_api_free(api_modules[w]);
+    }
+    free(api_modules);
+    free(api_failed);
+    api_modules = NULL;
+    api_failed = NULL;
+    num_api_modules = 0;
+    irtable_free();
+    fitstore_close();
+    store_opened = false;
+
+}
+
+static void evaluation_update_drift(FitnessSampler* control, bool vis) {
+
+    uint32_t success_runs;
+    double total_time = fitness_sampler_finish(control, &success_runs, NULL);
+
+    if (success_runs == 0) {
+        return;
+    }
+    drift = total_time / success_runs / control_reference;
+    drift_min = !drift_measured || drift < drift_min ? drift : drift_min;
+    drift_max = !drift_measured || drift > drift_max ? drift : drift_max;
+    drift_measured = true;
+    control_samples += success_runs;
+    if (vis) {
+        printf("Control %s: %.3f times its start-up time over %u runs\n", eval_settings.control_level, drift, success_runs);
+    }
+
+}
+
+/*
+ * Fills in a job from the fitness store. Returns false if the pass sequence
+ * was never evaluated on this target
+ */
+static bool evaluation_stored_job(EvalJob* job, uint32_t num_runs) {
+
+    double total_time = 0.0;
+
+    if (!fitstore_get(fitstore_genome_hash(job->indiv), job->all_runtime, num_runs, &job->success_runs, &job->status, &job->usage)) {
+        return false;
+    }
+    for (uint32_t r = 0; r < job->success_runs; r++) {
+        total_time += job->all_runtime[r];
+    }
+    if (job->status != EVAL_OK || job->success_runs == 0) {
+        job->avg_time = UINT32_MAX;
+    } else {
+        job->avg_time = total_time / job->success_runs;
+    }
+    job->attempted_runs = job->success_runs;
+    job->stored = true;
+    return true;
+
+}
+
+// one parsed linked module for each of the first num_workers workers
+static void evaluation_reserve_api_modules(int num_workers) {
+
+    if (num_api_modules < num_workers) {
+        api_modules = realloc(api_modules, num_workers * sizeof(LLVMApiModule*));
+        api_failed = realloc(api_failed, num_workers * sizeof(*api_failed));
+        for (int w = num_api_modules; w < num_workers; w++) {
+            api_modules[w] = NULL;
+            api_failed[w][0] = '\0';
+        }
+        num_api_modules = num_workers;
+    }
+
+}
+
+static void evaluation_init_job(EvalJob* job, node_str* indiv, DataNode* indiv_data, double* runtimes, int race) {
+
+    job->indiv = indiv;
+    job->indiv_data = indiv_data;
+    job->duplicate_of = -1;
+    job->measure = false;
+    job->compiled = false;
+    job->ir_entry = NULL;
+    job->reuse = false;
+    job->stored = false;
+    job->all_runtime = runtimes;
+    job->success_runs = 0;
+    job->attempted_runs = 0;
+    job->status = EVAL_OK;
+    job->race = race;
+
+}
+
+static void evaluation_init_sampling(EvalSampling* sampling) {
+
+    sampling->owner = -1;
+    sampling->started = false;
+    sampling->busy = false;
+    sampling->done = false;
+    sampling->race_runs = 0;
+    runstats_init(&sampling->race_stats);
+
+}
+
+static void evaluation_open_store(char* test_file, const char* cache_id) {
+
+    if (strlen(eval_settings.store_file) > 0 && !store_opened) {
+        char linked_file[300];
+        store_opened = true;
+        llvm_form_base_file(test_file, cache_id, linked_file);
+        strcat(linked_file, "_linked.ll");
+        if (!fitstore_open(eval_settings.store_file, linked_file)) {
+            printf("Could not open the fitness store %s, measuring without it\n", eval_settings.store_file);
+        }
+    }
+
+}
+
+/*
+ * Adds the outcome of every job to the IR table, the fitness store and the DataNodes,
+ * on the calling thread and in job order. Jobs that were not measured keep their fitness
+ */
+static void evaluation_record_jobs(EvalJob* jobs, uint32_t batch_size, uint32_t max_runs, double* fitness_values, int gen, bool fitness_with_var) {
+
+    // new runs are added to the table first, a job can reuse a module timed earlier in the same batch
+    for (uint32_t i = 0; i < batch_size; i++) {
+        if (jobs[i].measure && !jobs[i].stored && eval_settings.proxy_filter && proxy_threshold >= 0) {
+            proxy_scored += jobs[i].indiv_data->num_eval == 0 && jobs[i].indiv_data->proxy >= 0;
+            proxy_filtered += jobs[i].status == EVAL_FILTERED;
+        }
+        if (jobs[i].measure && !jobs[i].reuse && !jobs[i].stored) {
+            runs_timed += jobs[i].attempted_runs;
+            runs_capped += max_runs;
+            if (jobs[i].race >= 0) {
+                race_runs += jobs[i].attempted_runs;
+                race_runs_capped += max_runs;
+            }
+            num_timeouts += jobs[i].status == EVAL_TIMEOUT;
+            num_compile_failures += jobs[i].status == EVAL_COMPILE_FAILED;
+        }
+        if (jobs[i].measure && !jobs[i].reuse && !jobs[i].stored && jobs[i].ir_entry != NULL) {
+            irtable_add_samples(jobs[i].ir_entry, jobs[i].all_runtime, jobs[i].success_runs, jobs[i].status, &jobs[i].usage);
+        }
+    }
+    for (uint32_t i = 0; i < batch_size; i++) {
+        if (jobs[i].measure && jobs[i].reuse) {
+            evaluation_reuse_job(&jobs[i], max_runs);
+        }
+        // a filtered individual has no runs for other runs to take
+        if (jobs[i].measure && !jobs[i].stored && jobs[i].status != EVAL_FILTERED && fitstore_is_open()) {
+            fitstore_put(fitstore_genome_hash(jobs[i].indiv), jobs[i].all_runtime, jobs[i].success_runs, jobs[i].status, &jobs[i].usage);
+        }
+    }
+
+    for (uint32_t i = 0; i < batch_size; i++) {
+        if (jobs[i].measure) {
+            fitness_values[i] = node_record_data(jobs[i].indiv_data, jobs[i].indiv, jobs[i].all_runtime, jobs[i].avg_time, jobs[i].success_runs, gen, fitness_with_var);
+            node_record_usage(jobs[i].indiv_data, jobs[i].usage.utime, jobs[i].usage.stime, jobs[i].usage.maxrss);
+            node_record_status(jobs[i].indiv_data, jobs[i].status);
+            if (jobs[i].usage.counted) {
+                node_record_counters(jobs[i].indiv_data, jobs[i].usage.instructions, jobs[i].usage.cycles, jobs[i].usage.branch_misses, jobs[i].usage.cache_misses);
+            }
+        } else {
+            fitness_values[i] = jobs[i].indiv_data->fitness;
+        }
+    }
+
+}
+
+/*
+ * How much another evaluation of d is worth, false if it is not worth any. Lower is
+ * better, so the optimistic end of the interval is its low end: an individual whose
+ * low end is above the worst elite is a well-characterized loser. The others are
+ * worth more the wider their interval is next to their fitness
+ */
+static bool evaluation_reeval_priority(DataNode* d, double* priority) {
+
+    if (d->fitness >= UINT32_MAX) {
+        // left out by a filter, it was never timed; failures are not tried again
+        *priority = INFINITY;
+        return d->status[node_last_row(d)] == EVAL_FILTERED;
+    }
+    if (d->fitness_low > elite_threshold) {
+        return false;
+    }
+    double width = d->fitness_high - d->fitness_low;
+    *priority = d->fitness > 0 ? width / d->fitness : width;
+    return true;
+
+}
+
+/*
+ * Chooses the individuals of a batch that are timed again, in place of the coin flip
+ * of node_reeval_by_chance: at most reeval_budget of the ones timed before, not in
+ * generation gen, by decreasing priority. Returns how many it chose
+ */
+static uint32_t evaluation_schedule_reevals(EvalJob* jobs, uint32_t batch_size, int gen) {
+
+    uint32_t candidates[batch_size];
+    double priority[batch_size];
+    uint32_t num_candidates = 0;
+    uint32_t num_seen = 0;
+
+    for (uint32_t i = 0; i < batch_size; i++) {
+        DataNode* d = jobs[i].indiv_data;
+        if (jobs[i].measure || jobs[i].duplicate_of != -1 || d->num_eval == 0 || node_timed_in_gen(d, gen)) {
+            continue;
+        }
+        num_seen++;
+        if (evaluation_reeval_priority(d, &priority[num_candidates])) {
+            candidates[num_candidates++] = i;
+        } else {
+            reeval_losers++;
+        }
+    }
+    uint32_t budget = (uint32_t)ceil(eval_settings.reeval_budget * num_seen);
+    uint32_t chosen = 0;
+    for (; chosen < budget && chosen < num_candidates; chosen++) {
+        uint32_t best = chosen;
+        for (uint32_t c = chosen + 1; c < num_candidates; c++) {
+            best = priority[c] > priority[best] ? c : best;
+        }
+        uint32_t i = candidates[best];
+        double p = priority[best];
+        candidates[best] = candidates[chosen];
+        priority[best] = priority[chosen];
+        candidates[chosen] = i;
+        priority[chosen] = p;
+        jobs[i].measure = true;
+    }
+    reeval_candidates += num_seen;
+    reeval_timed += chosen;
+    return chosen;
+
+}
+
+/*
+ * Evaluates a whole batch of individuals. For LLVM passes the decisions that use
+ * rand() and the updates of the DataNodes are made on the calling thread in
+ * batch order, only the opt and timed runs are handed to the worker threads.
+ * race is the race of each individual, -1 for none, NULL if nothing is raced.
+ * With force every raced individual is timed again
+ */
+static void evaluation_run_batch(node_str** indivs, DataNode** indiv_data, int* race, bool force, uint32_t batch_size, double* fitness_values, bool vis, char* test_file, char** src_files, uint32_t num_src_files, bool cache, char* cache_file, const char *cache_id, uint32_t num_runs, int gen, bool fitness_with_var) {
+
+    if (batch_size == 0) {
+        return;
+    }
+
+    // other object types have no compile step to spread over workers
+    if (OBJECT_TYPE(indivs[0]) != LLVM_PASS) {
+        for (uint32_t i = 0; i < batch_size; i++) {
+            fitness_values[i] = fitness_top(indivs[i], vis, test_file, src_files, num_src_files, cache, cache_file, cache_id, indiv_data[i], num_runs, gen, fitness_with_var);
+        }
+        return;
+    }
+
+    EvalJob jobs[batch_size];
+    uint32_t max_runs = eval_settings.max_runs > 0 ? eval_settings.max_runs : num_runs;
+    double runtimes[batch_size][race != NULL ? max_runs * RACE_MAX_SHARE : max_runs];
+    uint32_t num_measured = 0;
+
+    for (uint32_t i = 0; i < batch_size; i++) {
+        evaluation_init_job(&jobs[i], indivs[i], indiv_data[i], runtimes[i], race != NULL ? race[i] : -1);
+        for (uint32_t j = 0; j < i; j++) {
+            if (indiv_data[j] == indiv_data[i]) {
+                jobs[i].duplicate_of = j;
+                break;
+            }
+        }
+        bool reeval = eval_settings.reeval_ucb ? indiv_data[i]->num_eval == 0 : node_reeval_by_chance(indiv_data[i], gen);
+        jobs[i].measure = jobs[i].duplicate_of == -1 && ((force && jobs[i].race >= 0) || reeval);
+        if (jobs[i].measure) {
+            num_measured++;
+        }
+    }
+    if (eval_settings.reeval_ucb) {
+        num_measured += evaluation_schedule_reevals(jobs, batch_size, gen);
+    }
+
+    // first evaluations take the runs that earlier or concurrent runs on the same target stored
+    evaluation_open_store(test_file, cache_id);
+    for (uint32_t i = 0; i < batch_size && fitstore_is_open(); i++) {
+        if (jobs[i].measure && indiv_data[i]->num_eval == 0 && evaluation_stored_job(&jobs[i], max_runs)) {
+            num_measured--;
+        }
+    }
+
+    if (vis && num_measured > 0) {
+        printf("Calculating fitness of %d individuals\n", num_measured);
+    }
+
+    EvalSampling sampling[batch_size];
+    for (uint32_t i = 0; i < batch_size; i++) {
+        evaluation_init_sampling(&sampling[i]);
+    }
+
+    EvalBatch batch;
+    batch.jobs = jobs;
+    batch.sampling = sampling;
+    batch.batch_size = batch_size;
+    batch.num_measured = num_measured;
+    batch.num_sampled = 0;
+    batch.num_runs = max_runs;
+    batch.threshold = elite_threshold;
+    evaluation_limits(&batch.limits);
+    batch.next_compile = 0;
+    batch.next_measure = 0;
+    llvm_form_base_file(test_file, cache_id, batch.base_file);
+    batch.pin_compile = evaluation_compile_cores(&batch.compile_cores);
+    pthread_mutex_init(&batch.lock, NULL);
+    pthread_cond_init(&batch.compiled, NULL);
+
+    // a few runs of the control level track how much faster or slower the machine is than at start-up
+    double control_runtime[eval_settings.control_runs > 0 ? eval_settings.control_runs : 1];
+    batch.control_on = num_measured > 0 && eval_settings.control_runs > 0 && strlen(control_command) > 0;
+    batch.control_taken = 0;
+    batch.control.done = !batch.control_on;
+    if (batch.control_on) {
+        fitness_sampler_init(&batch.control.sampler, control_command, eval_settings.control_runs, NULL, &batch.limits, control_runtime);
+    }
+
+    int num_compile = eval_settings.num_workers < (int)num_measured ? eval_settings.num_workers : (int)num_measured;
+    evaluation_reserve_api_modules(num_compile);
+    int num_measure = eval_settings.num_measure_cores > 0 ? eval_settings.num_measure_cores : 1;
+    EvalWorker compile_workers[num_compile > 0 ? num_compile : 1];
+    EvalWorker measure_workers[num_measure];
+
+    for (int w = 0; w < num_compile; w++) {
+        compile_workers[w].batch = &batch;
+        compile_workers[w].id = w;
+        compile_workers[w].core = -1;
+    }
+    for (int w = 0; w < num_measure; w++) {
+        measure_workers[w].batch = &batch;
+        measure_workers[w].id = w;
+        measure_workers[w].core = eval_settings.num_measure_cores > 0 ? eval_settings.measure_cores[w] : -1;
+    }
+
+    if (num_measured > 0) {
+        evaluation_run_threads(compile_workers, num_compile, evaluation_compile_worker);
+        if (!batch.pin_compile) {
+            // no core is free of timed runs, finish every opt before the first timed run
+            evaluation_join_threads(compile_workers, num_compile);
+        }
+        evaluation_run_threads(measure_workers, num_measure, eval_settings.interleave ? evaluation_interleave_worker : evaluation_measure_worker);
+        evaluation_join_threads(measure_workers, num_measure);
+        if (batch.pin_compile) {
+            evaluation_join_threads(compile_workers, num_compile);
+        }
+    }
+    if (batch.control_on) {
+        // without interleaving, or if the batch ended early, the remaining control runs follow the batch
+        while (!batch.control.done) {
+            batch.control.done = !fitness_sampler_step(&batch.control.sampler);
+        }
+        evaluation_update_drift(&batch.control.sampler, vis);
+    }
+
+    pthread_mutex_destroy(&batch.lock);
+    pthread_cond_destroy(&batch.compiled);
+
+    evaluation_record_jobs(jobs, batch_size, max_runs, fitness_values, gen, fitness_with_var);
+
+}
+
+void evaluation_batch(node_str** indivs, DataNode** indiv_data, uint32_t batch_size, double* fitness_values, bool vis, char* test_file, char** src_files, uint32_t num_src_files, bool cache, char* cache_file, const char *cache_id, uint32_t num_runs, int gen, bool fitness_with_var) {
+
+    evaluation_run_batch(indivs, indiv_data, NULL, false, batch_size, fitness_values, vis, test_file, src_files, num_src_files, cache, cache_file, cache_id, num_runs, gen, fitness_with_var);
+
+}
+
+/*
+ * Evaluates a batch in which the individuals of the same race are timed against
+ * each other: an individual that another one of its race beats beyond doubt is
+ * stopped early, and the runs it leaves go to the ones that are still close
+ */
+void evaluation_race(node_str** indivs, DataNode** indiv_data, int* race, bool force, uint32_t batch_size, double* fitness_values, bool vis, char* test_file, char** src_files, uint32_t num_src_files, bool cache, char* cache_file, const char *cache_id, uint32_t num_runs, int gen, bool fitness_with_var) {
+
+    evaluation_run_batch(indivs, indiv_data, race, force, batch_size, fitness_values, vis, test_file, src_files, num_src_files, cache, cache_file, cache_id, num_runs, gen, fitness_with_var);
+
+}
+
+typedef enum {
+    SLOT_FREE,      //The slot can take a job
+    SLOT_QUEUED,    //The thread of the slot compiles and times the job
+    SLOT_DONE       //The job waits to be collected
+} eval_slot_state;
+
+/*
+ * One evaluation slot of a stream: a batch of a single job, compiled and then
+ * timed by the thread of the slot
+ */
+typedef struct EvalSlot {
+    struct EvalStream* stream;
+    EvalBatch batch;
+    EvalJob job;
+    EvalSampling sampling;
+    EvalWorker worker;
+    double* runtimes;           //Runtimes of the job, dimension: max_runs
+    int gen;                    //Generation the job is recorded in
+    eval_slot_state state;      //Guarded by the lock of the stream
+} EvalSlot;
+
+struct EvalStream {
+    EvalSlot* slots;
+    uint32_t num_slots;
+    uint32_t max_runs;
+    bool closing;               //Set once no more jobs come, the slot threads exit
+    pthread_rwlock_t machine_lock;  //Without reserved cores, read by the compile steps and written by the timed runs of the slots
+    pthread_mutex_t lock;
+    pthread_cond_t changed;     //Signalled every time a slot changes state
+};
+
+static void* evaluation_slot_worker(void* arg) {
+
+    EvalSlot* slot = (EvalSlot*)arg;
+    EvalStream* stream = slot->stream;
+
+    pthread_mutex_lock(&stream->lock);
+    while (true) {
+        while (slot->state != SLOT_QUEUED && !stream->closing) {
+            pthread_cond_wait(&stream->changed, &stream->lock);
+        }
+        if (slot->state != SLOT_QUEUED) {
+            break;
+        }
+        pthread_mutex_unlock(&stream->lock);
+        // without reserved cores the slots compile in parallel, but a timed run waits until no slot
+        // compiles and keeps the machine to itself, like the compile step before a batch is timed
+        bool shared = eval_settings.num_measure_cores == 0;
+        if (shared) {
+            pthread_rwlock_rdlock(&stream->machine_lock);
+        }
+        evaluation_compile_worker(&slot->worker);
+        if (shared) {
+            pthread_rwlock_unlock(&stream->machine_lock);
+            pthread_rwlock_wrlock(&stream->machine_lock);
+        }
+        evaluation_measure_worker(&slot->worker);
+        if (shared) {
+            pthread_rwlock_unlock(&stream->machine_lock);
+        }
+        pthread_mutex_lock(&stream->lock);
+        slot->state = SLOT_DONE;
+        pthread_cond_broadcast(&stream->changed);
+    }
+    pthread_mutex_unlock(&stream->lock);
+    return NULL;
+
+}
+
+/*
+ * Starts the slots of a stream, in which individuals are evaluated one at a time
+ * instead of in batches. Each slot owns one of the measurement cores if cores are
+ * reserved, otherwise there are num_workers slots that compile concurrently, and the
+ * timed runs of a slot wait for every compile and every other timed run to finish.
+ * Nothing is raced, the control level is not timed alongside and re-evaluation is up
+ * to the caller
+ */
+EvalStream* evaluation_stream_open(char* test_file, const char* cache_id, uint32_t num_runs) {
+
+    EvalStream* stream = malloc(sizeof(EvalStream));
+
+    stream->num_slots = eval_settings.num_measure_cores > 0 ? eval_settings.num_measure_cores : eval_settings.num_workers;
+    stream->max_runs = eval_settings.max_runs > 0 ? eval_settings.max_runs : num_runs;
+    stream->closing = false;
+    stream->slots = malloc(sizeof(EvalSlot) * stream->num_slots);
+    // timed runs are preferred, so a steady flow of compiles cannot hold them off
+    pthread_rwlockattr_t attr;
+    pthread_rwlockattr_init(&attr);
+    pthread_rwlockattr_setkind_np(&attr, PTHREAD_RWLOCK_PREFER_WRITER_NONRECURSIVE_NP);
+    pthread_rwlock_init(&stream->machine_lock, &attr);
+    pthread_rwlockattr_destroy(&attr);
+    pthread_mutex_init(&stream->lock, NULL);
+    pthread_cond_init(&stream->changed, NULL);
+    evaluation_open_store(test_file, cache_id);
+    evaluation_reserve_api_modules(stream->num_slots);
+
+    for (uint32_t s = 0; s < stream->num_slots; s++) {
+        EvalSlot* slot = &stream->slots[s];
+        EvalBatch* batch = &slot->batch;
+        slot->stream = stream;
+        slot->state = SLOT_FREE;
+        slot->runtimes = malloc(sizeof(double) * stream->max_runs);
+        batch->jobs = &slot->job;
+        batch->sampling = &slot->sampling;
+        batch->batch_size = 1;
+        batch->control_on = false;
+        batch->control.done = true;
+        batch->control_taken = 0;
+        batch->num_runs = stream->max_runs;
+        evaluation_limits(&batch->limits);
+        llvm_form_base_file(test_file, cache_id, batch->base_file);
+        batch->pin_compile = evaluation_compile_cores(&batch->compile_cores);
+        pthread_mutex_init(&batch->lock, NULL);
+        pthread_cond_init(&batch->compiled, NULL);
+        slot->worker.batch = batch;
+        slot->worker.id = s;
+        slot->worker.core = eval_settings.num_measure_cores > 0 ? eval_settings.measure_cores[s] : -1;
+        if (pthread_create(&slot->worker.thread, NULL, evaluation_slot_worker, slot) != 0) {
+            printf("Could not start evaluation thread.\n\nAborting code\n\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+    return stream;
+
+}
+
+uint32_t evaluation_stream_slots(EvalStream* stream) {
+
+    return stream->num_slots;
+
+}
+
+// whether indiv_data is being evaluated in one of the slots
+bool evaluation_stream_busy(EvalStream* stream, DataNode* indiv_data) {
+
+    bool busy = false;
+
+    pthread_mutex_lock(&stream->lock);
+    for (uint32_t s = 0; s < stream->num_slots; s++) {
+        busy = busy || (stream->slots[s].state != SLOT_FREE && stream->slots[s].job.indiv_data == indiv_data);
+    }
+    pthread_mutex_unlock(&stream->lock);
+    return busy;
+
+}
+
+/*
+ * Hands an individual to a free slot, whose thread compiles and times it while the
+ * caller goes on. The individual must not be in another slot. Returns false if every slot is busy
+ */
+bool evaluation_stream_submit(EvalStream* stream, node_str* indiv, DataNode* indiv_data, int gen) {
+
+    EvalSlot* slot = NULL;
+
+    pthread_mutex_lock(&stream->lock);
+    for (uint32_t s = 0; s < stream->num_slots && slot == NULL; s++) {
+        slot = stream->slots[s].state == SLOT_FREE ? &stream->slots[s] : NULL;
+    }
+    pthread_mutex_unlock(&stream->lock);
+    if (slot == NULL) {
+        return false;
+    }
+
+    evaluation_init_job(&slot->job, indiv, indiv_data, slot->runtimes, -1);
+    slot->job.measure = true;
+    if (fitstore_is_open() && indiv_data->num_eval == 0) {
+        evaluation_stored_job(&slot->job, stream->max_runs);
+    }
+    evaluation_init_sampling(&slot->sampling);
+    slot->batch.num_measured = slot->job.stored ? 0 : 1;
+    slot->batch.num_sampled = 0;
+    slot->batch.threshold = elite_threshold;
+    slot->batch.next_compile = 0;
+    slot->batch.next_measure = 0;
+    slot->gen = gen;
+
+    pthread_mutex_lock(&stream->lock);
+    slot->state = SLOT_QUEUED;
+    pthread_cond_broadcast(&stream->changed);
+    pthread_mutex_unlock(&stream->lock);
+    return true;
+
+}
+
+/*
+ * Waits for a job to finish and records it like a batch would. A job that takes the
+ * runs of an identical module waits until that module is timed. Returns the DataNode
+ * of the job with its fitness, NULL once no job is left
+ */
+DataNode* evaluation_stream_collect(EvalStream* stream, double* fitness, bool fitness_with_var) {
+
+    EvalSlot* slot = NULL;
+
+    pthread_mutex_lock(&stream->lock);
+    while (true) {
+        bool pending = false;
+        for (uint32_t s = 0; s < stream->num_slots && slot == NULL; s++) {
+            EvalSlot* candidate = &stream->slots[s];
+            bool done = candidate->state == SLOT_DONE;
+            if (done && !(candidate->job.reuse && !candidate->job.ir_entry->measured)) {
+                slot = candidate;
+            }
+            pending = pending || candidate->state != SLOT_FREE;
+        }
+        if (slot != NULL || !pending) {
+            break;
+        }
+        pthread_cond_wait(&stream->changed, &stream->lock);
+    }
+    pthread_mutex_unlock(&stream->lock);
+    if (slot == NULL) {
+        return NULL;
+    }
+
+    evaluation_record_jobs(&slot->job, 1, stream->max_runs, fitness, slot->gen, fitness_with_var);
+    pthread_mutex_lock(&stream->lock);
+    slot->state = SLOT_FREE;
+    pthread_mutex_unlock(&stream->lock);
+    return slot->job.indiv_data;
+
+}
+
+// stops the slot threads, every job must have been collected
+void evaluation_stream_close(EvalStream* stream) {
+
+    pthread_mutex_lock(&stream->lock);
+    stream->closing = true;
+    pthread_cond_broadcast(&stream->changed);
+    pthread_mutex_unlock(&stream->lock);
+    for (uint32_t s = 0; s < stream->num_slots; s++) {
+        EvalSlot* slot = &stream->slots[s];
+        pthread_join(slot->worker.thread, NULL);
+        pthread_mutex_destroy(&slot->batch.lock);
+        pthread_cond_destroy(&slot->batch.compiled);
+        free(slot->runtimes);
+    }
+    pthread_rwlock_destroy(&stream->machine_lock);
+    pthread_mutex_destroy(&stream->lock);
+    pthread_cond_destroy(&stream->changed);
+    free(stream->slots);
+    free(stream);
+
+}
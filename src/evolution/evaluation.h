@@ -0,0 +1,121 @@
+#ifndef EVOLUTION_EVALUATION_H_
+#define EVOLUTION_EVALUATION_H_
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include "../osaka/osaka.h"
+#include "indivdata.h"
+#include "../support/launcher.h"
+#include "irtable.h"
+#include "fitstore.h"
+#include "proxy.h"
+
+#define MAX_MEASURE_CORES 64
+
+typedef enum {
+    EXEC_NATIVE,    //llc and link every individual once, time the executable
+    EXEC_JIT        //assemble every individual once, time lli on the bitcode
+} eval_exec_mode;
+
+typedef enum {
+    METRIC_TIME,            //wall time of a run, in seconds
+    METRIC_INSTRUCTIONS,    //instructions retired by a run, in millions
+    METRIC_CYCLES           //CPU cycles of a run, in millions
+} fitness_metric;
+
+/*
+ * Settings of the evaluation engine, filled in from the command line in main.c.
+ * By default one opt runs at a time and no core is reserved for timed runs, but
+ * individuals are timed as native executables, stopped by a timeout, share the
+ * runs of byte-identical modules, take their runs in turns and are timed next to
+ * the control level. -exec_mode=jit -ir_reuse=off -timeout_factor=0 -interleave=off
+ * -control_runs=0 come closest to how the serial loop timed them with lli
+ */
+typedef struct EvalSettings {
+    int num_workers;                        //Number of opt/compile steps run concurrently
+    eval_exec_mode exec_mode;               //How individuals and baselines are run in the timed runs
+    int num_measure_cores;                  //Number of cores reserved for timed runs, 0 if none are reserved
+    int measure_cores[MAX_MEASURE_CORES];   //Ids of the cores reserved for timed runs
+    bool ir_reuse;                          //Whether individuals with an already timed optimized module reuse its runs
+    int min_runs;                           //Successful runs before an individual may stop being timed, 0 to always time max_runs
+    int max_runs;                           //Most timed runs of an individual, 0 to use the num_runs of the evolution
+    double ci_precision;                    //Relative half-width of the confidence interval at which timing stops
+    bool perf_counters;                     //Whether hardware counters are read for every timed run
+    fitness_metric metric;                  //What a timed run measures, every metric other than time needs perf_counters
+    double timeout_factor;                  //Timeout of a run as a multiple of the fastest baseline, 0 for no timeout
+    long mem_limit;                         //Address space limit of a run in megabytes, 0 for no limit
+    int warmup_runs;                        //Untimed runs before the first timed run of a command
+    bool interleave;                        //Whether a measurement thread takes the runs of its individuals in turns
+    char control_level[10];                 //Baseline level timed alongside every batch to track drift of the machine
+    int control_runs;                       //Runs of the control level per batch, 0 to time every baseline level again instead
+    char store_file[300];                   //Fitness store shared with other runs on the same target, "" for none
+    bool racing;                            //Whether the offspring of a mating are raced instead of each getting every run
+    bool race_tournaments;                  //Whether tournament contestants whose intervals overlap the winner's are raced
+    int race_min_runs;                      //Successful runs before a raced individual may be eliminated
+    bool proxy_filter;                      //Whether new individuals are only timed if their static proxy is close to the elites'
+    double proxy_margin;                    //How far above the worst proxy of the elites a new individual is still timed, relative
+    bool proxy_mca;                         //Whether the proxy is the throughput llvm-mca predicts instead of weighted instruction counts
+    bool reeval_ucb;                        //Whether re-evaluations are scheduled by their intervals instead of by a 25% chance
+    double reeval_budget;                   //Fraction of the individuals of a batch timed before that may be timed again
+} EvalSettings;
+
+/*
+ * One individual of a batch, from its compile step to its timed runs
+ */
+typedef struct EvalJob {
+    node_str* indiv;            //Pass sequence that is evaluated
+    DataNode* indiv_data;       //Record the measurements are added to
+    int duplicate_of;           //Earlier job of the batch with the same DataNode, -1 if none
+    bool measure;               //Whether the individual is compiled and timed at all
+    bool compiled;              //Set once the output of the compile step is ready to be timed
+    IREntry* ir_entry;          //Measurements of the optimized module, NULL if it could not be hashed
+    bool reuse;                 //Whether the runs of ir_entry are taken instead of timing the individual
+    bool stored;                //Whether the runs are taken from the fitness store, the job is then neither compiled nor timed
+    int race;                   //Race the job is timed in against the other jobs of the race, -1 if it is timed on its own
+    eval_status status;         //Outcome of the compile step and the timed runs
+    char output_file[300];      //Optimized module, inside the scratch namespace of the worker that compiled it
+    char run_command[1000];     //Command that is timed
+    double* all_runtime;        //Runtime of every successful run, dimension: num_runs
+    uint32_t attempted_runs;    //Number of runs started, below the cap if timing stopped early
+    uint32_t success_runs;      //Number of successful runs
+    double avg_time;            //Average runtime, UINT32_MAX if too many runs failed
+    LaunchResult usage;         //Average CPU times and largest max RSS of the successful runs
+} EvalJob;
+
+/*
+ * Evaluation slots that take one individual at a time, for evolution without a
+ * generational barrier. Only the thread that opened the stream may use it
+ */
+typedef struct EvalStream EvalStream;
+
+extern EvalSettings eval_settings;
+
+bool evaluation_set_measure_cores(char* core_list);
+void evaluation_print_settings();
+uint32_t evaluation_max_runs(uint32_t num_runs);
+void evaluation_set_elite_threshold(double threshold);
+void evaluation_set_proxy_threshold(double threshold);
+void evaluation_set_baseline_time(double elapsed);
+void evaluation_add_baseline(const char* level, double fitness, double avg_time, char* run_command);
+bool evaluation_drift_baselines(double* track_fitness, int num_levels, double* ratio);
+void evaluation_build_baselines(char** opt_commands, char** bc_commands, int num_levels);
+void evaluation_restore_baseline(const char* level, char* run_command);
+void evaluation_save_state(FILE* f);
+void evaluation_load_state(FILE* f);
+void evaluation_check_counters();
+void evaluation_check_exec_mode(char* test_file, const char* cache_id);
+void evaluation_print_stats();
+void evaluation_free();
+void evaluation_batch(node_str** indivs, DataNode** indiv_data, uint32_t batch_size, double* fitness_values, bool vis, char* test_file, char** src_files, uint32_t num_src_files, bool cache, char* cache_file, const char *cache_id, uint32_t num_runs, int gen, bool fitness_with_var);
+void evaluation_race(node_str** indivs, DataNode** indiv_data, int* race, bool force, uint32_t batch_size, double* fitness_values, bool vis, char* test_file, char** src_files, uint32_t num_src_files, bool cache, char* cache_file, const char *cache_id, uint32_t num_runs, int gen, bool fitness_with_var);
+EvalStream* evaluation_stream_open(char* test_file, const char* cache_id, uint32_t num_runs);
+uint32_t evaluation_stream_slots(EvalStream* stream);
+bool evaluation_stream_busy(EvalStream* stream, DataNode* indiv_data);
+bool evaluation_stream_submit(EvalStream* stream, node_str* indiv, DataNode* indiv_data, int gen);
+DataNode* evaluation_stream_collect(EvalStream* stream, double* fitness, bool fitness_with_var);
+void evaluation_stream_close(EvalStream* stream);
+
+#endif /* EVOLUTION_EVALUATION_H_ */
@@ -33,6 +33,9 @@
  */
 
 #include "evolution.h"
+
+EvolutionSettings evolution_settings = {.steady_state = false};
+
 /*
  * ROUTINES
  */
@@ -122,7 +125,7 @@ void evolution_cache_generation_old(bool cache, char* main_folder, uint32_t gen,
     return;
 }
 
-void select_elites(int pop_size, int num_elites, double* fitness_values, int* current_gen_id, int* elite_indx, int* elite_id) {
+void select_elites(int pop_size, int num_elites, double* fitness_values, double* rank_values, int* current_gen_id, int* elite_indx, int* elite_id) {
     for (int i = 0; i < pop_size; i++) {
         printf("%s%d: %lf%s", i==0?"pop_fitness=[":"", current_gen_id[i], fitness_values[i], i==pop_size-1? "]\n":", ");
     }
@@ -136,7 +139,7 @@ void select_elites(int pop_size, int num_elites, double* fitness_values, int* cu
             continue; //to avoid populating elites with the same sequence (happens when sequence repeats in population)
         }
         for (int e = num_elites-1; e >= 0; e--) {
-            if (elite_indx[e] == -1 || fitness_values[k] < fitness_values[elite_indx[e]]) {
+            if (elite_indx[e] == -1 || rank_values[k] < rank_values[elite_indx[e]]) {
                 if (e != 0) {
                     elite_indx[e] = elite_indx[e - 1];
                     elite_id[e] = elite_indx[e]==-1? -1 : current_gen_id[elite_indx[e - 1]];
@@ -145,16 +148,35 @@ void select_elites(int pop_size, int num_elites, double* fitness_values, int* cu
                     elite_id[e] = current_gen_id[k];
                 }
             } else {
-                if (e < num_elites-1 && fitness_values[k] >= fitness_values[elite_indx[e]] && elite_indx[e] == elite_indx[e+1]) {
+                if (e < num_elites-1 && rank_values[k] >= rank_values[elite_indx[e]] && elite_indx[e] == elite_indx[e+1]) {
                     elite_indx[e + 1] = k;
                     elite_id[e + 1] = current_gen_id[k];
                 }
             }
         }
     }
+    // individuals whose runtime is clearly worse than the worst elite stop being timed early
+    evaluation_set_elite_threshold(num_elites > 0 && elite_indx[num_elites - 1] != -1 ? fitness_values[elite_indx[num_elites - 1]] : UINT32_MAX);
     //printf("Done selecting elites\n");
 }
 
+/*
+ * New individuals whose static proxy is clearly above the worst proxy of the elites
+ * are not timed. Elites without a proxy, such as ones taken from the fitness store, are left out
+ */
+void update_proxy_threshold(DataNode** all_indiv, int* elite_id, int num_elites) {
+    double threshold = -1;
+    if (!eval_settings.proxy_filter) {
+        return;
+    }
+    for (int e = 0; e < num_elites; e++) {
+        if (elite_id[e] != -1 && all_indiv[elite_id[e]]->proxy > threshold) {
+            threshold = all_indiv[elite_id[e]]->proxy;
+        }
+    }
+    evaluation_set_proxy_threshold(threshold);
+}
+
 /*
 Generate log file name for best individual and find best fitness;
 Log best_individual to its own file and summary file 
@@ -283,13 +305,11 @@ void print_random(int num_new_random, int num_elites, int* current_gen_id) {
     }
 }
 
-void create_elites(int num_elites, int* elite_indx, node_str** copy_gen, node_str** current_generation, int* copy_gen_id, int* current_gen_id, double* fitness_values) {
+void create_elites(int num_elites, int* elite_indx, DataNode** all_indiv, node_str** current_generation, int* copy_gen_id, int* current_gen_id, double* fitness_values) {
     for (uint32_t p = 0; p < num_elites; p++) {
         int elite_ind = elite_indx[p];
-        node_str* elite = osaka_copylist(copy_gen[elite_ind]);
-        // free individuals from current population to make room for elite individuals
-        generate_free_individual(current_generation[p]);
-        //printf("Freed individual #%d for elite #%d of %d\n", p, p+1, num_elites);
+        // the population refers to the sequences held by all_indiv, elites are not copied
+        node_str* elite = all_indiv[copy_gen_id[elite_ind]]->seq;
         current_generation[p] = elite;
         current_gen_id[p] = copy_gen_id[elite_ind];
     }
@@ -300,29 +320,60 @@ void create_randoms(int num_elites, int num_new_random, int* max_id_ptr, node_st
     //printf("\nbeginning of create_randoms, max_id=%d\n\n", *max_id);
     int new_allele_id;
     node_str* new_seq;
+    // with a surrogate model, the new individuals are the ones predicted fastest out of 1/keep as many candidates
+    uint32_t num_candidates = num_new_random;
+    bool predict = surrogate_ready() && ot == LLVM_PASS && num_new_random > 0;
+    if (predict) {
+        num_candidates = (uint32_t)ceil(num_new_random / surrogate_settings.keep);
+    }
+    node_str* candidates[num_candidates + 1];
+    double predicted[num_candidates + 1];
+    for (uint32_t c = 0; c < num_candidates; c++) {
+        candidates[c] = generate_new_individual(indiv_size,ot);
+        predicted[c] = 0.0;
+        if (predict) {
+            Genome* genome = genome_from_individual(candidates[c]);
+            predicted[c] = surrogate_predict(genome);
+            genome_free(genome);
+        }
+    }
     for (uint32_t p = num_elites; p < num_elites + num_new_random; p++) {
-        new_seq = generate_new_individual(indiv_size,ot);
-        new_allele_id = node_add(new_seq, max_id_ptr, hash_cap_ptr, all_indiv_ptr);
+        // the fastest candidate left, without predictions the candidates keep their order
+        uint32_t c = p - num_elites;
+        uint32_t best = c;
+        for (uint32_t k = c + 1; k < num_candidates; k++) {
+            best = predicted[k] < predicted[best] ? k : best;
+        }
+        double best_predicted = predicted[best];
+        new_seq = candidates[best];
+        candidates[best] = candidates[c];
+        predicted[best] = predicted[c];
+        // new_seq is handed over to all_indiv and replaced by the registered sequence
+        new_allele_id = node_adopt(&new_seq, max_id_ptr, hash_cap_ptr, all_indiv_ptr);
         //fitness_top(offsprings[i], vis, test_file, src_files, num_src_files, false, NULL, cache_id, (*all_indiv_ptr)[ofs_id[i]], num_runs, g, fitness_with_var);
         
-        // free individuals from current population to make room for elite individuals
-        generate_free_individual(current_generation[p]);
-        //printf("Freed individual #%d for new allele #%d of %d (id=%d)\n", p, p-num_elites+1, num_elites, new_allele_id);
         current_generation[p] = new_seq;
         current_gen_id[p] = new_allele_id;
+        if (predict && (*all_indiv_ptr)[new_allele_id]->num_eval == 0) {
+            surrogate_track((*all_indiv_ptr)[new_allele_id], best_predicted);
+        }
         //printf("new diversity allele created, unique ID: %d\n", new_allele_id);
     }
+    for (uint32_t c = num_new_random; c < num_candidates; c++) {
+        generate_free_individual(candidates[c]);
+    }
     //printf("Done filling up new individuals for the generation, max_id=%d\n", *max_id_ptr);
 }
 
-void select_parents(uint32_t* contestant1_ind, uint32_t* contestant2_ind, node_str** copy_gen, double* fitness_values, int copy_size, int tourn_size, bool vis) {
+void select_parents(uint32_t* contestant1_ind, uint32_t* contestant2_ind, node_str** population, double* fitness_values, int copy_size, int tourn_size, bool vis) {
     //printf("inside select parents\n");
-    uint32_t c1 = selection_tournament(copy_gen, fitness_values, NULL, copy_size, tourn_size, vis);
-    uint32_t c2 = selection_tournament(copy_gen, fitness_values, NULL, copy_size, tourn_size, vis);
+    // the tournament only compares fitness values, population is only read for its object type
+    uint32_t c1 = selection_tournament(population, fitness_values, NULL, copy_size, tourn_size, vis);
+    uint32_t c2 = selection_tournament(population, fitness_values, NULL, copy_size, tourn_size, vis);
     
     // contestants cannot be the same individual, the indices must be different
     while (c1 == c2) {
-        c2 = selection_tournament(copy_gen, fitness_values, NULL, copy_size, tourn_size, vis);
+        c2 = selection_tournament(population, fitness_values, NULL, copy_size, tourn_size, vis);
     }
 
     // swap if contestant1 comes before contestant2, swap so deletion order is correct
@@ -344,42 +395,118 @@ void select_parents(uint32_t* contestant1_ind, uint32_t* contestant2_ind, node_s
     //printf("Done selecting parents, contestant1_ind=%d, contestant2_ind=%d\n", c1, c2);
 }
 
-void generate_offspring(int parent1_ind, int parent2_ind, node_str** copy_gen, int* copy_gen_id, int num_offspring, node_str** offsprings, bool* ofs_change, int* ofs_id, uint32_t cross_perc, uint32_t mut_perc, bool vis, int* max_id_ptr, int* hash_cap_ptr, DataNode*** all_indiv_ptr) {
+/*
+ * Tournament in which the contestants whose interval overlaps the winner's are timed
+ * against the winner once more, the winner is then picked from their new fitness.
+ * Contestants already timed in generation g are not timed again
+ */
+uint32_t race_tournament(DataNode** all_indiv, int* copy_gen_id, double* rank_values, uint32_t copy_size, uint32_t tourn_size, \
+                        char* file, char** src_files, uint32_t num_src_files, const char* cache_id, \
+                        uint32_t num_runs, int g, bool vis, bool fitness_with_var) {
+    uint32_t contestants[tourn_size];
+    selection_tournament_contestants(contestants, copy_size, tourn_size);
+    uint32_t winner = contestants[0];
+    for (uint32_t c = 1; c < tourn_size; c++) {
+        winner = rank_values[contestants[c]] < rank_values[winner] ? contestants[c] : winner;
+    }
+
+    DataNode* best = all_indiv[copy_gen_id[winner]];
+    if (best->num_eval == 0 || best->fitness == UINT32_MAX || best->gens[node_last_row(best)] == g + 1) {
+        return winner;
+    }
+    node_str* racers[tourn_size];
+    DataNode* racer_data[tourn_size];
+    int race[tourn_size];
+    double racer_fitness[tourn_size];
+    uint32_t num_racers = 0;
+    for (uint32_t c = 0; c < tourn_size; c++) {
+        DataNode* d = all_indiv[copy_gen_id[contestants[c]]];
+        bool timed = d->num_eval == 0 || d->fitness == UINT32_MAX || d->gens[node_last_row(d)] == g + 1;
+        if (!timed && d->fitness_low <= best->fitness_high) {
+            racers[num_racers] = d->seq;
+            racer_data[num_racers] = d;
+            race[num_racers] = 0;
+            num_racers++;
+        }
+    }
+    if (num_racers < 2) {
+        return winner;
+    }
+
+    if (vis) {
+        printf("Racing %d contestants of the tournament that are too close to tell apart\n", num_racers);
+    }
+    evaluation_race(racers, racer_data, race, true, num_racers, racer_fitness, \
+                                vis, file, src_files, num_src_files, \
+                                false, NULL, cache_id, num_runs, g, fitness_with_var);
+    for (uint32_t c = 0; c < tourn_size; c++) {
+        rank_values[contestants[c]] = node_rank_value(all_indiv[copy_gen_id[contestants[c]]]);
+    }
+    winner = contestants[0];
+    for (uint32_t c = 1; c < tourn_size; c++) {
+        winner = rank_values[contestants[c]] < rank_values[winner] ? contestants[c] : winner;
+    }
+    return winner;
+}
+
+void select_raced_parents(uint32_t* contestant1_ind, uint32_t* contestant2_ind, DataNode** all_indiv, int* copy_gen_id, double* rank_values, \
+                        uint32_t copy_size, uint32_t tourn_size, char* file, char** src_files, uint32_t num_src_files, const char* cache_id, \
+                        uint32_t num_runs, int g, bool vis, bool fitness_with_var) {
+    uint32_t c1 = race_tournament(all_indiv, copy_gen_id, rank_values, copy_size, tourn_size, file, src_files, num_src_files, cache_id, num_runs, g, vis, fitness_with_var);
+    uint32_t c2 = race_tournament(all_indiv, copy_gen_id, rank_values, copy_size, tourn_size, file, src_files, num_src_files, cache_id, num_runs, g, vis, fitness_with_var);
+
+    // contestants cannot be the same individual, the indices must be different
+    while (c1 == c2) {
+        c2 = race_tournament(all_indiv, copy_gen_id, rank_values, copy_size, tourn_size, file, src_files, num_src_files, cache_id, num_runs, g, vis, fitness_with_var);
+    }
+    if (c1 < c2) {
+        uint32_t swap_ind = c1;
+        c1 = c2;
+        c2 = swap_ind;
+    }
+    *contestant1_ind = c1;
+    *contestant2_ind = c2;
+}
+
+void generate_offspring(int parent1_ind, int parent2_ind, Genome** copy_gen, int* copy_gen_id, int num_offspring, node_str** offsprings, bool* ofs_change, int* ofs_id, uint32_t cross_perc, uint32_t mut_perc, bool vis, int* max_id_ptr, int* hash_cap_ptr, DataNode*** all_indiv_ptr) {
+    // the operators work on flat copies of the parents, each offspring is only built as a list once they are done
+    Genome* genomes[num_offspring];
     for (int i = 0; i < num_offspring; i++) {
         ofs_change[i] = false;
         //printf("offspring #%d\n", i);
         if (i % 2 == 0) {
-            offsprings[i] = osaka_copylist(copy_gen[parent1_ind]);
+            genomes[i] = genome_copy(copy_gen[parent1_ind]);
             ofs_id[i] = copy_gen_id[parent1_ind];
             if (i == num_offspring - 1) {
-                node_str* temp = osaka_copylist(copy_gen[parent2_ind]);
+                Genome* temp = genome_copy(copy_gen[parent2_ind]);
                 bool temp_change;
-                genetic_operators(temp, offsprings[i], &temp_change, &ofs_change[i], cross_perc, mut_perc, vis);
-                if (ofs_change[i]) {
-                    ofs_id[i] = node_add(offsprings[i], max_id_ptr, hash_cap_ptr, all_indiv_ptr);
-                }
-                generate_free_individual(temp);
+                genetic_operators(&temp, &genomes[i], &temp_change, &ofs_change[i], cross_perc, mut_perc, vis);
+                genome_free(temp);
             }
         }
         else {
-            offsprings[i] = osaka_copylist(copy_gen[parent2_ind]);
+            genomes[i] = genome_copy(copy_gen[parent2_ind]);
             ofs_id[i] = copy_gen_id[parent2_ind];
             if (i != 1) {
-                genetic_operators(offsprings[i-1], offsprings[i], &ofs_change[i-1], &ofs_change[i], cross_perc, mut_perc, vis);
+                genetic_operators(&genomes[i-1], &genomes[i], &ofs_change[i-1], &ofs_change[i], cross_perc, mut_perc, vis);
                 //printf("ofs_change[%d]=%s, ofs_change[%d]=%s\n", i-1, ofs_change[i-1]?"true":"false", i, ofs_change[i]?"true":"false");
-                if (ofs_change[i-1]) {
-                    ofs_id[i-1] = node_add(offsprings[i-1], max_id_ptr, hash_cap_ptr, all_indiv_ptr);
-                }
-                if (ofs_change[i]) {
-                    ofs_id[i] = node_add(offsprings[i], max_id_ptr, hash_cap_ptr, all_indiv_ptr);
-                }
             }
         }
     }
+    // offspring left as they were are the parents' sequences, the others are handed over to all_indiv
+    for (int i = 0; i < num_offspring; i++) {
+        if (ofs_change[i]) {
+            offsprings[i] = genome_to_individual(genomes[i]);
+            ofs_id[i] = node_adopt(&offsprings[i], max_id_ptr, hash_cap_ptr, all_indiv_ptr);
+        } else {
+            offsprings[i] = (*all_indiv_ptr)[ofs_id[i]]->seq;
+        }
+        genome_free(genomes[i]);
+    }
     //printf("Done generating offspring\n");
 }
 
-void genetic_operators(node_str* contestant1, node_str* contestant2, bool* c1_change, bool* c2_change, uint32_t cross_perc, uint32_t mut_perc, bool vis) {
+void genetic_operators(Genome** contestant1, Genome** contestant2, bool* c1_change, bool* c2_change, uint32_t cross_perc, uint32_t mut_perc, bool vis) {
     bool c1 = false, c2 = false;
     uint32_t temp_crossover = (uint32_t) (100 * (rand() / (RAND_MAX + 1.0)));
     uint32_t temp_mutation1 = (uint32_t) (100 * (rand() / (RAND_MAX + 1.0)));
@@ -387,22 +514,22 @@ void genetic_operators(node_str* contestant1, node_str* contestant2, bool* c1_ch
     
     // random numbers are used to decide if the crossover or mutation operators will be used with a certain probability
     if (temp_crossover <= cross_perc) {
-        crossover_onepoint_macro(contestant1, contestant2, vis);
+        genome_crossover_onepoint(contestant1, contestant2, vis);
         c1 = true;
         c2 = true;
     }
     //printf("Done applying crossover\n");
     if (temp_mutation1 <= mut_perc) {
-        uint32_t indiv_size_1 = osaka_listlength(contestant1);
+        uint32_t indiv_size_1 = (*contestant1)->length;
         uint32_t random = (uint32_t) (indiv_size_1 * (rand() / (RAND_MAX + 1.0))) + 1;
-        mutation_single_unit_all_params(contestant1, random, vis);
+        genome_mutate(contestant1, random, vis);
         c1 = true;
     }
     //printf("Done applying mutation 1\n");
     if (temp_mutation2 <= mut_perc) {
-        uint32_t indiv_size_2 = osaka_listlength(contestant2);
+        uint32_t indiv_size_2 = (*contestant2)->length;
         uint32_t random = (uint32_t) (indiv_size_2 * (rand() / (RAND_MAX + 1.0))) + 1;
-        mutation_single_unit_all_params(contestant2, random, vis);
+        genome_mutate(contestant2, random, vis);
         c2 = true;
     }
     //printf("Done applying mutation 2\n");
@@ -411,15 +538,8 @@ void genetic_operators(node_str* contestant1, node_str* contestant2, bool* c1_ch
     //printf("Done applying genetic operators, c1_change=%s, c2_change=%s\n", c1?"true":"false", c2?"true":"false");
 }
 
-void select_offspring(node_str** best, int* best_id, node_str** offsprings, bool* ofs_change, int* ofs_id, int num_offspring, int parent1_ind, int parent2_ind, double* fitness_values, bool vis, char* test_file, char** src_files, uint32_t num_src_files, bool cache, char* cache_file, const char *cache_id, int g, DataNode*** all_indiv_ptr, uint32_t num_runs, bool fitness_with_var) {
-    //printf("\nInside select_offspring, calculating offspring fitness, num_offspring=%d:\n", num_offspring);
-
-    double ofs_fitness[num_offspring];
-    for (int i = 0; i < num_offspring; i++) {
-        ofs_fitness[i] = fitness_top(offsprings[i], vis, test_file, src_files, num_src_files, false, NULL, cache_id, (*all_indiv_ptr)[ofs_id[i]], num_runs, g, fitness_with_var);
-        //printf("offspring #%d: fitness=%lf\n", i, ofs_fitness[i]);
-    }
-    //printf("Done calculating offspring fitness:\n");
+void select_offspring(node_str** best, int* best_id, node_str** offsprings, bool* ofs_change, int* ofs_id, double* ofs_fitness, int num_offspring, bool vis) {
+    //printf("\nInside select_offspring, num_offspring=%d:\n", num_offspring);
 
     double min1_fit = ofs_fitness[0];
     int min1_ind = 0;
@@ -440,8 +560,9 @@ void select_offspring(node_str** best, int* best_id, node_str** offsprings, bool
     printf("indiv 1: ofs_ind=%d, fitness=%lf, change=%s\n", min1_ind, min1_fit, ofs_change[min1_ind]?"true":"false");
     printf("indiv 2: ofs_ind=%d, fitness=%lf, change=%s\n", min2_ind, min2_fit, ofs_change[min2_ind]?"true":"false");
     */
-    best[0] = osaka_copylist(offsprings[min1_ind]);
-    best[1] = osaka_copylist(offsprings[min2_ind]);
+    // the offspring are sequences held by all_indiv, the best are neither copied nor freed
+    best[0] = offsprings[min1_ind];
+    best[1] = offsprings[min2_ind];
     best_id[0] = ofs_id[min1_ind];
     best_id[1] = ofs_id[min2_ind];
     /*printf("ofs_id: [");
@@ -449,8 +570,6 @@ void select_offspring(node_str** best, int* best_id, node_str** offsprings, bool
         printf("%d%s", ofs_id[i], i==num_offspring-1? "]\n":", ");
     }
     printf("best_id[0]=%d, best_id[1]=%d\n", best_id[0], best_id[1]);*/
-    
-    generate_free_generation(offsprings, num_offspring);
 
     /*printf("\nbest[0]: ");
     visualization_print_individual_concise_details(best[0]);
@@ -462,21 +581,16 @@ void select_offspring(node_str** best, int* best_id, node_str** offsprings, bool
 }
 
 void update_generation(node_str* contestant1, node_str* contestant2, int c1_id, int c2_id, node_str** current_generation, int* current_gen_id, int pop_size, int num_elites, int num_new_random, int p) {
-    generate_free_individual(current_generation[num_elites + num_new_random + p]);
-    //printf("Freed individual #%d for contestant 1\n", num_elites + num_new_random + p);
     current_generation[num_elites + num_new_random + p] = contestant1;
     current_gen_id[num_elites + num_new_random + p] = c1_id;
 
-    //free//
-    generate_free_individual(current_generation[num_elites + num_new_random + p + ((pop_size-num_elites-num_new_random) / 2)]);
-    //printf("Freed individual #%d for contestant 2\n\n", num_elites + num_new_random + p + ((pop_size-num_elites-num_new_random) / 2));
     current_generation[num_elites + num_new_random + p + ((pop_size-num_elites-num_new_random) / 2)] = contestant2;
     current_gen_id[num_elites + num_new_random + p + ((pop_size-num_elites-num_new_random) / 2)] = c2_id;
     
     //printf("Done updating generation\n");
 }
 
-void create_mutants(node_str** copy_gen, node_str** current_generation, double* fitness_values,\
+void create_mutants(Genome** copy_gen, node_str** current_generation, double* fitness_values,\
                         int* copy_gen_id, int* current_gen_id, int* max_id_ptr, \
                         uint32_t tourn_size, uint32_t pop_size, uint32_t cross_perc, uint32_t mut_perc, \
                         uint32_t num_elites, uint32_t num_new_random, uint32_t copy_size, \
@@ -485,38 +599,104 @@ void create_mutants(node_str** copy_gen, node_str** current_generation, double*
                         bool vis, int g, \
                         bool cache, char* cache_file, const char* cache_id, \
                         DataNode*** all_indiv_ptr, int* hash_cap_ptr, bool fitness_with_var) {
+    uint32_t num_matings = (pop_size - num_elites - num_new_random) / 2;
+    if (num_matings == 0) {
+        return;
+    }
     uint32_t contestant1_ind = 0;
     uint32_t contestant2_ind = 0;
-    node_str* offsprings[num_offspring];
-    bool ofs_change[num_offspring];
-    double ofs_fitness[num_offspring];
-    int ofs_id[num_offspring];
+    double rank_values[copy_size];
+    node_str* offsprings[num_matings * num_offspring];
+    bool ofs_change[num_matings * num_offspring];
+    double ofs_fitness[num_matings * num_offspring];
+    int ofs_id[num_matings * num_offspring];
+    DataNode* ofs_data[num_matings * num_offspring];
     node_str* ofs_best[2];
     int best_id[2];
 
-    for (uint32_t itr = 0; itr < ((pop_size - num_elites - num_new_random) / 2); itr++) {
+    // parents are compared like elites, by their intervals if intervals are compared
+    node_rank_values(*all_indiv_ptr, copy_gen_id, copy_size, rank_values);
+    // breed every mating of the generation first, so all offspring can be evaluated as one batch
+    for (uint32_t itr = 0; itr < num_matings; itr++) {
         //printf("About to fill in position %d and %d\n", num_elites + num_new_random + itr, num_elites + num_new_random + itr + ((pop_size-num_elites-num_new_random) / 2));
         vis_itr(vis, itr, g);
         //printf("before select_parents\n");
-        select_parents(&contestant1_ind, &contestant2_ind, \
-                                copy_gen, fitness_values, \
+        if (eval_settings.race_tournaments && OBJECT_TYPE(current_generation[0]) == LLVM_PASS) {
+            select_raced_parents(&contestant1_ind, &contestant2_ind, \
+                                *all_indiv_ptr, copy_gen_id, rank_values, \
+                                copy_size, tourn_size, file, src_files, num_src_files, cache_id, \
+                                num_runs, g, vis, fitness_with_var);
+        } else {
+            select_parents(&contestant1_ind, &contestant2_ind, \
+                                current_generation, rank_values, \
                                 copy_size, tourn_size, vis);
+        }
         //printf("after select_parents\n");
         //printf("before generate_offspring\n");
         generate_offspring(contestant1_ind, contestant2_ind, \
                                 copy_gen, copy_gen_id, \
-                                num_offspring, offsprings, ofs_change, ofs_id, \
+                                num_offspring, &offsprings[itr * num_offspring], &ofs_change[itr * num_offspring], &ofs_id[itr * num_offspring], \
                                 cross_perc, mut_perc, vis, 
                                 max_id_ptr, hash_cap_ptr, all_indiv_ptr);
         //printf("after generate_offspring\n");
-        vis_print_parents(vis, offsprings);
-        //printf("before select_offspring\n");
-        select_offspring(ofs_best, best_id, offsprings, ofs_change, ofs_id, num_offspring, \
-                                contestant1_ind, contestant2_ind, \
-                                fitness_values, \
+        vis_print_parents(vis, &offsprings[itr * num_offspring]);
+    }
+
+    // node_add may grow all_indiv, only look up the records once every offspring is added
+    for (uint32_t i = 0; i < num_matings * num_offspring; i++) {
+        ofs_data[i] = (*all_indiv_ptr)[ofs_id[i]];
+    }
+    // new offspring the surrogate model predicts to be slow are left out of the batch
+    bool timed[num_matings * num_offspring];
+    node_str* timed_ofs[num_matings * num_offspring];
+    DataNode* timed_data[num_matings * num_offspring];
+    double timed_fitness[num_matings * num_offspring];
+    int ofs_race[num_matings * num_offspring];
+    int race[num_matings * num_offspring];
+    uint32_t num_timed = 0;
+    for (uint32_t i = 0; i < num_matings * num_offspring; i++) {
+        // the even offspring of a mating race each other for the first place, the odd ones for the second
+        ofs_race[i] = (i / num_offspring) * 2 + (i % num_offspring) % 2;
+    }
+    uint32_t num_skipped = surrogate_select(ofs_data, ofs_race, num_matings * num_offspring, timed);
+    for (uint32_t i = 0; i < num_matings * num_offspring; i++) {
+        if (timed[i]) {
+            race[num_timed] = ofs_race[i];
+            timed_ofs[num_timed] = offsprings[i];
+            timed_data[num_timed] = ofs_data[i];
+            num_timed++;
+        }
+    }
+    if (vis && num_skipped > 0) {
+        printf("Surrogate model leaves %d new offspring untimed\n", num_skipped);
+    }
+    if (eval_settings.racing) {
+        evaluation_race(timed_ofs, timed_data, race, false, num_timed, timed_fitness, \
+                                vis, file, src_files, num_src_files, \
+                                false, NULL, cache_id, num_runs, g, fitness_with_var);
+    } else {
+        evaluation_batch(timed_ofs, timed_data, num_timed, timed_fitness, \
                                 vis, file, src_files, num_src_files, \
-                                cache, cache_file, cache_id, g, \
-                                all_indiv_ptr, num_runs, fitness_with_var);
+                                false, NULL, cache_id, num_runs, g, fitness_with_var);
+    }
+    // untimed offspring are recorded like ones the proxy filtered, without runs
+    for (uint32_t i = 0; i < num_matings * num_offspring; i++) {
+        if (!timed[i] && ofs_data[i]->num_eval == 0) {
+            double no_runs[1] = {0.0};
+            node_record_data(ofs_data[i], offsprings[i], no_runs, UINT32_MAX, 0, g, fitness_with_var);
+            node_record_status(ofs_data[i], EVAL_FILTERED);
+        }
+    }
+    // offspring are compared by the same value as their parents
+    for (uint32_t i = 0; i < num_matings * num_offspring; i++) {
+        ofs_fitness[i] = node_rank_value(ofs_data[i]);
+    }
+
+    for (uint32_t itr = 0; itr < num_matings; itr++) {
+        //printf("before select_offspring\n");
+        select_offspring(ofs_best, best_id, &offsprings[itr * num_offspring], &ofs_change[itr * num_offspring], \
+                                &ofs_id[itr * num_offspring], &ofs_fitness[itr * num_offspring], \
+                                num_offspring, vis);
         //printf("after select_offspring\n");
         //printf("before update_generation\n");
         update_generation(ofs_best[0], ofs_best[1], \
@@ -528,17 +708,140 @@ void create_mutants(node_str** copy_gen, node_str** current_generation, double*
     //printf("Done creating mutants\n");
 }
 
+/*
+ * Breeds an offspring of two tournament winners that was never evaluated and is not
+ * being timed, and hands it to a free slot of the stream. Breeding that keeps giving
+ * known sequences falls back to random individuals
+ */
+bool steady_submit_offspring(EvalStream* stream, EvolutionState* state, double* rank_values, uint32_t indiv_size, uint32_t tourn_size, uint32_t cross_perc, uint32_t mut_perc, bool vis, int g) {
+    for (int attempt = 0; attempt < 2 * STEADY_BREED_ATTEMPTS; attempt++) {
+        node_str* child = NULL;
+        if (attempt < STEADY_BREED_ATTEMPTS) {
+            uint32_t c1, c2;
+            bool change1, change2;
+            select_parents(&c1, &c2, state->current_generation, rank_values, state->pop_size, tourn_size, vis);
+            Genome* genome1 = genome_copy((*state->all_indiv)[state->current_gen_id[c1]]->genome);
+            Genome* genome2 = genome_copy((*state->all_indiv)[state->current_gen_id[c2]]->genome);
+            genetic_operators(&genome1, &genome2, &change1, &change2, cross_perc, mut_perc, vis);
+            if (change1 || change2) {
+                child = genome_to_individual(change1 ? genome1 : genome2);
+            }
+            genome_free(genome1);
+            genome_free(genome2);
+        } else {
+            child = generate_new_individual(indiv_size, state->ot);
+        }
+        if (child == NULL) {
+            continue;
+        }
+        // child is handed over to all_indiv and replaced by the registered sequence
+        int id = node_adopt(&child, state->max_id, state->hash_cap, state->all_indiv);
+        DataNode* d = (*state->all_indiv)[id];
+        if (d->num_eval == 0 && !evaluation_stream_busy(stream, d)) {
+            return evaluation_stream_submit(stream, d->seq, d, g);
+        }
+    }
+    return false;
+}
+
+// a finished offspring takes the place of the worst individual of the population if it ranks better
+bool steady_replace_worst(DataNode* d, EvolutionState* state, double* rank_values) {
+    uint32_t worst = 0;
+    double rank = node_rank_value(d);
+    for (uint32_t k = 1; k < state->pop_size; k++) {
+        worst = rank_values[k] > rank_values[worst] ? k : worst;
+    }
+    if (rank >= rank_values[worst] || is_in_list(d->seq_id, state->current_gen_id, state->pop_size)) {
+        return false;
+    }
+    state->current_generation[worst] = d->seq;
+    state->current_gen_id[worst] = d->seq_id;
+    state->fitness_values[worst] = d->fitness;
+    rank_values[worst] = rank;
+    return true;
+}
+
+/*
+ * Steady-state evolution without a generational barrier: every slot of the evaluation
+ * stream times one offspring, and as soon as one finishes it may replace the worst
+ * individual and a new offspring is bred into the free slot. Every pop_size finished
+ * offspring count as a generation for the elites, logs and checkpoints. Unlike the
+ * generational loop it does not time the baselines again every fifth generation.
+ * Returns the number of generations done
+ */
+uint32_t evolution_steady_state(EvolutionState* state, uint32_t first_gen, uint32_t indiv_size, uint32_t tourn_size, uint32_t mut_perc, uint32_t cross_perc, \
+                                bool vis, char* file, const char* cache_id, bool cache, char* main_folder, int offset, uint32_t num_runs, bool fitness_with_var) {
+    uint32_t pop_size = state->pop_size;
+    double rank_values[pop_size];
+    uint64_t budget = (uint64_t)(state->num_gens - first_gen) * pop_size;
+    uint64_t submitted = 0;
+    uint32_t finished = 0;
+    uint32_t replaced = 0;
+    uint32_t g = first_gen;
+    double fitness;
+    DataNode* d;
+
+    if (g >= state->num_gens) {
+        return g;
+    }
+    EvalStream* stream = evaluation_stream_open(file, cache_id, num_runs);
+    node_rank_values(*state->all_indiv, state->current_gen_id, pop_size, rank_values);
+    printf("----------------------------------- Generation %d -----------------------------------\n\n", g + 1);
+    for (uint32_t s = 0; s < evaluation_stream_slots(stream) && submitted < budget; s++) {
+        if (!steady_submit_offspring(stream, state, rank_values, indiv_size, tourn_size, cross_perc, mut_perc, vis, g)) {
+            break;
+        }
+        submitted++;
+    }
+    while ((d = evaluation_stream_collect(stream, &fitness, fitness_with_var)) != NULL) {
+        replaced += steady_replace_worst(d, state, rank_values);
+        finished++;
+        if (finished == pop_size) {
+            printf("Steady state: %d of %d offspring replaced the worst individual\n", replaced, finished);
+            for (uint32_t k = 0; k < pop_size; k++) {
+                node_increment_gen((*state->all_indiv)[state->current_gen_id[k]]);
+            }
+            select_elites(pop_size, state->num_elites, state->fitness_values, rank_values, state->current_gen_id, state->elite_indx, state->elite_id);
+            update_proxy_threshold(*state->all_indiv, state->elite_id, state->num_elites);
+            evolution_cache_gen(cache, main_folder, \
+                            state->current_generation, state->fitness_values, state->current_gen_id, \
+                            state->track_fitness, \
+                            pop_size, state->num_gens, g, offset, state->ot);
+            vis_print_gen(vis, true, state->current_generation, g, pop_size);
+            printf("-------------------------------- End of Generation %d --------------------------------\n\n", g + 1);
+            // the offspring still in the slots are not part of the checkpoint, a resumed run breeds new ones
+            if (cache && checkpoint_due(g)) {
+                state->next_gen = g + 1;
+                checkpoint_save(main_folder, state);
+            }
+            g++;
+            finished = 0;
+            replaced = 0;
+            if (g < state->num_gens) {
+                printf("----------------------------------- Generation %d -----------------------------------\n\n", g + 1);
+            }
+        }
+        if (submitted < budget && steady_submit_offspring(stream, state, rank_values, indiv_size, tourn_size, cross_perc, mut_perc, vis, g)) {
+            submitted++;
+        }
+    }
+    evaluation_stream_close(stream);
+    return g;
+}
+
 void log_all_indiv_info(bool cache, DataNode** all_indiv, char* main_folder, int num_runs, int max_id) {
     if (cache) {
         char indiv_info_file[300];
         strcpy(indiv_info_file, main_folder);
         strcat(indiv_info_file, "/indiv_info.csv");
         FILE* indiv_info_file_ptr = fopen(indiv_info_file, "a+");;
-        fprintf(indiv_info_file_ptr, "ID,num_eval,tot_gen,gen_#,avg_time,var,success_runs,");
-		for (int k = 0; k < num_runs-1; k++) {
+        fprintf(indiv_info_file_ptr, "ID,num_eval,tot_gen,gen_#,status,avg_time,var,utime,stime,maxrss_kb,instructions,cycles,branch_misses,cache_misses,success_runs,");
+        // an evaluation can time more runs than num_runs with -max_runs or racing
+        int max_runs = evaluation_max_runs(num_runs);
+		for (int k = 0; k < max_runs-1; k++) {
             fprintf(indiv_info_file_ptr, "run_%d,", k+1);
         }
-        fprintf(indiv_info_file_ptr, "run_%d\n", num_runs);
+        fprintf(indiv_info_file_ptr, "run_%d\n", max_runs);
         fclose(indiv_info_file_ptr);
         char indiv_info_dir[300];
         strcpy(indiv_info_dir, "");
@@ -618,11 +921,16 @@ int evolution_clean_up(int num_elites, node_str** current_generation, uint32_t p
     }
     
 
+    evaluation_print_stats();
+    samples_print_stats();
+
     // free allocated space
     free_all_nodes(all_indiv, max_id);
     free(all_indiv);
-    generate_free_generation(current_generation, pop_size);
+    samples_close();
     llvm_clean_up(file, cache_id, cache);
+    evaluation_free();
+    surrogate_free();
     generate_free_individual(final_node);
     return g;
 }
@@ -686,8 +994,9 @@ int evolution_basic_crossover_and_mutation_with_replacement(uint32_t num_gens, u
     const int stale_limit = 10;
 
     double fitness_values[pop_size];
+    double rank_values[pop_size];       //What elites are selected by, see node_rank_value
     node_str* current_generation[pop_size];
-    node_str* copy_gen[pop_size];
+    Genome* copy_gen[pop_size];
     int current_gen_id[pop_size];
     int copy_gen_id[pop_size];
     int max_id = 0;
@@ -698,10 +1007,10 @@ int evolution_basic_crossover_and_mutation_with_replacement(uint32_t num_gens, u
     // variables used for caching
     int hash_cap = pop_size * 5;
     DataNode** all_indiv = calloc(hash_cap, sizeof(DataNode*));
-    DataNode* indiv_data = NULL;
+    DataNode* gen_data[pop_size];
     
     char main_folder[200];
-    char cache_file[300];
+    char cache_file[300] = "";
 
     // variables used for selecting offspring
     int num_offspring = 6;  // HAS TO BE GREATER THAN 2: 2 offsprings will be identical to parents, and num_offspring-2 new individuals
@@ -709,53 +1018,96 @@ int evolution_basic_crossover_and_mutation_with_replacement(uint32_t num_gens, u
     bool fitness_with_var = false;
     bool gi = true;  // if true, half of the population will be some variation of the default levels, only works when indiv_size is random
 
-    cache_create_new_run_folder(cache, main_folder, cache_id);
-    cache_params(cache, main_folder, num_gens, pop_size, cross_perc, mut_perc, elite_perc, tourn_size);
-    fitness_pre_cache(main_folder, file, src_files, num_src_files, ot, cache, track_fitness, cache_id, num_runs, fitness_with_var, levels, num_levels);
+    // everything a checkpoint needs to continue the run after a finished generation
+    EvolutionState state = {0, pop_size, num_gens, ot, num_elites, num_levels,
+                            current_generation, current_gen_id, fitness_values, elite_indx, elite_id,
+                            &all_indiv, &max_id, &hash_cap, track_fitness, &lowest, &stale_counter};
+    uint32_t first_gen = 0;
+
+    if (evolution_settings.steady_state && (ot != LLVM_PASS || pop_size < 2)) {
+        printf("-steady_state needs LLVM_PASS individuals and a population of at least 2.\n\nAborting code\n\n");
+        exit(0);
+    }
+    if (checkpoint_resuming()) {
+        if (!cache || ot != LLVM_PASS) {
+            printf("-resume needs -cache and LLVM_PASS individuals.\n\nAborting code\n\n");
+            exit(0);
+        }
+        strcpy(main_folder, checkpoint_settings.resume_folder);
+        // the runtimes stay in samples.bin, checkpoint_load continues it
+        checkpoint_load(main_folder, &state);
+        fitness_rebuild_llvm_pass(file, src_files, num_src_files, cache_id, levels, num_levels);
+        first_gen = state.next_gen;
+    } else {
+        checkpoint_init_random();
+        cache_create_new_run_folder(cache, main_folder, cache_id);
+        if (cache) {
+            samples_open(main_folder);
+        }
+        cache_params(cache, main_folder, num_gens, pop_size, cross_perc, mut_perc, elite_perc, tourn_size);
+        fitness_pre_cache(main_folder, file, src_files, num_src_files, ot, cache, track_fitness, cache_id, num_runs, fitness_with_var, levels, num_levels);
 
-    // create the initial population
+        // create the initial population
     
-    generate_new_generation(current_generation, pop_size, indiv_size, ot, gi, levels, num_levels);
-    node_add_group(current_generation, current_gen_id, pop_size, &max_id, &hash_cap, &all_indiv);
-    for (int i = 0; i < pop_size; i++) {
-        printf("%s%d%s", i==0? "current_gen_id=[":"", current_gen_id[i], i==pop_size-1?"]\n":", ");
-    }
-    // calculate initial fitness values for the current generation
-    //cache_create_new_gen_folder(cache, main_folder, -1);
-    cache_create_best_indiv_folder(cache, main_folder);
-    printf("\n----------------------------------- Initial Population -----------------------------------\n");
-    int generation_num = -1;
-    for (uint32_t k = 0; k < pop_size; k++) {
-        //printf("-----------------------------------------------------------------------------\n");
-        //printf("Calculate initial fitness - individual #%d out of %d, ID=%d (max_id=%d)\n", k+1, pop_size, current_gen_id[k], max_id);
-        //printf("-----------------------------------------------------------------------------\n");
-        cache_file_name(cache, main_folder, cache_file, -1, k);
-        //indiv_data = all_indiv[k];  // Added7/7/2021
-        indiv_data = all_indiv[current_gen_id[k]];
-        fitness_values[k] = fitness_top(current_generation[k], vis, file, src_files, num_src_files, cache, cache_file, cache_id, indiv_data, num_runs, generation_num, fitness_with_var); // Added 6/24/2021
-        node_increment_gen(indiv_data);
-        //=%lf\n", fitness_values[k]);
-    }
-    // if cache, record generation information
-    //evolution_cache_generation(cache, main_folder, -1, pop_size, current_generation, vis, file, src_files, num_src_files, fitness_values, ot, track_fitness);
-    // update elite list as the best N individuals in the generation
-    select_elites(pop_size, num_elites, fitness_values, current_gen_id, elite_indx, elite_id);
-    // print out and export the ID and fitness information
-    evolution_cache_gen(cache, main_folder, current_generation, fitness_values, current_gen_id, track_fitness, pop_size, num_gens, generation_num, offset, ot);
-    vis_print_gen(vis, false, current_generation, -1, pop_size);
+        generate_new_generation(current_generation, pop_size, indiv_size, ot, gi, levels, num_levels);
+        node_add_group(current_generation, current_gen_id, pop_size, &max_id, &hash_cap, &all_indiv);
+        for (int i = 0; i < pop_size; i++) {
+            printf("%s%d%s", i==0? "current_gen_id=[":"", current_gen_id[i], i==pop_size-1?"]\n":", ");
+        }
+        // calculate initial fitness values for the current generation
+        //cache_create_new_gen_folder(cache, main_folder, -1);
+        cache_create_best_indiv_folder(cache, main_folder);
+        printf("\n----------------------------------- Initial Population -----------------------------------\n");
+        int generation_num = -1;
+        for (uint32_t k = 0; k < pop_size; k++) {
+            //printf("Calculate initial fitness - individual #%d out of %d, ID=%d (max_id=%d)\n", k+1, pop_size, current_gen_id[k], max_id);
+            //indiv_data = all_indiv[k];  // Added7/7/2021
+            gen_data[k] = all_indiv[current_gen_id[k]];
+        }
+        // the whole population is evaluated as one batch by the evaluation workers
+        evaluation_batch(current_generation, gen_data, pop_size, fitness_values, vis, file, src_files, num_src_files, cache, cache_file, cache_id, num_runs, generation_num, fitness_with_var);
+        for (uint32_t k = 0; k < pop_size; k++) {
+            node_increment_gen(gen_data[k]);
+        }
+        // if cache, record generation information
+        //evolution_cache_generation(cache, main_folder, -1, pop_size, current_generation, vis, file, src_files, num_src_files, fitness_values, ot, track_fitness);
+        // update elite list as the best N individuals in the generation
+        node_rank_values(all_indiv, current_gen_id, pop_size, rank_values);
+        select_elites(pop_size, num_elites, fitness_values, rank_values, current_gen_id, elite_indx, elite_id);
+        update_proxy_threshold(all_indiv, elite_id, num_elites);
+        // print out and export the ID and fitness information
+        evolution_cache_gen(cache, main_folder, current_generation, fitness_values, current_gen_id, track_fitness, pop_size, num_gens, generation_num, offset, ot);
+        vis_print_gen(vis, false, current_generation, -1, pop_size);
+        if (cache && checkpoint_settings.every > 0) {
+            checkpoint_save(main_folder, &state);
+        }
+    }
 
-    for (uint32_t g = 0; g < num_gens; g++) {
+    // the surrogate model starts from every evaluation so far, a resumed run relearns them
+    surrogate_learn(all_indiv, max_id);
+    if (evolution_settings.steady_state) {
+        uint32_t g = evolution_steady_state(&state, first_gen, indiv_size, tourn_size, mut_perc, cross_perc, \
+                                vis, file, cache_id, cache, main_folder, offset, num_runs, fitness_with_var);
+        return evolution_clean_up(num_elites, current_generation, pop_size, \
+                                vis, main_folder, file, cache_id, cache, \
+                                all_indiv, num_runs, max_id, g, \
+                                ot, fitness_values, current_gen_id);
+    }
+    for (uint32_t g = first_gen; g < num_gens; g++) {
         printf("----------------------------------- Generation %d -----------------------------------\n\n", g + 1);
         //printf("start of generation, cache_id: %s\n", cache_id);
         //cache_create_new_gen_folder(cache, main_folder, g);
         // at the start of every generation, copy over the last generation
-        generate_copy_generation(current_generation, copy_gen, pop_size);
+        // the copy shares the genomes of all_indiv instead of copying the sequences
+        for (uint32_t k = 0; k < pop_size; k++) {
+            copy_gen[k] = genome_copy(all_indiv[current_gen_id[k]]->genome);
+        }
         generate_copy_gen_id(current_gen_id, copy_gen_id, pop_size);
         
         // evolution and selection
         //printf("before create_elites\n");
         create_elites(num_elites, elite_indx, \
-                        copy_gen, current_generation, \
+                        all_indiv, current_generation, \
                         copy_gen_id, current_gen_id, \
                         fitness_values);
         print_elites(num_elites, elite_indx, fitness_values, elite_id, current_generation);
@@ -789,20 +1141,22 @@ int evolution_basic_crossover_and_mutation_with_replacement(uint32_t num_gens, u
         for (int i = 0; i < pop_size; i++) {
             printf("%d%s", current_gen_id[i], i==pop_size-1? "]\n":",");
         }
-        generate_free_generation(copy_gen, pop_size);
+        genome_free_generation(copy_gen, pop_size);
 
         // refresh fitness values for the current_generation
         for (uint32_t k = 0; k < pop_size; k++) {
-            //printf("-------------------------------------------------------------------------------\n");
             //printf("Refresh fitness for individual %d of %d in generation %d of %d, ID=%d (max_id=%d)\n", k+1, pop_size, g+1, num_gens, current_gen_id[k], max_id);
-            //printf("-------------------------------------------------------------------------------\n");
-            cache_file_name(cache, main_folder, cache_file, g, k);
-            indiv_data = all_indiv[current_gen_id[k]];
-            fitness_values[k] = fitness_top(current_generation[k], vis, file, src_files, num_src_files, cache, cache_file, cache_id, indiv_data, num_runs, g, fitness_with_var); // Added 6/18/2021
-            node_increment_gen(indiv_data);
-            //printf("Fitness=%lf\n", fitness_values[k]);
-        }
-        select_elites(pop_size, num_elites, fitness_values, current_gen_id, elite_indx, elite_id);
+            gen_data[k] = all_indiv[current_gen_id[k]];
+        }
+        evaluation_batch(current_generation, gen_data, pop_size, fitness_values, vis, file, src_files, num_src_files, cache, cache_file, cache_id, num_runs, g, fitness_with_var);
+        for (uint32_t k = 0; k < pop_size; k++) {
+            node_increment_gen(gen_data[k]);
+        }
+        node_rank_values(all_indiv, current_gen_id, pop_size, rank_values);
+        select_elites(pop_size, num_elites, fitness_values, rank_values, current_gen_id, elite_indx, elite_id);
+        update_proxy_threshold(all_indiv, elite_id, num_elites);
+        surrogate_report(g);
+        surrogate_learn(all_indiv, max_id);
         // print out and export the ID and fitness information
         
         evolution_cache_gen(cache, main_folder, \
@@ -813,6 +1167,10 @@ int evolution_basic_crossover_and_mutation_with_replacement(uint32_t num_gens, u
         vis_print_gen(vis, true, current_generation, g, pop_size);
         printf("-------------------------------- End of Generation %d --------------------------------\n\n", g + 1);
         log_redo_basic(main_folder, file, cache, cache_id, track_fitness[g + offset], num_runs, fitness_with_var, g, levels, num_levels);
+        if (cache && checkpoint_due(g)) {
+            state.next_gen = g + 1;
+            checkpoint_save(main_folder, &state);
+        }
         //bool terminate = check_termination(track_fitness[g + offset], &lowest, &stale_counter, stale_limit);
         bool terminate = false;
         if (terminate) {
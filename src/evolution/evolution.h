@@ -40,11 +40,28 @@
  */
 
 #include <unistd.h> //Added 6/8/2021, for checking whether file exists
+#include <math.h>
 #include "mutation.h"
 #include "crossover.h"
 #include "generation.h"
 #include "selection.h"
 #include "indivdata.h"
+#include "evaluation.h"
+#include "checkpoint.h"
+#include "genome.h"
+#include "samples.h"
+#include "surrogate.h"
+
+#define STEADY_BREED_ATTEMPTS 20    //Offspring bred before a random individual is tried instead, if all of them are known
+
+/*
+ * How the evolution proceeds, filled in from the command line in main.c
+ */
+typedef struct EvolutionSettings {
+    bool steady_state;      //Whether every finished offspring replaces the worst individual at once, instead of generation by generation
+} EvolutionSettings;
+
+extern EvolutionSettings evolution_settings;
 
 /*
  * ROUTINES
@@ -221,7 +238,7 @@ void evolution_cache_generation_old(bool cache, char* main_folder, uint32_t gen,
 node_str* evolution_basic_crossover_and_mutation(uint32_t num_gens, uint32_t pop_size, uint32_t indiv_size, uint32_t tourn_size, uint32_t mut_perc, uint32_t cross_perc, osaka_object_typ ot, bool vis, char* file);
 
 
-void select_elites(int pop_size, int num_elites, double* fitness_values, int* current_gen_id, int* elite_indx, int* elite_id);
+void select_elites(int pop_size, int num_elites, double* fitness_values, double* rank_values, int* current_gen_id, int* elite_indx, int* elite_id);
 void evolution_cache_gen(bool cache, char* main_folder, \
             node_str** current_generation, double* fitness_values, int* current_gen_id, \
             double* track_fitness, \
@@ -233,14 +250,17 @@ void evolution_log_to_summary(bool cache, char* main_folder, \
             int pop_size, int num_gens, int g, int offset);
 void print_elites(int num_elites, int* elite_indx, double* fitness_values, int* elite_id, node_str** current_gen);
 void print_random(int num_new_random, int num_elites, int* current_gen_id);
-void create_elites(int num_elites, int* elite_ids, node_str** copy_gen, node_str** current_generation, int* copy_gen_id, int* current_gen_id, double* fitness_values);
+void create_elites(int num_elites, int* elite_ids, DataNode** all_indiv, node_str** current_generation, int* copy_gen_id, int* current_gen_id, double* fitness_values);
 void create_randoms(int num_elites, int num_new_random, int* max_id, node_str** current_generation, int* current_gen_id, int indiv_size, osaka_object_typ ot, DataNode*** all_indiv_ptr, int* hash_cap);
-void select_parents(uint32_t* c_ind1, uint32_t* c_ind2, node_str** copy_gen, double* fitness_values, int copy_size, int tourn_size, bool vis);
-void generate_offspring(int parent1_ind, int parent2_ind, node_str** copy_gen, int* copy_gen_id, int num_offspring, node_str** offsprings, bool* ofs_change, int* ofs_id, uint32_t cross_perc, uint32_t mut_perc, bool vis, int* max_id_ptr, int* hash_cap_ptr, DataNode*** all_indiv_ptr);
-void genetic_operators(node_str* contestant1, node_str* contestant2, bool* c1_change, bool* c2_change, uint32_t cross_perc, uint32_t mut_perc, bool vis);
-void select_offspring(node_str** best, int* best_id, node_str** offsprings, bool* ofs_change, int* ofs_id, int num_offspring, int parent1_ind, int parent2_ind, double* fitness_values, bool vis, char* test_file, char** src_files, uint32_t num_src_files, bool cache, char* cache_file, const char *cache_id, int g, DataNode*** all_indiv_ptr, uint32_t num_runs, bool fitness_with_var);
+void update_proxy_threshold(DataNode** all_indiv, int* elite_id, int num_elites);
+void select_parents(uint32_t* c_ind1, uint32_t* c_ind2, node_str** population, double* fitness_values, int copy_size, int tourn_size, bool vis);
+uint32_t race_tournament(DataNode** all_indiv, int* copy_gen_id, double* rank_values, uint32_t copy_size, uint32_t tourn_size, char* file, char** src_files, uint32_t num_src_files, const char* cache_id, uint32_t num_runs, int g, bool vis, bool fitness_with_var);
+void select_raced_parents(uint32_t* c_ind1, uint32_t* c_ind2, DataNode** all_indiv, int* copy_gen_id, double* rank_values, uint32_t copy_size, uint32_t tourn_size, char* file, char** src_files, uint32_t num_src_files, const char* cache_id, uint32_t num_runs, int g, bool vis, bool fitness_with_var);
+void generate_offspring(int parent1_ind, int parent2_ind, Genome** copy_gen, int* copy_gen_id, int num_offspring, node_str** offsprings, bool* ofs_change, int* ofs_id, uint32_t cross_perc, uint32_t mut_perc, bool vis, int* max_id_ptr, int* hash_cap_ptr, DataNode*** all_indiv_ptr);
+void genetic_operators(Genome** contestant1, Genome** contestant2, bool* c1_change, bool* c2_change, uint32_t cross_perc, uint32_t mut_perc, bool vis);
+void select_offspring(node_str** best, int* best_id, node_str** offsprings, bool* ofs_change, int* ofs_id, double* ofs_fitness, int num_offspring, bool vis);
 void update_generation(node_str* contestant1, node_str* contestant2, int c1_id, int c2_id, node_str** current_generation, int* current_gen_id, int pop_size, int num_elites, int num_new_random, int p);
-void create_mutants(node_str** copy_gen, node_str** current_generation, double* fitness_values,\
+void create_mutants(Genome** copy_gen, node_str** current_generation, double* fitness_values,\
                         int* copy_gen_id, int* current_gen_id, int* max_id_ptr, \
                         uint32_t tourn_size, uint32_t pop_size, uint32_t cross_perc, uint32_t mut_perc, \
                         uint32_t num_elites, uint32_t num_new_random, uint32_t copy_size, \
@@ -249,6 +269,10 @@ void create_mutants(node_str** copy_gen, node_str** current_generation, double*
                         bool vis, int g, \
                         bool cache, char* cache_file, const char* cache_id, \
                         DataNode*** all_indiv_ptr, int* hash_cap_ptr, bool fitness_with_var);
+bool steady_submit_offspring(EvalStream* stream, EvolutionState* state, double* rank_values, uint32_t indiv_size, uint32_t tourn_size, uint32_t cross_perc, uint32_t mut_perc, bool vis, int g);
+bool steady_replace_worst(DataNode* d, EvolutionState* state, double* rank_values);
+uint32_t evolution_steady_state(EvolutionState* state, uint32_t first_gen, uint32_t indiv_size, uint32_t tourn_size, uint32_t mut_perc, uint32_t cross_perc, \
+                                bool vis, char* file, const char* cache_id, bool cache, char* main_folder, int offset, uint32_t num_runs, bool fitness_with_var);
 void log_all_indiv_info(bool cache, DataNode** all_indiv, char* main_folder, int num_runs, int max_id);
 void log_redo_basic(char* folder, char* file, bool cache, const char *cache_id, double best_fitness, uint32_t num_runs, bool fitness_with_var, int g, const char** levels, int num_levels);
 bool check_termination(double best_fitness, double* lowest_ptr, int* stale_counter_ptr, const int stale_limit);
@@ -33,7 +33,11 @@
  * IMPORT
  */
 
+#include <math.h>
 #include "fitness.h"
+#include "evaluation.h"
+
+#define TIMEOUT_BASELINE_RUNS 3     //Runs of every baseline level timed only to set the run timeout when nothing is cached
 
 /*
  * ROUTINES
@@ -362,6 +366,85 @@ uint32_t fitness_osaka_string(node_str* indiv, bool vis) {
 
 }
 
+/*
+ * The opt, build and run commands of every baseline level. no_opt times the
+ * linked module as it is
+ */
+static void fitness_baseline_commands(char* base_file, const char** levels, const int num_levels, char (*opt_commands)[1000], char (*bc_commands)[1000], char (*run_commands)[1000]) {
+    char opt_file[300];
+
+    for (int i = 0; i < num_levels; i++) {
+        if (strlen(levels[i]) == 0) {
+            strcpy(opt_commands[i], "");
+
+            strcpy(opt_file, base_file);
+            strcat(opt_file, "_linked");
+        }
+        else {
+            strcpy(opt_file, "");
+            strcat(opt_file, base_file);
+            strcat(opt_file, "_opt_");
+            strcat(opt_file, levels[i]);
+
+            strcpy(opt_commands[i], "");
+            strcat(opt_commands[i], "opt -");
+            strcat(opt_commands[i], levels[i]);
+            strcat(opt_commands[i], " ");
+            strcat(opt_commands[i], base_file);
+            strcat(opt_commands[i], "_linked.ll -S -o ");
+            strcat(opt_commands[i], opt_file);
+            strcat(opt_commands[i], ".ll");
+        }
+        strcat(opt_file, ".ll");
+        // the baselines are built and run exactly like the individuals, natively or with lli
+        llvm_form_measure_commands(opt_file, eval_settings.exec_mode == EXEC_NATIVE, bc_commands[i], run_commands[i]);
+    }
+}
+
+/*
+ * Without -cache the baselines are not recorded, but the run timeout of the individuals
+ * still depends on the fastest of them. Every level is built and timed a few runs, in turns
+ */
+static void fitness_time_timeout_baselines(char* test_file, const char* cache_id, const char** levels, const int num_levels) {
+    char base_file[300];
+    char opt_commands[num_levels][1000];
+    char bc_commands[num_levels][1000];
+    char run_commands[num_levels][1000];
+    char* opt_command_ptrs[num_levels];
+    char* bc_command_ptrs[num_levels];
+    double all_runtime[num_levels][TIMEOUT_BASELINE_RUNS];
+    FitnessSampler samplers[num_levels];
+
+    if (eval_settings.timeout_factor <= 0) {
+        return;
+    }
+    llvm_form_base_file(test_file, cache_id, base_file);
+    fitness_baseline_commands(base_file, levels, num_levels, opt_commands, bc_commands, run_commands);
+    for (int i = 0; i < num_levels; i++) {
+        opt_command_ptrs[i] = opt_commands[i];
+        bc_command_ptrs[i] = bc_commands[i];
+    }
+    evaluation_build_baselines(opt_command_ptrs, bc_command_ptrs, num_levels);
+    for (int i = 0; i < num_levels; i++) {
+        fitness_sampler_init(&samplers[i], run_commands[i], TIMEOUT_BASELINE_RUNS, NULL, NULL, all_runtime[i]);
+    }
+    bool sampling = true;
+    while (sampling) {
+        sampling = false;
+        for (int i = 0; i < num_levels; i++) {
+            sampling = fitness_sampler_step(&samplers[i]) || sampling;
+        }
+    }
+    for (int i = 0; i < num_levels; i++) {
+        LaunchResult usage;
+        uint32_t success_runs = 0;
+        fitness_sampler_finish(&samplers[i], &success_runs, &usage);
+        if (success_runs > 0) {
+            evaluation_set_baseline_time(usage.elapsed);
+        }
+    }
+}
+
 /*
  * NAME
  *
@@ -400,16 +483,15 @@ void fitness_pre_cache_llvm_pass(char* folder, char* test_file, char** src_files
 
     llvm_form_build_ll_command(src_files, num_src_files, test_file, build_command, cache_id);
     llvm_run_command(build_command);
+    evaluation_check_exec_mode(test_file, cache_id);
 
     if (!cache) {
+        fitness_time_timeout_baselines(test_file, cache_id, levels, num_levels);
         return;
     }
 
     cache_create_baseline_folder(cache, folder);
-    struct timeval start, end; 
-    uint32_t result = 0;
     uint32_t success_runs = 0;
-    int counter = 0;
 
     double total_time = 0.0;
     double time_taken = 0.0;
@@ -418,13 +500,8 @@ void fitness_pre_cache_llvm_pass(char* folder, char* test_file, char** src_files
     char test_file_name[100];
     char test_file_name_no_path[100];
     char junk_dir[200];
-    char opt_file[200];
     char base_file[200];
 
-    char opt_command[1000];
-    char bc_command[1000];
-    char run_command[1000];
-
     strcpy(test_file_name, test_file);
     char* p = strchr(test_file_name, '.');
 
@@ -446,83 +523,49 @@ void fitness_pre_cache_llvm_pass(char* folder, char* test_file, char** src_files
     strcat(base_file, "_");
     strcat(base_file, cache_id);
 
-    for (int i = 0; i < num_levels; i++) {
-        total_time = 0.0;
-        time_taken = 0.0;
-        fitness = 0.0;
-        if (strlen(levels[i]) == 0) {
-            strcpy(opt_command, "");
-
-            strcpy(bc_command, "llvm-as ");
-            strcat(bc_command, base_file);
-            strcat(bc_command, "_linked");
-            strcat(bc_command, ".ll");
+    char opt_commands[num_levels][1000];
+    char bc_commands[num_levels][1000];
+    char run_commands[num_levels][1000];
 
-            strcpy(run_command, "lli ");
-            strcat(run_command, base_file);
-            strcat(run_command, "_linked");
-            strcat(run_command, ".bc");
-        }
-        else {
-            strcpy(opt_file, "");
-            strcat(opt_file, base_file);
-            strcat(opt_file, "_opt_");
-            strcat(opt_file, levels[i]);
-
-            strcpy(opt_command, "");
-            strcat(opt_command, "opt -");
-            strcat(opt_command, levels[i]);
-            strcat(opt_command, " ");
-            strcat(opt_command, base_file);
-            strcat(opt_command, "_linked.ll -S -o ");
-            strcat(opt_command, opt_file);
-            strcat(opt_command, ".ll");
+    fitness_baseline_commands(base_file, levels, num_levels, opt_commands, bc_commands, run_commands);
 
-            strcpy(bc_command, "");
-            strcat(bc_command, "llvm-as ");
-            strcat(bc_command, opt_file);
-            strcat(bc_command, ".ll");
+    // the levels do not depend on each other, they are built at the same time and timed in turns
+    char* opt_command_ptrs[num_levels];
+    char* bc_command_ptrs[num_levels];
+    for (int i = 0; i < num_levels; i++) {
+        opt_command_ptrs[i] = opt_commands[i];
+        bc_command_ptrs[i] = bc_commands[i];
+    }
+    evaluation_build_baselines(opt_command_ptrs, bc_command_ptrs, num_levels);
 
-            strcpy(run_command, "");
-            strcat(run_command, "lli ");
-            strcat(run_command, opt_file);
-            strcat(run_command, ".bc");
+    double all_runtime[num_levels][num_runs]; //Added 7/7/2021
+    FitnessSampler samplers[num_levels];
+    for (int i = 0; i < num_levels; i++) {
+        fitness_sampler_init(&samplers[i], run_commands[i], num_runs, NULL, NULL, all_runtime[i]);
+    }
+    bool sampling = true;
+    while (sampling) {
+        sampling = false;
+        for (int i = 0; i < num_levels; i++) {
+            if (eval_settings.interleave) {
+                sampling = fitness_sampler_step(&samplers[i]) || sampling;
+            } else {
+                while (fitness_sampler_step(&samplers[i])) {
+                }
+            }
         }
-        
-        /*printf("\n--------------------LLVM opt level: %s, ALL COMMANDS GENERATED---------------------\n", strlen(levels[i])==0?"no_opt":levels[i]);
-        printf("opt_command: %s\n", opt_command);
-        printf("bc_command: %s\n", bc_command);
-        printf("run_command: %s\n", run_command);*/
-        
-        llvm_run_command(opt_command);
-        llvm_run_command(bc_command);
+    }
 
-        double all_runtime[num_runs]; //Added 7/7/2021
-        success_runs = 0;
+    for (int i = 0; i < num_levels; i++) {
+        LaunchResult usage;
         time_taken = 0.0;
-        total_time = 0.0;
-        counter = 0;
-
-        for (uint32_t runs = 0; runs < num_runs; runs++) {
-
-            gettimeofday(&start, NULL);
-            result = llvm_run_command(run_command);
-            gettimeofday(&end, NULL);
-            //printf("run command return code: %d\n", result);
-            // Added 6/21/2021
-            time_taken = (end.tv_sec - start.tv_sec) * 1e6;
-            time_taken = (time_taken + (end.tv_usec - start.tv_usec)) * 1e-6;
-            //printf("LLVM opt level: %s, run #%d, time taken: %lf\n", strlen(levels[i])==0?"no_opt":levels[i], runs+1, time_taken);
-            if (result == 0) {
-                success_runs++;
-                total_time = total_time + time_taken;
-                all_runtime[counter++] = time_taken;
-                //printf("Time taken: %lf sec.\n", time_taken);
-            }
-            else {
-                //printf("Run exited with code %d (time taken: %lf sec.)\n", result, time_taken);
-            }
+        fitness = 0.0;
+        total_time = fitness_sampler_finish(&samplers[i], &success_runs, &usage);
+        // the fastest baseline sets the timeout of every individual
+        if (success_runs > 0) {
+            evaluation_set_baseline_time(usage.elapsed);
         }
+
         // Added 6/21/2021
         /*if (success_runs < num_runs * tol) {
             //printf("success_runs < num_runs * %f, fitness set to max.\n", tol);
@@ -532,21 +575,77 @@ void fitness_pre_cache_llvm_pass(char* folder, char* test_file, char** src_files
         }*/
         time_taken = total_time / success_runs;
         if (fitness_with_var) {
-            fitness = time_taken + calc_var(all_runtime, time_taken, success_runs);
+            fitness = time_taken + calc_var(all_runtime[i], time_taken, success_runs);
         } else {
             fitness = time_taken;
         }
         printf("LLVM opt level: %s, average time=%lf over %d success runs, fitness=%lf\n", strlen(levels[i])==0?"no_opt":levels[i], time_taken, success_runs, fitness);
         track_fitness[i] = fitness;  //Added 6/8/2021
-        /*for (int k = 0; k <= i; k++) {
-            printf("%s%lf%s", k==0?"track_fitness=[":"", track_fitness[k], k==i?"]\n":",");
-        }*/
+        evaluation_add_baseline(levels[i], fitness, success_runs > 0 ? time_taken : 0.0, run_commands[i]);
 
         fitness_pre_cache_log_to_summary(i, folder, levels, num_levels, fitness);
+    }
+    return;
+}
+
+/*
+ * NAME
+ *
+ *   fitness_rebuild_llvm_pass
+ *
+ * DESCRIPTION
+ *
+ *  Builds the linked module and the baseline optimization levels again when a run
+ *  is resumed from a checkpoint, without timing anything. The measurements of
+ *  the baselines are restored from the checkpoint
+ *
+ * PARAMETERS
+ *
+ *  char* test_file - the test file, with extension
+ *  char** src_files - the source files that are linked with the test file
+ *  uint32_t num_src_files - number of source files
+ *  const char* cache_id - unique id of this run
+ *  const char** levels - the baseline optimization levels, "" for no optimization
+ *  const int num_levels - number of baseline optimization levels
+ *
+ * RETURN
+ *
+ *  none
+ *
+ * EXAMPLE
+ *
+ * fitness_rebuild_llvm_pass(test_file, src_files, num_src_files, cache_id, levels, num_levels);
+ *
+ * SIDE-EFFECT
+ *
+ * Creates the linked module and baseline files in src/files/llvm/junk_output
+ *
+ */
 
+void fitness_rebuild_llvm_pass(char* test_file, char** src_files, uint32_t num_src_files, const char* cache_id, const char** levels, const int num_levels) {
+    char build_command[20000];
+    char base_file[300];
+    char opt_commands[num_levels][1000];
+    char bc_commands[num_levels][1000];
+    char run_commands[num_levels][1000];
+    char* opt_command_ptrs[num_levels];
+    char* bc_command_ptrs[num_levels];
 
+    strcpy(build_command, "");
+    llvm_form_build_ll_command(src_files, num_src_files, test_file, build_command, cache_id);
+    llvm_run_command(build_command);
+    evaluation_check_exec_mode(test_file, cache_id);
+
+    llvm_form_base_file(test_file, cache_id, base_file);
+    fitness_baseline_commands(base_file, levels, num_levels, opt_commands, bc_commands, run_commands);
+    for (int i = 0; i < num_levels; i++) {
+        opt_command_ptrs[i] = opt_commands[i];
+        bc_command_ptrs[i] = bc_commands[i];
+    }
+    evaluation_build_baselines(opt_command_ptrs, bc_command_ptrs, num_levels);
+    for (int i = 0; i < num_levels; i++) {
+        evaluation_restore_baseline(levels[i], run_commands[i]);
     }
-    return;
 }
 
 void fitness_pre_cache_log_to_summary(int level_ind, char* folder, const char** levels, const int num_levels, double fitness) {
@@ -610,10 +709,16 @@ void fitness_redo_basic(char* folder, char* test_file, bool cache, double* track
         return;
     }
 
-    struct timeval start, end; 
-    uint32_t result = 0;
+    // the control level timed alongside every batch tells how far the machine drifted since start-up
+    double drift = 1.0;
+    if (evaluation_drift_baselines(track_fitness, num_levels, &drift)) {
+        for (int i = 0; i < num_levels; i++) {
+            printf("LLVM opt level: %s, fitness=%lf (start-up fitness scaled by the drift of %s, %lf)\n", strlen(levels[i])==0?"no_opt":levels[i], track_fitness[i], eval_settings.control_level, drift);
+        }
+        return;
+    }
+
     uint32_t success_runs = 0;
-    int counter = 0;
     double total_time = 0.0;
     double time_taken = 0.0;
     double fitness = 0.0;
@@ -656,15 +761,8 @@ void fitness_redo_basic(char* folder, char* test_file, bool cache, double* track
         if (strlen(levels[i]) == 0) {
             strcpy(opt_command, "");
 
-            strcpy(bc_command, "llvm-as ");
-            strcat(bc_command, base_file);
-            strcat(bc_command, "_linked");
-            strcat(bc_command, ".ll");
-
-            strcpy(run_command, "lli ");
-            strcat(run_command, base_file);
-            strcat(run_command, "_linked");
-            strcat(run_command, ".bc");
+            strcpy(opt_file, base_file);
+            strcat(opt_file, "_linked");
         }
         else {
             strcpy(opt_file, "");
@@ -680,17 +778,10 @@ void fitness_redo_basic(char* folder, char* test_file, bool cache, double* track
             strcat(opt_command, "_linked.ll -S -o ");
             strcat(opt_command, opt_file);
             strcat(opt_command, ".ll");
-
-            strcpy(bc_command, "");
-            strcat(bc_command, "llvm-as ");
-            strcat(bc_command, opt_file);
-            strcat(bc_command, ".ll");
-
-            strcpy(run_command, "");
-            strcat(run_command, "lli ");
-            strcat(run_command, opt_file);
-            strcat(run_command, ".bc");
         }
+        strcat(opt_file, ".ll");
+        // the baselines are built and run exactly like the individuals, natively or with lli
+        llvm_form_measure_commands(opt_file, eval_settings.exec_mode == EXEC_NATIVE, bc_command, run_command);
         
         //printf("\n--------------------LLVM opt level: %s, ALL COMMANDS GENERATED---------------------\n", strlen(levels[i])==0?"no_opt":levels[i]);
         //printf("opt_command: %s\n", opt_command);
@@ -701,27 +792,9 @@ void fitness_redo_basic(char* folder, char* test_file, bool cache, double* track
         llvm_run_command(bc_command);
 
         double all_runtime[num_runs]; //Added 7/7/2021
-        success_runs = 0;
         time_taken = 0.0;
-        total_time = 0.0;
-        counter = 0;
-
-        for (uint32_t runs = 0; runs < num_runs; runs++) {
-
-            gettimeofday(&start, NULL);
-            result = llvm_run_command(run_command);
-            gettimeofday(&end, NULL);
-            //printf("run command return code: %d\n", result);
-            // Added 6/21/2021
-            time_taken = (end.tv_sec - start.tv_sec) * 1e6;
-            time_taken = (time_taken + (end.tv_usec - start.tv_usec)) * 1e-6;
-            //printf("LLVM opt level: %s, run #%d, time taken: %lf\n", strlen(levels[i])==0?"no_opt":levels[i], runs+1, time_taken);
-            if (result == 0) {
-                success_runs++;
-                total_time = total_time + time_taken;
-                all_runtime[counter++] = time_taken;
-            }
-        }
+        total_time = fitness_time_runs(run_command, num_runs, NULL, NULL, all_runtime, &success_runs, NULL);
+
         /*if (success_runs < num_runs * tol) {
             //printf("success_runs < num_runs * %f, fitness set to max.\n", tol);
             time_taken = UINT32_MAX;
@@ -843,120 +916,359 @@ void fitness_cache_llvm_pass(double fitness, node_str* indiv, char* cache_file)
  */
 
 double fitness_llvm_pass(node_str* indiv, char* file, char** src_files, uint32_t num_src_files, bool vis, bool cache, char* cache_file, const char *cache_id, DataNode* indiv_data, uint32_t num_runs, int gen, bool fitness_with_var) {
-    
+
+    // a single individual is just a batch of one, the evaluation engine does the opt and timed runs
     double fitness;
-    fitness = indiv_data->fitness;
-    if (!node_reeval_by_chance(indiv_data, gen)) {
-        //printf("----skipped re-evaluation for individual id=%d\n", indiv_data->seq_id);
-        return indiv_data->fitness;
-    }
-    uint32_t success_runs = 0; //Added 6/21/2021
+    evaluation_batch(&indiv, &indiv_data, 1, &fitness, vis, file, src_files, num_src_files, cache, cache_file, cache_id, num_runs, gen, fitness_with_var);
 
-    char file_name[300];
-    char base_name[300];
-    char input_file[300];
-    char output_file[300];
-    char base_file[300];
+    /*if (cache) {
+        fitness_cache_llvm_pass(fitness, indiv, cache_file);
+    }*/
+    return fitness;
 
-    struct timeval start, end; 
-    uint32_t result = 0;
-    double tol = 0.95;
+}
+
+/*
+ * NAME
+ *
+ *   fitness_stop_sampling
+ *
+ * DESCRIPTION
+ *
+ *  Decides whether an individual has been timed often enough. The 95%
+ *  confidence interval of the mean runtime (Student t) is compared with the
+ *  threshold of the rule: once the whole interval is above it the individual
+ *  is clearly worse, once it is below it the individual is clearly better.
+ *  Timing also stops once the interval is tight relative to the mean
+ *
+ * PARAMETERS
+ *
+ *  double* all_runtime - the time of every successful run so far
+ *  uint32_t success_runs - the number of successful runs so far
+ *  SampleStop* stop - the stopping rule
+ *
+ * RETURN
+ *
+ *  bool - true if no more runs are needed
+ *
+ * EXAMPLE
+ *
+ * if (fitness_stop_sampling(all_runtime, success_runs, &stop)) {
+ *     break;
+ * }
+ *
+ * SIDE-EFFECT
+ *
+ * none
+ *
+ */
 
-    strcpy(file_name, file);
-    char* p = strchr(file_name, '.');
 
-    if (!p) {
-        printf("File must have valid extension such as .c or .cpp.\n\nAborting code\n\n");
-        exit(0);
+bool fitness_stop_sampling(double* all_runtime, uint32_t success_runs, SampleStop* stop) {
+
+    double total_time = 0.0;
+    double total_sq = 0.0;
+
+    if (success_runs < stop->min_runs || success_runs < 2) {
+        return false;
     }
-    *p = 0;
+    for (uint32_t r = 0; r < success_runs; r++) {
+        total_time += all_runtime[r];
+    }
+    double mean = total_time / success_runs;
+    for (uint32_t r = 0; r < success_runs; r++) {
+        total_sq += (all_runtime[r] - mean) * (all_runtime[r] - mean);
+    }
+    double t = runstats_t95(success_runs - 1);
+    double half_width = t * sqrt(total_sq / (success_runs - 1) / success_runs);
 
-    char file_name_no_path[100];
-    strcpy(file_name_no_path, "");
-    char *t = strrchr(file_name, '/'); 
-    if (!t) {
-        strcpy(file_name_no_path, file_name);
-    } else strcpy(file_name_no_path, t+1);
+    if (stop->threshold != UINT32_MAX && (mean - half_width > stop->threshold || mean + half_width < stop->threshold)) {
+        return true;
+    }
+    return half_width <= stop->precision * mean;
 
-    strcpy(base_file, "");
-    strcat(base_file, "src/files/llvm/junk_output/");
-    strcat(base_file, file_name_no_path);
-    strcat(base_file, "_");
-    strcat(base_file, cache_id);
+}
 
-    strcpy(input_file, base_file);
-    strcat(input_file, "_linked.ll");
+/*
+ * NAME
+ *
+ *   fitness_sampler_init
+ *
+ * DESCRIPTION
+ *
+ *  Prepares the timed runs of a command without starting any of them.
+ *  eval_settings.warmup_runs runs are discarded before the first recorded one
+ *
+ * PARAMETERS
+ *
+ *  FitnessSampler* s - the sampler that is prepared
+ *  char* run_command - the command that will be timed
+ *  uint32_t num_runs - number of runs that are recorded, at most if stop is used
+ *  SampleStop* stop - if not NULL, the rule that may end timing before num_runs
+ *  LaunchLimits* limits - if not NULL, the timeout and memory limit of every run
+ *  double* all_runtime - holds the time of every successful run, dimension: num_runs
+ *
+ * RETURN
+ *
+ *  none
+ *
+ * EXAMPLE
+ *
+ * fitness_sampler_init(&s, run_command, 40, NULL, NULL, all_runtime);
+ *
+ * SIDE-EFFECT
+ *
+ * none
+ *
+ */
 
-    strcpy(output_file, base_file);
-    strcat(output_file, "_shackleton.ll");
+void fitness_sampler_init(FitnessSampler* s, char* run_command, uint32_t num_runs, SampleStop* stop, LaunchLimits* limits, double* all_runtime) {
 
-    if (vis) {
-        printf("Calculating fitness of individual\n");
+    s->run_command = run_command;
+    s->direct = launcher_parse_command(run_command, &s->launch);
+    s->launch.count_events = eval_settings.perf_counters;
+    if (limits != NULL) {
+        s->launch.limits = *limits;
     }
+    s->num_runs = num_runs;
+    s->warmup_runs = eval_settings.warmup_runs;
+    s->stop = stop;
+    s->all_runtime = all_runtime;
+    s->success_runs = 0;
+    s->attempted_runs = 0;
+    s->counted_runs = 0;
+    s->total_time = 0.0;
+    memset(&s->usage, 0, sizeof(LaunchResult));
+    s->done = num_runs == 0;
 
-    char opt_command[5000];
-    char run_command[5000];
-    strcpy(opt_command, "");
-    strcpy(run_command, "");
+}
 
-    //printf("building opt command with input_file=%s, output_file=%s\n\n", input_file, output_file);
-    //printf("input_file: %s\n", input_file);
-    //printf("output_file: %s\n", output_file);
-    llvm_form_opt_command(indiv, NULL, 0, input_file, output_file, opt_command);
-    llvm_form_exec_code_command_from_ll(output_file, run_command);
-    
-    //printf("\nShackleton opt command: %s\n", opt_command);
-    //printf("run command: %s\n", run_command);
+/*
+ * NAME
+ *
+ *   fitness_sampler_step
+ *
+ * DESCRIPTION
+ *
+ *  Starts and times one run of the command of a sampler. The sampler is
+ *  done once num_runs runs are recorded, the stopping rule ends timing, or a
+ *  run times out. A run that hangs once will hang again, so no further run
+ *  spends the whole timeout
+ *
+ * PARAMETERS
+ *
+ *  FitnessSampler* s - the sampler that takes the run
+ *
+ * RETURN
+ *
+ *  bool - true if the sampler needs more runs
+ *
+ * EXAMPLE
+ *
+ * while (fitness_sampler_step(&s)) {
+ * }
+ *
+ * SIDE-EFFECT
+ *
+ * Interfaces with some terminal
+ *
+ */
 
-    llvm_run_command(opt_command);
+bool fitness_sampler_step(FitnessSampler* s) {
 
-    double total_time = 0.0;
+    struct timeval start, end;
+    uint32_t result = 0;
     double time_taken = 0.0;
-    double all_runtime[num_runs]; //Added 7/7/2021
-    int counter = 0; //Added 7/7/2021
-
-    for (uint32_t runs = 0; runs < num_runs; runs++) {
+    LaunchResult run;
 
-        //printf("\n-----------------------------------------------------------------------------\n");
-        //printf("Shackleton optimization run %d\n\n", runs+1);
+    if (s->done) {
+        return false;
+    }
+    if (s->warmup_runs > 0) {
+        // warm-up runs only fill caches and bring the core up to speed, their time is thrown away
+        s->warmup_runs--;
+        if (s->direct) {
+            if (launcher_run(&s->launch, &run) && run.timed_out) {
+                s->usage.timed_out = true;
+                s->done = true;
+            }
+        } else {
+            llvm_run_command(s->run_command);
+        }
+        return !s->done;
+    }
 
+    s->attempted_runs++;
+    s->done = s->attempted_runs == s->num_runs;
+    if (s->direct) {
+        if (!launcher_run(&s->launch, &run)) {
+            return !s->done;
+        }
+        if (run.timed_out) {
+            // a run that hangs once will hang again, do not spend the whole timeout on every run
+            s->usage.timed_out = true;
+            s->done = true;
+            return false;
+        }
+        if (run.status != 0) {
+            return !s->done;
+        }
+        // a run without counters cannot be measured in instructions or cycles
+        if (eval_settings.metric != METRIC_TIME && !run.counted) {
+            return !s->done;
+        }
+        if (eval_settings.metric == METRIC_INSTRUCTIONS) {
+            time_taken = run.instructions * 1e-6;
+        } else if (eval_settings.metric == METRIC_CYCLES) {
+            time_taken = run.cycles * 1e-6;
+        } else {
+            time_taken = run.elapsed;
+        }
+        s->usage.elapsed += run.elapsed;
+        s->usage.utime += run.utime;
+        s->usage.stime += run.stime;
+        s->usage.maxrss = run.maxrss > s->usage.maxrss ? run.maxrss : s->usage.maxrss;
+        if (run.counted) {
+            s->usage.instructions += run.instructions;
+            s->usage.cycles += run.cycles;
+            s->usage.branch_misses += run.branch_misses;
+            s->usage.cache_misses += run.cache_misses;
+            s->counted_runs++;
+        }
+    }
+    else if (eval_settings.metric != METRIC_TIME) {
+        // commands that need a shell are not counted
+        return !s->done;
+    }
+    else {
         gettimeofday(&start, NULL);
-        result = llvm_run_command(run_command);
-        //result = llvm_run_command(basic_opt_run_command);
+        result = llvm_run_command(s->run_command);
         gettimeofday(&end, NULL);
-        //printf("run command return code: %d\n", result);
         // Added 6/21/2021
         time_taken = (end.tv_sec - start.tv_sec) * 1e6;
         time_taken = (time_taken + (end.tv_usec - start.tv_usec)) * 1e-6;
-        //printf("Shackleton opt run #%d, time taken: %lf\n", runs+1, time_taken);
-        if (result == 0) {
-            success_runs++;
-            total_time = total_time + time_taken;
-            //printf("Time taken in current run: %lf sec.\n", time_taken);
-            all_runtime[counter++] = time_taken; //Added 7/7/2021
-        }
-        else {
-            //printf("Run exited with code %d (time taken: %lf sec.)\n", result, time_taken);
+        if (result != 0) {
+            return !s->done;
         }
     }
+    s->total_time = s->total_time + time_taken;
+    s->all_runtime[s->success_runs++] = time_taken; //Added 7/7/2021
+    if (s->stop != NULL && fitness_stop_sampling(s->all_runtime, s->success_runs, s->stop)) {
+        s->done = true;
+    }
+    return !s->done;
 
-    // Added 6/21/2021
-    if (success_runs < num_runs * tol) {
-        //printf("success_runs < num_runs*%f, fitness set to max.\n", tol);
-        time_taken = UINT32_MAX;
-    } else {
-        time_taken = total_time / success_runs;
-        //printf("average time taken: %lf\n", time_taken);
+}
+
+/*
+ * NAME
+ *
+ *   fitness_sampler_finish
+ *
+ * DESCRIPTION
+ *
+ *  Collects the results of a sampler once it is done
+ *
+ * PARAMETERS
+ *
+ *  FitnessSampler* s - the sampler that is done
+ *  uint32_t* success_runs - holds the number of successful runs
+ *  LaunchResult* usage - if not NULL, holds the average wall time, user and system CPU time,
+ *                        the largest max RSS and the average hardware counters
+ *                        over the successful runs, and whether a run timed out
+ *
+ * RETURN
+ *
+ *  double - the total time of all successful runs, in seconds or in the unit of the metric
+ *
+ * EXAMPLE
+ *
+ * double total_time = fitness_sampler_finish(&s, &success_runs, NULL);
+ *
+ * SIDE-EFFECT
+ *
+ * none
+ *
+ */
+
+double fitness_sampler_finish(FitnessSampler* s, uint32_t* success_runs, LaunchResult* usage) {
+
+    if (s->stop != NULL) {
+        s->stop->attempted_runs = s->attempted_runs;
+    }
+    if (s->success_runs > 0) {
+        s->usage.elapsed /= s->success_runs;
+        s->usage.utime /= s->success_runs;
+        s->usage.stime /= s->success_runs;
+    }
+    if (s->counted_runs > 0) {
+        s->usage.counted = true;
+        s->usage.instructions /= s->counted_runs;
+        s->usage.cycles /= s->counted_runs;
+        s->usage.branch_misses /= s->counted_runs;
+        s->usage.cache_misses /= s->counted_runs;
     }
+    *success_runs = s->success_runs;
+    if (usage != NULL) {
+        *usage = s->usage;
+    }
+    return s->total_time;
 
-    fitness = node_record_data(indiv_data, indiv, all_runtime, time_taken, success_runs, gen, fitness_with_var);
-    //fitness = node_look_up_fitness(indiv_data, indiv, all_runtime, time_taken, success_runs);
-    //printf("Average time: %lf over %d success runs, fitness=%lf\n", time_taken, success_runs, fitness);
-    
-    /*if (cache) {
-        fitness_cache_llvm_pass(fitness, indiv, cache_file);
-    }*/
-    return fitness;
+}
+
+/*
+ * NAME
+ *
+ *   fitness_time_runs
+ *
+ * DESCRIPTION
+ *
+ *  Runs an already built command num_runs times and times every run.
+ *  Only runs that exit successfully are recorded. The command is started
+ *  directly by the launcher, without a shell, and timed with the monotonic
+ *  clock. Commands that need a shell are still run through system(). With
+ *  a stopping rule, timing ends as soon as fitness_stop_sampling says so.
+ *  The runs are taken one after the other by a FitnessSampler.
+ *  If eval_settings.metric is not METRIC_TIME, every run is measured in
+ *  millions of instructions or cycles read from the hardware counters
+ *  instead of seconds
+ *
+ * PARAMETERS
+ *
+ *  char* run_command - the command that will be timed
+ *  uint32_t num_runs - number of times the command is run, at most if stop is used
+ *  SampleStop* stop - if not NULL, the rule that may end timing before num_runs
+ *  LaunchLimits* limits - if not NULL, the timeout and memory limit of every run.
+ *                         Timing ends at the first run that times out
+ *  double* all_runtime - holds the time of every successful run, dimension: num_runs
+ *  uint32_t* success_runs - holds the number of successful runs
+ *  LaunchResult* usage - if not NULL, holds the average wall time, user and system CPU time,
+ *                        the largest max RSS and the average hardware counters
+ *                        over the successful runs, and whether a run timed out
+ *
+ * RETURN
+ *
+ *  double - the total time of all successful runs, in seconds or in the unit of the metric
+ *
+ * EXAMPLE
+ *
+ * double total_time = fitness_time_runs(run_command, 40, NULL, NULL, all_runtime, &success_runs, NULL);
+ *
+ * SIDE-EFFECT
+ *
+ * Interfaces with some terminal
+ *
+ */
+
+
+double fitness_time_runs(char* run_command, uint32_t num_runs, SampleStop* stop, LaunchLimits* limits, double* all_runtime, uint32_t* success_runs, LaunchResult* usage) {
+
+    FitnessSampler s;
+
+    fitness_sampler_init(&s, run_command, num_runs, stop, limits, all_runtime);
+    while (fitness_sampler_step(&s)) {
+    }
+    return fitness_sampler_finish(&s, success_runs, usage);
 
 }
 
@@ -38,12 +38,45 @@
 
 #include "../osaka/osaka.h"
 #include "../support/llvm.h"
+#include "../support/launcher.h"
 #include <stdbool.h>
 #include "sys/time.h"
 #include "indivdata.h"
 #include "../support/cache.h"
 #include "../support/utility.h"
 
+/*
+ * Stopping rule of the timed runs of one individual. Timing stops once the
+ * confidence interval of the mean runtime no longer overlaps the threshold,
+ * or once it is narrower than precision times the mean
+ */
+typedef struct SampleStop {
+    uint32_t min_runs;          //Successful runs before the rule is checked
+    double threshold;           //Runtime the interval is compared against, UINT32_MAX if there is none
+    double precision;           //Largest relative half-width of the interval that still needs more runs
+    uint32_t attempted_runs;    //Set to the number of runs started, successful or not
+} SampleStop;
+
+/*
+ * Timed runs of one command that are taken one at a time, so the runs of
+ * several individuals can be interleaved
+ */
+typedef struct FitnessSampler {
+    char* run_command;          //Command that is timed
+    LaunchCommand launch;       //The command split for the launcher, if direct
+    bool direct;                //Whether the command is started by the launcher instead of system()
+    uint32_t num_runs;          //Most recorded runs
+    uint32_t warmup_runs;       //Runs still to be discarded before runs are recorded
+    SampleStop* stop;           //Rule that may end timing before num_runs, NULL if none
+    double* all_runtime;        //Time of every successful run, dimension: num_runs
+    uint32_t success_runs;
+    uint32_t attempted_runs;    //Recorded runs started so far, warm-up runs excluded
+    uint32_t counted_runs;      //Successful runs with hardware counters
+    double total_time;
+    LaunchResult usage;         //Sums over the successful runs until fitness_sampler_finish averages them
+    bool done;
+} FitnessSampler;
+
 /*
  * STATIC
  */
@@ -353,6 +386,8 @@ uint32_t fitness_osaka_string(node_str* indiv, bool vis);
  * DESCRIPTION
  *
  *  Creates a file that describes the control values for fitness using LLVM opt
+ *  levels. The levels are built at the same time and timed in turns, and the
+ *  control level is remembered to track drift of the machine later on
  *
  * PARAMETERS
  *
@@ -378,9 +413,230 @@ uint32_t fitness_osaka_string(node_str* indiv, bool vis);
 void fitness_pre_cache_llvm_pass(char* folder, char* test_file, char** src_files, uint32_t num_src_files, bool cache, double* track_fitness, const char *id, uint32_t num_runs, bool fitness_with_var, const char** levels, const int num_levels);  //added 6/8/2021
 //double fitness_pre_cache_llvm_pass(char* folder, char* test_file, char** src_files, uint32_t num_src_files, bool cache);  //added 6/2/2021
 //void fitness_pre_cache_llvm_pass(char* folder, char* test_file, char** src_files, uint32_t num_src_files, bool cache);
+
+/*
+ * NAME
+ *
+ *   fitness_rebuild_llvm_pass
+ *
+ * DESCRIPTION
+ *
+ *  Builds the linked module and the baseline optimization levels again when a run
+ *  is resumed from a checkpoint, without timing anything. The measurements of
+ *  the baselines are restored from the checkpoint
+ *
+ * PARAMETERS
+ *
+ *  char* test_file - the test file, with extension
+ *  char** src_files - the source files that are linked with the test file
+ *  uint32_t num_src_files - number of source files
+ *  const char* cache_id - unique id of this run
+ *  const char** levels - the baseline optimization levels, "" for no optimization
+ *  const int num_levels - number of baseline optimization levels
+ *
+ * RETURN
+ *
+ *  none
+ *
+ * EXAMPLE
+ *
+ * fitness_rebuild_llvm_pass(test_file, src_files, num_src_files, cache_id, levels, num_levels);
+ *
+ * SIDE-EFFECT
+ *
+ * Creates the linked module and baseline files in src/files/llvm/junk_output
+ *
+ */
+
+void fitness_rebuild_llvm_pass(char* test_file, char** src_files, uint32_t num_src_files, const char* cache_id, const char** levels, const int num_levels);
+
 void fitness_redo_basic(char* folder, char* test_file, bool cache, double* track_fitness, const char *cache_id, uint32_t num_runs, bool fitness_with_var, const char** levels, const int num_levels);
 void fitness_pre_cache_log_to_summary(int level_ind, char* folder, const char** levels, const int num_levels, double fitness);
 
+/*
+ * NAME
+ *
+ *   fitness_stop_sampling
+ *
+ * DESCRIPTION
+ *
+ *  Decides whether an individual has been timed often enough. The 95%
+ *  confidence interval of the mean runtime (Student t) is compared with the
+ *  threshold of the rule: once the whole interval is above it the individual
+ *  is clearly worse, once it is below it the individual is clearly better.
+ *  Timing also stops once the interval is tight relative to the mean
+ *
+ * PARAMETERS
+ *
+ *  double* all_runtime - the time of every successful run so far
+ *  uint32_t success_runs - the number of successful runs so far
+ *  SampleStop* stop - the stopping rule
+ *
+ * RETURN
+ *
+ *  bool - true if no more runs are needed
+ *
+ * EXAMPLE
+ *
+ * if (fitness_stop_sampling(all_runtime, success_runs, &stop)) {
+ *     break;
+ * }
+ *
+ * SIDE-EFFECT
+ *
+ * none
+ *
+ */
+
+bool fitness_stop_sampling(double* all_runtime, uint32_t success_runs, SampleStop* stop);
+
+/*
+ * NAME
+ *
+ *   fitness_sampler_init
+ *
+ * DESCRIPTION
+ *
+ *  Prepares the timed runs of a command without starting any of them.
+ *  eval_settings.warmup_runs runs are discarded before the first recorded one
+ *
+ * PARAMETERS
+ *
+ *  FitnessSampler* s - the sampler that is prepared
+ *  char* run_command - the command that will be timed
+ *  uint32_t num_runs - number of runs that are recorded, at most if stop is used
+ *  SampleStop* stop - if not NULL, the rule that may end timing before num_runs
+ *  LaunchLimits* limits - if not NULL, the timeout and memory limit of every run
+ *  double* all_runtime - holds the time of every successful run, dimension: num_runs
+ *
+ * RETURN
+ *
+ *  none
+ *
+ * EXAMPLE
+ *
+ * fitness_sampler_init(&s, run_command, 40, NULL, NULL, all_runtime);
+ *
+ * SIDE-EFFECT
+ *
+ * none
+ *
+ */
+
+void fitness_sampler_init(FitnessSampler* s, char* run_command, uint32_t num_runs, SampleStop* stop, LaunchLimits* limits, double* all_runtime);
+
+/*
+ * NAME
+ *
+ *   fitness_sampler_step
+ *
+ * DESCRIPTION
+ *
+ *  Starts and times one run of the command of a sampler. The sampler is
+ *  done once num_runs runs are recorded, the stopping rule ends timing, or a
+ *  run times out. A run that hangs once will hang again, so no further run
+ *  spends the whole timeout
+ *
+ * PARAMETERS
+ *
+ *  FitnessSampler* s - the sampler that takes the run
+ *
+ * RETURN
+ *
+ *  bool - true if the sampler needs more runs
+ *
+ * EXAMPLE
+ *
+ * while (fitness_sampler_step(&s)) {
+ * }
+ *
+ * SIDE-EFFECT
+ *
+ * Interfaces with some terminal
+ *
+ */
+
+bool fitness_sampler_step(FitnessSampler* s);
+
+/*
+ * NAME
+ *
+ *   fitness_sampler_finish
+ *
+ * DESCRIPTION
+ *
+ *  Collects the results of a sampler once it is done
+ *
+ * PARAMETERS
+ *
+ *  FitnessSampler* s - the sampler that is done
+ *  uint32_t* success_runs - holds the number of successful runs
+ *  LaunchResult* usage - if not NULL, holds the average wall time, user and system CPU time,
+ *                        the largest max RSS and the average hardware counters
+ *                        over the successful runs, and whether a run timed out
+ *
+ * RETURN
+ *
+ *  double - the total time of all successful runs, in seconds or in the unit of the metric
+ *
+ * EXAMPLE
+ *
+ * double total_time = fitness_sampler_finish(&s, &success_runs, NULL);
+ *
+ * SIDE-EFFECT
+ *
+ * none
+ *
+ */
+
+double fitness_sampler_finish(FitnessSampler* s, uint32_t* success_runs, LaunchResult* usage);
+
+/*
+ * NAME
+ *
+ *   fitness_time_runs
+ *
+ * DESCRIPTION
+ *
+ *  Runs an already built command num_runs times and times every run.
+ *  Only runs that exit successfully are recorded. The command is started
+ *  directly by the launcher, without a shell, and timed with the monotonic
+ *  clock. Commands that need a shell are still run through system(). With
+ *  a stopping rule, timing ends as soon as fitness_stop_sampling says so.
+ *  The runs are taken one after the other by a FitnessSampler.
+ *  If eval_settings.metric is not METRIC_TIME, every run is measured in
+ *  millions of instructions or cycles read from the hardware counters
+ *  instead of seconds
+ *
+ * PARAMETERS
+ *
+ *  char* run_command - the command that will be timed
+ *  uint32_t num_runs - number of times the command is run, at most if stop is used
+ *  SampleStop* stop - if not NULL, the rule that may end timing before num_runs
+ *  LaunchLimits* limits - if not NULL, the timeout and memory limit of every run.
+ *                         Timing ends at the first run that times out
+ *  double* all_runtime - holds the time of every successful run, dimension: num_runs
+ *  uint32_t* success_runs - holds the number of successful runs
+ *  LaunchResult* usage - if not NULL, holds the average wall time, user and system CPU time,
+ *                        the largest max RSS and the average hardware counters
+ *                        over the successful runs, and whether a run timed out
+ *
+ * RETURN
+ *
+ *  double - the total time of all successful runs, in seconds or in the unit of the metric
+ *
+ * EXAMPLE
+ *
+ * double total_time = fitness_time_runs(run_command, 40, NULL, NULL, all_runtime, &success_runs, NULL);
+ *
+ * SIDE-EFFECT
+ *
+ * Interfaces with some terminal
+ *
+ */
+
+double fitness_time_runs(char* run_command, uint32_t num_runs, SampleStop* stop, LaunchLimits* limits, double* all_runtime, uint32_t* success_runs, LaunchResult* usage);
+
 /*
  * NAME
  *
@@ -0,0 +1,288 @@
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "fitstore.h"
+#include "evaluation.h"
+#include "irtable.h"
+
+#define FITSTORE_MAGIC 0x3154535446484b53ULL
+#define FITSTORE_INITIAL_CAPACITY 4096
+
+static int store_fd = -1;
+static FitStoreHeader* store = NULL;     //The mapped file, remapped whenever another process grew it
+static size_t mapped_size = 0;
+static uint64_t context = 0;
+static uint64_t hits = 0;               //First evaluations answered by the store
+static uint64_t misses = 0;
+static uint64_t records_put = 0;
+
+static uint64_t fitstore_hash_bytes(uint64_t hash, const void* bytes, size_t n) {
+
+    for (size_t i = 0; i < n; i++) {
+        hash ^= ((const unsigned char*)bytes)[i];
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+
+}
+
+static FitStoreRecord* fitstore_records() {
+
+    return (FitStoreRecord*)(store + 1);
+
+}
+
+static size_t fitstore_file_size(uint32_t capacity) {
+
+    return sizeof(FitStoreHeader) + (size_t)capacity * sizeof(FitStoreRecord);
+
+}
+
+/*
+ * Maps the whole file again if another process grew it since the last lock.
+ * Must be called with the file locked
+ */
+static bool fitstore_map() {
+
+    struct stat st;
+
+    if (fstat(store_fd, &st) != 0) {
+        return false;
+    }
+    if (store != NULL && (size_t)st.st_size == mapped_size) {
+        return true;
+    }
+    if (store != NULL) {
+        munmap(store, mapped_size);
+        store = NULL;
+    }
+    void* map = mmap(NULL, st.st_size, PROT_READ | PROT_WRITE, MAP_SHARED, store_fd, 0);
+    if (map == MAP_FAILED) {
+        return false;
+    }
+    store = map;
+    mapped_size = st.st_size;
+    return true;
+
+}
+
+static FitStoreRecord* fitstore_find(uint64_t genome, bool add) {
+
+    FitStoreRecord* records = fitstore_records();
+    uint32_t mask = store->capacity - 1;
+
+    for (uint32_t i = (uint32_t)(genome ^ context) & mask; ; i = (i + 1) & mask) {
+        if (records[i].context == 0) {
+            if (!add) {
+                return NULL;
+            }
+            records[i].context = context;
+            records[i].genome = genome;
+            store->num_records++;
+            return &records[i];
+        }
+        if (records[i].context == context && records[i].genome == genome) {
+            return &records[i];
+        }
+    }
+
+}
+
+/*
+ * Doubles the number of slots once three quarters are used. Must be called
+ * with the file locked exclusively
+ */
+static bool fitstore_grow() {
+
+    uint32_t capacity = store->capacity;
+    size_t old_size = fitstore_file_size(capacity);
+    FitStoreRecord* old_records = malloc(old_size - sizeof(FitStoreHeader));
+
+    memcpy(old_records, fitstore_records(), old_size - sizeof(FitStoreHeader));
+    if (ftruncate(store_fd, fitstore_file_size(capacity * 2)) != 0 || !fitstore_map()) {
+        free(old_records);
+        return false;
+    }
+    memset(fitstore_records(), 0, fitstore_file_size(capacity * 2) - sizeof(FitStoreHeader));
+    store->capacity = capacity * 2;
+    store->num_records = 0;
+
+    // every record is placed again, they may belong to other contexts
+    uint64_t own_context = context;
+    for (uint32_t r = 0; r < capacity; r++) {
+        if (old_records[r].context != 0) {
+            context = old_records[r].context;
+            *fitstore_find(old_records[r].genome, true) = old_records[r];
+        }
+    }
+    context = own_context;
+    free(old_records);
+    return true;
+
+}
+
+/*
+ * Everything that changes the runtime of a pass sequence other than the sequence
+ * itself: the linked module of the target, the opt that runs the passes, and how runs
+ * are timed. Runs measured under a different context are never mixed in
+ */
+static uint64_t fitstore_context_hash(char* linked_file) {
+
+    char line[500];
+    long size;
+    uint64_t hash = irtable_hash_file(linked_file, &size);
+
+    if (size < 0) {
+        return 0;
+    }
+    hash = fitstore_hash_bytes(hash, &size, sizeof(size));
+    FILE* version = popen("opt --version 2>/dev/null", "r");
+    if (version != NULL) {
+        while (fgets(line, sizeof(line), version) != NULL) {
+            hash = fitstore_hash_bytes(hash, line, strlen(line));
+        }
+        pclose(version);
+    }
+    hash = fitstore_hash_bytes(hash, &eval_settings.exec_mode, sizeof(eval_settings.exec_mode));
+    hash = fitstore_hash_bytes(hash, &eval_settings.metric, sizeof(eval_settings.metric));
+    return hash != 0 ? hash : 1;
+
+}
+
+/*
+ * Opens the store shared by every run on the same target, creating it if needed.
+ * Returns false if the file cannot be used, the run then goes on without it
+ */
+bool fitstore_open(char* store_file, char* linked_file) {
+
+    context = fitstore_context_hash(linked_file);
+    if (context == 0) {
+        return false;
+    }
+    store_fd = open(store_file, O_RDWR | O_CREAT, 0644);
+    if (store_fd < 0) {
+        return false;
+    }
+    flock(store_fd, LOCK_EX);
+    struct stat st;
+    bool ok = fstat(store_fd, &st) == 0;
+    if (ok && st.st_size == 0) {
+        ok = ftruncate(store_fd, fitstore_file_size(FITSTORE_INITIAL_CAPACITY)) == 0 && fitstore_map();
+        if (ok) {
+            store->magic = FITSTORE_MAGIC;
+            store->capacity = FITSTORE_INITIAL_CAPACITY;
+            store->num_records = 0;
+        }
+    } else if (ok) {
+        ok = fitstore_map() && mapped_size >= sizeof(FitStoreHeader) && store->magic == FITSTORE_MAGIC &&
+             mapped_size == fitstore_file_size(store->capacity);
+    }
+    flock(store_fd, LOCK_UN);
+    if (!ok) {
+        fitstore_close();
+    }
+    return ok;
+
+}
+
+bool fitstore_is_open() {
+
+    return store != NULL;
+
+}
+
+uint64_t fitstore_genome_hash(node_str* indiv) {
+
+    uint64_t hash = 14695981039346656037ULL;
+
+    for (node_str* n = indiv; n != NULL; n = NEXT(n)) {
+        object_llvm_pass_str* pass = (object_llvm_pass_str*)OBJECT(n);
+        // the terminating 0 separates the passes
+        hash = fitstore_hash_bytes(hash, PASS(pass), strlen(PASS(pass)) + 1);
+    }
+    return hash;
+
+}
+
+/*
+ * Copies the most recent runs of a pass sequence, at most max_runs of them.
+ * Returns false if no process has evaluated the sequence on this target yet
+ */
+bool fitstore_get(uint64_t genome, double* runtimes, uint32_t max_runs, uint32_t* num_runs, eval_status* status, LaunchResult* usage) {
+
+    bool found = false;
+
+    flock(store_fd, LOCK_SH);
+    if (fitstore_map()) {
+        FitStoreRecord* r = fitstore_find(genome, false);
+        if (r != NULL && r->num_evals > 0) {
+            found = true;
+            *num_runs = r->num_samples < max_runs ? r->num_samples : max_runs;
+            memcpy(runtimes, r->runtimes + r->num_samples - *num_runs, sizeof(double) * *num_runs);
+            *status = (eval_status)r->status;
+            memset(usage, 0, sizeof(LaunchResult));
+            usage->utime = r->utime;
+            usage->stime = r->stime;
+            usage->maxrss = r->maxrss;
+        }
+    }
+    flock(store_fd, LOCK_UN);
+    if (found) {
+        hits++;
+    } else {
+        misses++;
+    }
+    return found;
+
+}
+
+void fitstore_put(uint64_t genome, double* runtimes, uint32_t num_runs, eval_status status, LaunchResult* usage) {
+
+    flock(store_fd, LOCK_EX);
+    bool ok = fitstore_map();
+    if (ok && ((uint64_t)store->num_records + 1) * 4 > (uint64_t)store->capacity * 3) {
+        ok = fitstore_grow();
+    }
+    if (ok) {
+        FitStoreRecord* r = fitstore_find(genome, true);
+        if (num_runs > FITSTORE_SAMPLES) {
+            runtimes += num_runs - FITSTORE_SAMPLES;
+            num_runs = FITSTORE_SAMPLES;
+        }
+        // the oldest runs make room for the new ones
+        uint32_t keep = r->num_samples + num_runs > FITSTORE_SAMPLES ? FITSTORE_SAMPLES - num_runs : r->num_samples;
+        memmove(r->runtimes, r->runtimes + r->num_samples - keep, sizeof(double) * keep);
+        memcpy(r->runtimes + keep, runtimes, sizeof(double) * num_runs);
+        r->num_samples = keep + num_runs;
+        r->num_evals++;
+        r->status = status;
+        r->utime = usage->utime;
+        r->stime = usage->stime;
+        r->maxrss = usage->maxrss;
+        records_put++;
+    }
+    flock(store_fd, LOCK_UN);
+
+}
+
+void fitstore_print_stats() {
+
+    printf("Fitness store: %lu first evaluations found, %lu not found, %lu evaluations added, %u sequences stored\n", (unsigned long)hits, (unsigned long)misses, (unsigned long)records_put, store != NULL ? store->num_records : 0);
+
+}
+
+void fitstore_close() {
+
+    if (store != NULL) {
+        munmap(store, mapped_size);
+        store = NULL;
+        mapped_size = 0;
+    }
+    if (store_fd >= 0) {
+        close(store_fd);
+        store_fd = -1;
+    }
+
+}
@@ -0,0 +1,47 @@
+#ifndef EVOLUTION_FITSTORE_H_
+#define EVOLUTION_FITSTORE_H_
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include "../osaka/osaka.h"
+#include "../support/launcher.h"
+#include "indivdata.h"
+
+#define FITSTORE_SAMPLES 40     //Most recent runs kept per pass sequence
+
+/*
+ * Start of the store file, followed by capacity records
+ */
+typedef struct FitStoreHeader {
+    uint64_t magic;
+    uint32_t capacity;          //Number of record slots, a power of two
+    uint32_t num_records;       //Slots in use
+} FitStoreHeader;
+
+/*
+ * Measurements of one pass sequence on one target, found by open addressing
+ */
+typedef struct FitStoreRecord {
+    uint64_t context;           //Hash of the linked target module, the toolchain, the execution mode and the metric, 0 if the slot is free
+    uint64_t genome;            //Hash of the pass sequence
+    uint32_t num_samples;       //Runs in runtimes, the oldest is dropped once FITSTORE_SAMPLES are kept
+    uint32_t num_evals;         //Evaluations that added runs, across all processes
+    int32_t status;             //eval_status of the last evaluation
+    double utime;               //Average CPU times and largest max RSS of the last evaluation
+    double stime;
+    long maxrss;
+    double runtimes[FITSTORE_SAMPLES];
+} FitStoreRecord;
+
+bool fitstore_open(char* store_file, char* linked_file);
+bool fitstore_is_open();
+uint64_t fitstore_genome_hash(node_str* indiv);
+bool fitstore_get(uint64_t genome, double* runtimes, uint32_t max_runs, uint32_t* num_runs, eval_status* status, LaunchResult* usage);
+void fitstore_put(uint64_t genome, double* runtimes, uint32_t num_runs, eval_status status, LaunchResult* usage);
+void fitstore_print_stats();
+void fitstore_close();
+
+#endif /* EVOLUTION_FITSTORE_H_ */
@@ -328,18 +328,8 @@ void generate_copy_gen_id(int* orig, int* copy, uint32_t generation_size) {
 
 void generate_free_individual(node_str* indiv) {
 
-    // we must free every single node in this individual
-    uint32_t list_length = osaka_listlength(indiv);
-
-    for (uint32_t i = list_length; i > 0; i--) {
-        if (indiv != NULL) {
-            osaka_deletenode(osaka_nthnode(indiv, i));
-        }
-        else {
-            printf("inside generate_free_individual, indiv %d== NULL\n", i);
-        }
-
-    }
+    // we must free every single node in this individual, in one walk down the list
+    osaka_freelist(indiv);
 
 }
 
@@ -375,13 +365,7 @@ void generate_free_individual(node_str* indiv) {
 void generate_free_individual_inside_array(node_str** array, uint32_t gen_size, uint32_t ind, node_str* indiv) {
 
     // we must free every single node in this individual
-    uint32_t list_length = osaka_listlength(indiv);
-
-    for (uint32_t i = list_length; i > 0; i--) {
-
-        osaka_deletenode(osaka_nthnode(indiv, i));
-
-    }
+    osaka_freelist(indiv);
 
     for (int k = ind; k < gen_size - 1; k++) {
 
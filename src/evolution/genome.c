@@ -0,0 +1,207 @@
+#include "genome.h"
+#include "crossover.h"
+#include "mutation.h"
+#include "generation.h"
+
+Genome* genome_alloc(uint32_t length) {
+
+    Genome* genome = malloc(sizeof(Genome) + length);
+
+    if (genome == NULL) {
+        printf("error: failed to alloc memory for a genome of %u passes\n\nAborting code\n\n", length);
+        exit(0);
+    }
+    genome->list = NULL;
+    genome->refs = 1;
+    genome->length = length;
+    return genome;
+
+}
+
+Genome* genome_from_individual(node_str* indiv) {
+
+    uint32_t length = osaka_listlength(indiv);
+
+    if (OBJECT_TYPE(indiv) != LLVM_PASS) {
+        Genome* genome = genome_alloc(0);
+        genome->list = osaka_copylist(indiv);
+        genome->length = length;
+        return genome;
+    }
+    Genome* genome = genome_alloc(length);
+    uint32_t i = 0;
+    for (node_str* n = indiv; n != NULL; n = NEXT(n)) {
+        genome->pass[i++] = PASS_INDEX(((object_llvm_pass_str*)OBJECT(n)));
+    }
+    return genome;
+
+}
+
+/*
+ * Builds the list the rest of the framework works on, the nodes are linked
+ * directly instead of walking to the tail for every pass
+ */
+node_str* genome_to_individual(Genome* genome) {
+
+    if (genome->list != NULL) {
+        return osaka_copylist(genome->list);
+    }
+
+    node_str* head = NULL;
+    node_str* tail = NULL;
+    for (uint32_t i = 0; i < genome->length; i++) {
+        node_str* n = osaka_createnode(NULL, HEAD, LLVM_PASS);
+        object_llvm_pass_str* o = OBJECT(n);
+        PASS_INDEX(o) = genome->pass[i];
+        PASS(o) = llvm_pass_catalog[genome->pass[i]];
+        if (tail == NULL) {
+            head = n;
+        } else {
+            NEXT(tail) = n;
+            LAST(n) = tail;
+        }
+        tail = n;
+    }
+    return head;
+
+}
+
+/*
+ * A flat genome is shared rather than copied
+ */
+Genome* genome_copy(Genome* genome) {
+
+    if (genome->list == NULL) {
+        genome->refs++;
+        return genome;
+    }
+    Genome* copy = genome_alloc(0);
+    copy->list = osaka_copylist(genome->list);
+    copy->length = genome->length;
+    return copy;
+
+}
+
+bool genome_compare(Genome* genome1, Genome* genome2) {
+
+    if (genome1->length != genome2->length) {
+        return false;
+    }
+    if (genome1->list != NULL || genome2->list != NULL) {
+        return genome1->list != NULL && genome2->list != NULL && osaka_compare(genome1->list, genome2->list);
+    }
+    return memcmp(genome1->pass, genome2->pass, genome1->length) == 0;
+
+}
+
+/*
+ * Same operator as crossover_onepoint_macro, with the same random draw: the passes
+ * from one point on, the same in both genomes, are swapped. Both genomes are replaced
+ * by new ones, the old ones are let go
+ */
+void genome_crossover_onepoint(Genome** genome1, Genome** genome2, bool vis) {
+
+    Genome* g1 = *genome1;
+    Genome* g2 = *genome2;
+
+    if (g1->list != NULL || g2->list != NULL) {
+        crossover_onepoint_macro(g1->list, g2->list, vis);
+        g1->length = osaka_listlength(g1->list);
+        g2->length = osaka_listlength(g2->list);
+        return;
+    }
+
+    uint32_t random = 1;
+    uint32_t shorter = g1->length < g2->length ? g1->length : g2->length;
+    while (random <= 1) {
+        random = (uint32_t) (shorter * (rand() / (RAND_MAX + 1.0))) + 1;
+    }
+    if (vis) {
+        printf("\nPerforming onepoint crossover, splitting is to be done at point %d ----------------------\n\n", random);
+        genome_print(g1);
+        printf("\n\n");
+        genome_print(g2);
+    }
+
+    uint32_t keep = random - 1;
+    Genome* c1 = genome_alloc(g2->length);
+    Genome* c2 = genome_alloc(g1->length);
+    memcpy(c1->pass, g1->pass, keep);
+    memcpy(c1->pass + keep, g2->pass + keep, g2->length - keep);
+    memcpy(c2->pass, g2->pass, keep);
+    memcpy(c2->pass + keep, g1->pass + keep, g1->length - keep);
+    genome_free(g1);
+    genome_free(g2);
+    *genome1 = c1;
+    *genome2 = c2;
+
+    if (vis) {
+        printf("\n\nIndividuals after crossover: --------------------------------------------------------\n\n");
+        genome_print(c1);
+        printf("\n\n");
+        genome_print(c2);
+        printf("\n\n");
+    }
+
+}
+
+/*
+ * Same operator as mutation_single_unit_all_params, ind counts from 1. A shared
+ * genome is copied first and the copy replaces it
+ */
+void genome_mutate(Genome** genome_ptr, uint32_t ind, bool vis) {
+
+    Genome* genome = *genome_ptr;
+
+    if (genome->list != NULL) {
+        mutation_single_unit_all_params(genome->list, ind, vis);
+        return;
+    }
+    if (genome->refs > 1) {
+        Genome* copy = genome_alloc(genome->length);
+        memcpy(copy->pass, genome->pass, genome->length);
+        genome_free(genome);
+        genome = *genome_ptr = copy;
+    }
+
+    genome->pass[ind - 1] = (uint8_t) (LLVM_NUM_PASSES * (rand() / (RAND_MAX + 1.0)));
+
+    if (vis) {
+        printf("\nIndividual after mutation to node %d: -------------------------------------------------\n\n", ind);
+        genome_print(genome);
+        printf("\n");
+    }
+
+}
+
+void genome_print(Genome* genome) {
+
+    if (genome->list != NULL) {
+        visualization_print_individual_concise_details(genome->list);
+        return;
+    }
+    for (uint32_t i = 0; i < genome->length; i++) {
+        printf("%s{ pass : %s(%d) }", i == 0 ? "" : " <---> ", llvm_pass_catalog[genome->pass[i]], genome->pass[i]);
+    }
+
+}
+
+void genome_free(Genome* genome) {
+
+    if (--genome->refs > 0) {
+        return;
+    }
+    if (genome->list != NULL) {
+        generate_free_individual(genome->list);
+    }
+    free(genome);
+
+}
+
+void genome_free_generation(Genome** gen, uint32_t generation_size) {
+
+    for (uint32_t i = 0; i < generation_size; i++) {
+        genome_free(gen[i]);
+    }
+
+}
@@ -0,0 +1,36 @@
+#ifndef EVOLUTION_GENOME_H_
+#define EVOLUTION_GENOME_H_
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include "../osaka/osaka.h"
+#include "../module/llvm_pass.h"
+
+/*
+ * An individual stored as one block holding the catalog index of each of its passes.
+ * Flat genomes are never changed once shared: copies only add a reference, and an
+ * operator applied to a shared genome works on a new one. Individuals of object
+ * types without a catalog keep a copy of their list instead, which is never shared
+ */
+typedef struct Genome {
+    node_str* list;             //Copy of the individual for object types other than LLVM_PASS, NULL for flat genomes
+    uint32_t refs;              //Holders of the genome, it is freed when the last one lets go
+    uint32_t length;            //Number of nodes
+    uint8_t pass[];             //Index of each pass in llvm_pass_catalog
+} Genome;
+
+Genome* genome_alloc(uint32_t length);
+Genome* genome_from_individual(node_str* indiv);
+node_str* genome_to_individual(Genome* genome);
+Genome* genome_copy(Genome* genome);
+bool genome_compare(Genome* genome1, Genome* genome2);
+void genome_crossover_onepoint(Genome** genome1, Genome** genome2, bool vis);
+void genome_mutate(Genome** genome, uint32_t ind, bool vis);
+void genome_print(Genome* genome);
+void genome_free(Genome* genome);
+void genome_free_generation(Genome** gen, uint32_t generation_size);
+
+#endif /* EVOLUTION_GENOME_H_ */
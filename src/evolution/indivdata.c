@@ -1,23 +1,71 @@
+#include <pthread.h>
+#include <math.h>
 #include "indivdata.h"
+#include "../module/llvm_pass.h"
 
-DataNode* node_new_allele(node_str* seq, int id) {
+#define NODE_INDEX_INITIAL_CAPACITY 1024
+
+/*
+ * Slot of the index from genome hashes to individual ids
+ */
+typedef struct NodeIndexSlot {
+    uint64_t hash;
+    int id;                 //-1 if the slot is free
+} NodeIndexSlot;
+
+// open addressing index over all_indiv, so an individual is found without comparing it to every other one
+static NodeIndexSlot* node_index = NULL;
+static uint32_t node_index_capacity = 0;
+static int node_index_count = 0;        //Ids 0..node_index_count-1 are in the index
+static DataNode** node_index_registry = NULL;   //all_indiv the index was built over
+static pthread_mutex_t node_index_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static int node_index_find(DataNode** all_indiv, int max_id, node_str* sequence);
+
+// the new record owns seq
+static DataNode* node_wrap_allele(node_str* seq, int id) {
     DataNode* d = malloc(sizeof(DataNode));
-    d->seq = osaka_copylist(seq);
+    d->seq = seq;
+    d->genome = genome_from_individual(seq);
     d->seq_len = osaka_listlength(seq);
     d->seq_id = id;
     d->fitness = -1;
+    d->fitness_low = 0.0;
+    d->fitness_high = UINT32_MAX;
+    d->proxy = -1;
     d->num_eval = 0;
+    d->learned = 0;
+    d->folded = 0;
+    d->folded_runs = 0;
+    d->folded_time = 0.0;
+    d->folded_at = 0;
     d->tot_gen = 0;
     d->capacity = 2;
-    d->time_arrs = (double**) malloc(sizeof(double*) * d->capacity);
+    d->total_run = 0;
+    d->total_time = 0.0;
+    d->total_var = 0.0;
+    runstats_init(&d->stats);
+    d->sample_at = (uint64_t*) malloc(sizeof(uint64_t) * d->capacity);
     d->success_cts = (int*) malloc(sizeof(int) * d->capacity);
     d->avg_time = (double*) malloc(sizeof(double) * d->capacity);
     d->var = (double*) malloc(sizeof(double) * d->capacity);
+    d->utime = (double*) malloc(sizeof(double) * d->capacity);
+    d->stime = (double*) malloc(sizeof(double) * d->capacity);
+    d->maxrss = (long*) malloc(sizeof(long) * d->capacity);
+    d->instructions = (double*) malloc(sizeof(double) * d->capacity);
+    d->cycles = (double*) malloc(sizeof(double) * d->capacity);
+    d->branch_misses = (double*) malloc(sizeof(double) * d->capacity);
+    d->cache_misses = (double*) malloc(sizeof(double) * d->capacity);
+    d->status = (eval_status*) malloc(sizeof(eval_status) * d->capacity);
     d->gens = (int*) malloc(sizeof(int) * d->capacity);
     //printf("created new allele, ID=%d\n", d->seq_id);
     return d;
 }
 
+DataNode* node_new_allele(node_str* seq, int id) {
+    return node_wrap_allele(osaka_copylist(seq), id);
+}
+
 double node_record_data(DataNode* d, node_str* sequence, double* all_runtime, double avg_runtime, int success_runs, int gen, bool fitness_with_var) {
     //printf("inside node_record_data\n");
     //visualization_print_individual_concise_details(sequence);
@@ -39,54 +87,203 @@ double node_record_data(DataNode* d, node_str* sequence, double* all_runtime, do
     //printf("after osaka_compare\n");
     d->num_eval += 1;
     node_check_overflow(d);
-    d->time_arrs[d->num_eval-1] = malloc(sizeof(double) * success_runs);
-    for (int i = 0; i < success_runs; i++) {
-        d->time_arrs[d->num_eval-1][i] = all_runtime[i];
-    }
-    d->avg_time[d->num_eval-1] = avg_runtime;
-    d->success_cts[d->num_eval-1] = success_runs;
+    int row = node_last_row(d);
+    d->avg_time[row] = avg_runtime;
+    d->success_cts[row] = success_runs;
     if (fitness_with_var) {
-        d->var[d->num_eval-1] = calc_var(all_runtime, avg_runtime, success_runs);
+        d->var[row] = calc_var(all_runtime, avg_runtime, success_runs);
     } else {
-        d->var[d->num_eval-1] = -1;
+        d->var[row] = -1;
     }
-    d->gens[d->num_eval-1] = gen+1;
+    d->utime[row] = 0.0;
+    d->stime[row] = 0.0;
+    d->maxrss[row] = 0;
+    d->instructions[row] = -1;
+    d->cycles[row] = -1;
+    d->branch_misses[row] = -1;
+    d->cache_misses[row] = -1;
+    d->status[row] = avg_runtime == UINT32_MAX ? EVAL_RUN_FAILED : EVAL_OK;
+    d->gens[row] = gen+1;
+    node_add_runs(d, all_runtime);
     return node_update_fitness(d, fitness_with_var);
 }
 
+/*
+ * Stores the runtimes of the last evaluation, whose success_cts, avg_time and var are set,
+ * and adds them to the running totals so the fitness never has to go over earlier evaluations
+ */
+void node_add_runs(DataNode* d, double* all_runtime) {
+    int e = node_last_row(d);
+    d->sample_at[e] = samples_append(all_runtime, d->success_cts[e]);
+    if (d->avg_time[e] == UINT32_MAX) {
+        return;
+    }
+    d->total_run += d->success_cts[e];
+    d->total_time += d->avg_time[e] * d->success_cts[e];
+    d->total_var += d->var[e];
+    for (int i = 0; i < d->success_cts[e]; i++) {
+        runstats_add(&d->stats, all_runtime[i]);
+    }
+}
+
+// attaches the CPU time and memory use reported by the launcher to the last evaluation
+void node_record_usage(DataNode* d, double utime, double stime, long maxrss) {
+    int row = node_last_row(d);
+    d->utime[row] = utime;
+    d->stime[row] = stime;
+    d->maxrss[row] = maxrss;
+}
+
+// attaches the hardware counters of the successful runs to the last evaluation
+void node_record_counters(DataNode* d, double instructions, double cycles, double branch_misses, double cache_misses) {
+    int row = node_last_row(d);
+    d->instructions[row] = instructions;
+    d->cycles[row] = cycles;
+    d->branch_misses[row] = branch_misses;
+    d->cache_misses[row] = cache_misses;
+}
+
+// marks why the last evaluation failed, so compile failures and timeouts can be told apart in the logs
+void node_record_status(DataNode* d, eval_status status) {
+    d->status[node_last_row(d)] = status;
+}
+
+// row of the last evaluation of d
+int node_last_row(DataNode* d) {
+    return d->num_eval - 1 - d->folded;
+}
+
+// whether node_estimate reads the runtimes of an individual back instead of using its running totals
+bool node_reads_runs() {
+    return estimator_settings.estimator != ESTIMATOR_MEAN || estimator_settings.interval != INTERVAL_ANALYTIC;
+}
+
+static void node_drop_rows(void* rows, size_t row_size, int dropped, int num_rows) {
+    memmove(rows, (char*)rows + row_size * dropped, row_size * (num_rows - dropped));
+}
+
+/*
+ * Folds the oldest half of the rows of d into the totals, which already count them, so an
+ * individual that stays elite for the whole run does not grow with every generation. If the
+ * estimator reads runtimes back, the counted runtimes of the folded evaluations are appended
+ * to the sample buffer again as one block, next to the runtimes d is still timed with
+ */
+static void node_fold(DataNode* d) {
+    int dropped = NODE_MAX_ROWS / 2;
+    int num_rows = d->num_eval - d->folded;
+    int folded_runs = d->folded_runs;
+    for (int e = 0; e < dropped; e++) {
+        if (d->avg_time[e] != UINT32_MAX) {
+            folded_runs += d->success_cts[e];
+            d->folded_time += d->avg_time[e] * d->success_cts[e];
+        }
+    }
+    if (node_reads_runs() && folded_runs > 0) {
+        double* runtimes = malloc(sizeof(double) * folded_runs);
+        samples_read(d->folded_at, d->folded_runs, runtimes);
+        int n = d->folded_runs;
+        for (int e = 0; e < dropped; e++) {
+            if (d->avg_time[e] != UINT32_MAX) {
+                samples_read(d->sample_at[e], d->success_cts[e], runtimes + n);
+                n += d->success_cts[e];
+            }
+        }
+        d->folded_at = samples_append(runtimes, folded_runs);
+        free(runtimes);
+    }
+    d->folded_runs = folded_runs;
+    node_drop_rows(d->sample_at, sizeof(uint64_t), dropped, num_rows);
+    node_drop_rows(d->success_cts, sizeof(int), dropped, num_rows);
+    node_drop_rows(d->avg_time, sizeof(double), dropped, num_rows);
+    node_drop_rows(d->var, sizeof(double), dropped, num_rows);
+    node_drop_rows(d->utime, sizeof(double), dropped, num_rows);
+    node_drop_rows(d->stime, sizeof(double), dropped, num_rows);
+    node_drop_rows(d->maxrss, sizeof(long), dropped, num_rows);
+    node_drop_rows(d->instructions, sizeof(double), dropped, num_rows);
+    node_drop_rows(d->cycles, sizeof(double), dropped, num_rows);
+    node_drop_rows(d->branch_misses, sizeof(double), dropped, num_rows);
+    node_drop_rows(d->cache_misses, sizeof(double), dropped, num_rows);
+    node_drop_rows(d->status, sizeof(eval_status), dropped, num_rows);
+    node_drop_rows(d->gens, sizeof(int), dropped, num_rows);
+    d->folded += dropped;
+}
+
+// makes room for the row of the last evaluation, growing the arrays up to NODE_MAX_ROWS and folding after that
 void node_check_overflow(DataNode* d) {
-    if (d->num_eval >= d->capacity) {
+    if (d->num_eval - d->folded >= d->capacity && d->capacity >= NODE_MAX_ROWS) {
+        node_fold(d);
+    } else if (d->num_eval - d->folded >= d->capacity) {
         d->capacity *= 2;
-        d->time_arrs = realloc(d->time_arrs, sizeof(double*) * d->capacity);
+        d->sample_at = realloc(d->sample_at, sizeof(uint64_t) * d->capacity);
         d->success_cts = realloc(d->success_cts, sizeof(int) * d->capacity);
         d->avg_time = realloc(d->avg_time, sizeof(double) * d->capacity);
         d->var = realloc(d->var, sizeof(double) * d->capacity);
+        d->utime = realloc(d->utime, sizeof(double) * d->capacity);
+        d->stime = realloc(d->stime, sizeof(double) * d->capacity);
+        d->maxrss = realloc(d->maxrss, sizeof(long) * d->capacity);
+        d->instructions = realloc(d->instructions, sizeof(double) * d->capacity);
+        d->cycles = realloc(d->cycles, sizeof(double) * d->capacity);
+        d->branch_misses = realloc(d->branch_misses, sizeof(double) * d->capacity);
+        d->cache_misses = realloc(d->cache_misses, sizeof(double) * d->capacity);
+        d->status = realloc(d->status, sizeof(eval_status) * d->capacity);
         d->gens = realloc(d->gens, sizeof(int) * d->capacity);
     }
 }
 
+/*
+ * Estimate of the runtime of d with the configured estimator, over every runtime counted
+ * towards fitness, and its confidence interval in fitness_low and fitness_high. The default
+ * mean with an analytic interval comes from the running totals. Every other estimator reads
+ * all runtimes of d back through samples_read, the folded block first, from the spill file once
+ * they left memory, and sorts them, so each update costs O(n log n) in the runs of d plus the
+ * bootstrap resamples
+ */
+double node_estimate(DataNode* d) {
+    if (d->total_run == 0) {
+        d->fitness_low = 0.0;
+        d->fitness_high = UINT32_MAX;
+        return UINT32_MAX;
+    }
+    if (!node_reads_runs()) {
+        double estimate = d->total_time/d->total_run;
+        double half_width = runstats_t95(d->stats.count - 1) * sqrt(runstats_var(&d->stats) / d->stats.count);
+        d->fitness_low = d->stats.count < 2 || estimate - half_width < 0 ? 0.0 : estimate - half_width;
+        d->fitness_high = d->stats.count < 2 || estimate + half_width > UINT32_MAX ? UINT32_MAX : estimate + half_width;
+        return estimate;
+    }
+    double* runtimes = malloc(sizeof(double) * d->total_run);
+    samples_read(d->folded_at, d->folded_runs, runtimes);
+    int n = d->folded_runs;
+    for (int e = 0; e < d->num_eval - d->folded; e++) {
+        if (d->avg_time[e] != UINT32_MAX) {
+            samples_read(d->sample_at[e], d->success_cts[e], runtimes + n);
+            n += d->success_cts[e];
+        }
+    }
+    // seeded by the individual and its evaluations, a bootstrap interval does not change unless they do
+    double estimate = runstats_estimate(runtimes, n, &d->fitness_low, &d->fitness_high, ((uint64_t)d->seq_id << 32) | d->num_eval);
+    free(runtimes);
+    return estimate;
+}
+
 double node_update_fitness(DataNode* d, bool fitness_with_var) {
     //printf("inside node_update_fitness, d->num_eval=%d\n", d->num_eval);
-    int total_run = 0;
-    double total_time = 0.0;
-    double total_var = 0.0;
+    // node_add_runs keeps the totals over every evaluation
+    int total_run = d->total_run;
+    double total_var = d->total_var;
     double new_fitness = 0.0;
-    for (uint32_t i = 0; i < d->num_eval; i++) {
-        //printf("d->success_cts[%d]=%d, d->avg_time[%d]=%lf, d->var[%d]=%lf\n", i, d->success_cts[i], i, d->avg_time[i], i, d->var[i]);
-        if (d->avg_time[i] != UINT32_MAX) {
-            total_run += d->success_cts[i];
-            total_time += d->avg_time[i] * d->success_cts[i];
-            total_var += d->var[i];
-            //printf("total_run=%d, total_time=%lf, total_var=%lf\n", total_run, total_time, total_var);
-        }   
-    }
+    double estimate = node_estimate(d);
     //d->fitness = total_time/total_run + total_var/d->num_eval;
     if (fitness_with_var) {
         //d->fitness = total_run==0 ? UINT32_MAX : total_time/total_run + total_var/d->num_eval;
-        new_fitness = total_run==0 ? UINT32_MAX : total_time/total_run + total_var/d->num_eval;
+        new_fitness = total_run==0 ? UINT32_MAX : estimate + total_var/d->num_eval;
+        if (total_run != 0) {
+            d->fitness_low += total_var/d->num_eval;
+            d->fitness_high += d->fitness_high == UINT32_MAX ? 0 : total_var/d->num_eval;
+        }
     } else {
         //d->fitness = total_run==0 ? UINT32_MAX : total_time/total_run;
-        new_fitness = total_run==0 ? UINT32_MAX : total_time/total_run;
+        new_fitness = total_run==0 ? UINT32_MAX : estimate;
     }
     //printf("ID: %d, old fitness: %lf, new fitness: %lf, ", d->seq_id, d->fitness, new_fitness);
     /*if (d->fitness < 0 || new_fitness < d->fitness) {
@@ -97,46 +294,150 @@ double node_update_fitness(DataNode* d, bool fitness_with_var) {
     return d->fitness;
 }
 
+// what elites and tournaments compare, the upper end of the interval if intervals are compared
+double node_rank_value(DataNode* d) {
+    return estimator_settings.compare_intervals ? d->fitness_high : d->fitness;
+}
+
+void node_rank_values(DataNode** all_indiv, int* gen_id, uint32_t size, double* rank_values) {
+    for (uint32_t i = 0; i < size; i++) {
+        rank_values[i] = node_rank_value(all_indiv[gen_id[i]]);
+    }
+}
+
+// the individuals of gen are handed over to all_indiv, gen is left holding the registered sequences
 void node_add_group(node_str** gen, int* current_gen_id, uint32_t group_size, int* max_id_ptr, int* hash_cap_ptr, DataNode*** all_indiv_ptr) {
     //printf("\ninside node_add_group, max_id=%d\n", *max_id_ptr);
     for (int g = 0; g < group_size; g++) {
-        int new_allele_id = node_add(gen[g], max_id_ptr, hash_cap_ptr, all_indiv_ptr);
+        int new_allele_id = node_adopt(&gen[g], max_id_ptr, hash_cap_ptr, all_indiv_ptr);
         current_gen_id[g] = new_allele_id;
     }
 }
 
 int node_add(node_str* sequence, int* max_id_ptr, int* hash_cap_ptr, DataNode*** all_indiv_ptr) {
     //printf("before node_find,  max_id=%d\n", *max_id_ptr);
-    int new_allele_id = node_find(*all_indiv_ptr, *max_id_ptr, sequence);
+    // looking up and adding is one step, two threads adding the same offspring get the same id
+    pthread_mutex_lock(&node_index_lock);
+    int new_allele_id = node_index_find(*all_indiv_ptr, *max_id_ptr, sequence);
     if (new_allele_id < 0) {
         new_allele_id = (*max_id_ptr)++;
         node_add_indiv(sequence, new_allele_id, hash_cap_ptr, all_indiv_ptr);
         //printf("node added to all_indiv at position %d\n", new_allele_id);
     }
+    pthread_mutex_unlock(&node_index_lock);
     return new_allele_id;
 }
 
-int node_find(DataNode** all_indiv, int max_id, node_str* sequence) {
-    for (int i = 0; i < max_id; i++) {
-        if(all_indiv[i] == NULL) {
-            printf("WARNING: all_indiv[%d]==NULL\n", i);
+/*
+ * Same as node_add for a sequence the caller gives up: a new individual keeps the list
+ * instead of a copy, a known one frees it. *sequence_ptr is then the list held by all_indiv,
+ * which stays valid until free_all_nodes and must not be changed or freed
+ */
+int node_adopt(node_str** sequence_ptr, int* max_id_ptr, int* hash_cap_ptr, DataNode*** all_indiv_ptr) {
+    pthread_mutex_lock(&node_index_lock);
+    int new_allele_id = node_index_find(*all_indiv_ptr, *max_id_ptr, *sequence_ptr);
+    if (new_allele_id < 0) {
+        new_allele_id = (*max_id_ptr)++;
+        DataNode* new_indiv = node_wrap_allele(*sequence_ptr, new_allele_id);
+        node_check_overflow_array(new_allele_id, hash_cap_ptr, all_indiv_ptr);
+        (*all_indiv_ptr)[new_allele_id] = new_indiv;
+    } else {
+        generate_free_individual(*sequence_ptr);
+    }
+    *sequence_ptr = (*all_indiv_ptr)[new_allele_id]->seq;
+    pthread_mutex_unlock(&node_index_lock);
+    return new_allele_id;
+}
+
+/*
+ * Rolling hash of what osaka_compare looks at in each node: the object type, and the
+ * pass index of an LLVM_PASS node or the uid of a node of any other type, so every
+ * pair of sequences osaka_compare matches has the same hash
+ */
+static uint64_t node_hash(node_str* sequence) {
+    uint64_t hash = 14695981039346656037ULL;
+    for (node_str* n = sequence; n != NULL; n = NEXT(n)) {
+        uint64_t value = OBJECT_TYPE(n) == LLVM_PASS ? PASS_INDEX(((object_llvm_pass_str*)OBJECT(n))) : UID(n);
+        hash = (hash ^ OBJECT_TYPE(n)) * 1099511628211ULL;
+        hash = (hash ^ value) * 1099511628211ULL;
+    }
+    return hash;
+}
+
+static void node_index_insert(uint64_t hash, int id) {
+    uint32_t mask = node_index_capacity - 1;
+    uint32_t i = (uint32_t)hash & mask;
+    while (node_index[i].id != -1) {
+        i = (i + 1) & mask;
+    }
+    node_index[i].hash = hash;
+    node_index[i].id = id;
+}
+
+static void node_index_grow() {
+    NodeIndexSlot* old_index = node_index;
+    uint32_t old_capacity = node_index_capacity;
+    node_index_capacity = old_capacity == 0 ? NODE_INDEX_INITIAL_CAPACITY : old_capacity * 2;
+    node_index = malloc(sizeof(NodeIndexSlot) * node_index_capacity);
+    for (uint32_t i = 0; i < node_index_capacity; i++) {
+        node_index[i].id = -1;
+    }
+    for (uint32_t i = 0; i < old_capacity; i++) {
+        if (old_index[i].id != -1) {
+            node_index_insert(old_index[i].hash, old_index[i].id);
+        }
+    }
+    free(old_index);
+}
+
+/*
+ * Ids added to all_indiv since the last lookup, e.g. by a resumed checkpoint, are indexed first.
+ * The index follows one registry: looking up another one, or the same one after it was
+ * reallocated or cut back, builds it again from scratch
+ */
+static void node_index_sync(DataNode** all_indiv, int max_id) {
+    if (all_indiv != node_index_registry || max_id < node_index_count) {
+        for (uint32_t i = 0; i < node_index_capacity; i++) {
+            node_index[i].id = -1;
         }
-        else if(all_indiv[i]->seq == NULL) {
-            printf("WARNING: all_indiv[%d]->seq==NULL\n", i);
+        node_index_count = 0;
+        node_index_registry = all_indiv;
+    }
+    while (node_index_count < max_id) {
+        if ((uint32_t)(node_index_count + 1) * 2 > node_index_capacity) {
+            node_index_grow();
         }
-        if (node_match(all_indiv[i], sequence)) {
-            /*printf("\n\nFound match at individual #%d\n", i);
-            printf("\nall_indiv[%d]->seq: (max_id = %d)\n", i, max_id);
-            visualization_print_individual_concise_details(all_indiv[i]->seq);
-            printf("\nsequence:\n");
-            visualization_print_individual_concise_details(sequence);
-            printf("\n\n");*/
-            return i;
+        if (all_indiv[node_index_count] == NULL || all_indiv[node_index_count]->seq == NULL) {
+            printf("WARNING: all_indiv[%d] has no sequence\n", node_index_count);
+        } else {
+            node_index_insert(node_hash(all_indiv[node_index_count]->seq), node_index_count);
+        }
+        node_index_count++;
+    }
+}
+
+static int node_index_find(DataNode** all_indiv, int max_id, node_str* sequence) {
+    node_index_sync(all_indiv, max_id);
+    if (node_index_capacity == 0) {
+        return -1;
+    }
+    uint64_t hash = node_hash(sequence);
+    uint32_t mask = node_index_capacity - 1;
+    for (uint32_t i = (uint32_t)hash & mask; node_index[i].id != -1; i = (i + 1) & mask) {
+        if (node_index[i].hash == hash && node_match(all_indiv[node_index[i].id], sequence)) {
+            return node_index[i].id;
         }
     }
     return -1;
 }
 
+int node_find(DataNode** all_indiv, int max_id, node_str* sequence) {
+    pthread_mutex_lock(&node_index_lock);
+    int id = node_index_find(all_indiv, max_id, sequence);
+    pthread_mutex_unlock(&node_index_lock);
+    return id;
+}
+
 bool node_match(DataNode* d, node_str* sequence) {
     return d->seq? osaka_compare(d->seq, sequence) : false;
 }
@@ -154,21 +455,29 @@ void node_check_overflow_array(int new_indiv_id, int* hash_cap_ptr, DataNode***
             printf("reallocation failed inside generate_new_generation, exit\n");
         } else {
             *all_indiv_ptr = temp;
-            memset(*all_indiv_ptr + *hash_cap_ptr, 0, *hash_cap_ptr);
+            memset(*all_indiv_ptr + *hash_cap_ptr, 0, *hash_cap_ptr * sizeof(DataNode*));
         }
         (*hash_cap_ptr) *=2;
     }
 }
 
+// whether one of the evaluations of d that still has a row was taken in generation gen
+bool node_timed_in_gen(DataNode* d, int gen) {
+    for (int i = 0; i < d->num_eval - d->folded; i++) {
+        if (gen+1 == d->gens[i]) {
+            return true;
+        }
+    }
+    return false;
+}
+
 bool node_reeval_by_chance(DataNode* d, int gen) {
     //return true;
     if (d->num_eval == 0) {
         return true;
     }
-    for (int i = 0; i < d->num_eval; i++) {
-        if (gen+1 == d->gens[i]) {
-            return false;
-        }
+    if (node_timed_in_gen(d, gen)) {
+        return false;
     }
     int random_number = rand() % 100;
     return random_number < 25;
@@ -180,12 +489,29 @@ void node_increment_gen(DataNode* d) {
 
 void node_log(char* indiv_info_dir, char* file, DataNode* d) {
     FILE* file_ptr = fopen(file, "a");
-    for (int g = 0; g < d->num_eval; g++) {
-        fprintf(file_ptr, "%d,%d,%d,%d,%lf,%lf,%d,", d->seq_id, d->num_eval, d->tot_gen, d->gens[g], d->avg_time[g], d->var[g], d->success_cts[g]);
-        double* time_arr = d->time_arrs[g];
+    // the folded evaluations share one row, with generation 0 and the runtimes that are still kept
+    if (d->folded > 0) {
+        bool kept = node_reads_runs();
+        fprintf(file_ptr, "%d,%d,%d,0,folded,%lf,-1,0,0,0,-1,-1,-1,-1,%d,", d->seq_id, d->num_eval, d->tot_gen, d->folded_runs > 0 ? d->folded_time / d->folded_runs : UINT32_MAX, d->folded_runs);
+        double* time_arr = malloc(sizeof(double) * (kept && d->folded_runs > 0 ? d->folded_runs : 1));
+        samples_read(d->folded_at, kept ? d->folded_runs : 0, time_arr);
+        for (int r = 0; kept && r < d->folded_runs; r++) {
+            fprintf(file_ptr, "%lf%s", time_arr[r],(r<(d->folded_runs-1)?",":""));
+        }
+        fprintf(file_ptr, "\n");
+        free(time_arr);
+    }
+    for (int g = 0; g < d->num_eval - d->folded; g++) {
+        const char* status_names[] = {"ok", "compile_failed", "run_failed", "timeout", "filtered"};
+        fprintf(file_ptr, "%d,%d,%d,%d,%s,%lf,%lf,%lf,%lf,%ld,%.0lf,%.0lf,%.0lf,%.0lf,%d,", d->seq_id, d->num_eval, d->tot_gen, d->gens[g], status_names[d->status[g]], d->avg_time[g], d->var[g], d->utime[g], d->stime[g], d->maxrss[g], d->instructions[g], d->cycles[g], d->branch_misses[g], d->cache_misses[g], d->success_cts[g]);
+        double* time_arr = malloc(sizeof(double) * (d->success_cts[g] > 0 ? d->success_cts[g] : 1));
+        samples_read(d->sample_at[g], d->success_cts[g], time_arr);
         for (int r = 0; r < d->success_cts[g]; r++) {
-            fprintf(file_ptr, "%lf%s", d->time_arrs[g][r],(r<(d->success_cts[g]-1)?",":"\n"));
+            fprintf(file_ptr, "%lf%s", time_arr[r],(r<(d->success_cts[g]-1)?",":""));
         }
+        // evaluations without a successful run still end their row
+        fprintf(file_ptr, "\n");
+        free(time_arr);
         char cache_file[10000];
         strcpy(cache_file, indiv_info_dir);
         char id_num[100];
@@ -267,30 +593,45 @@ void node_cache_best(bool cache, char* main_folder, uint32_t gen, uint32_t pop_s
 }
 
 void node_print(DataNode* d, int id) {
-    for (int g = 0; g < d->num_eval; g++) {
+    for (int g = 0; g < d->num_eval - d->folded; g++) {
         printf("%d,%d,%d,%lf,%lf,%d,", id, d->tot_gen, d->gens[g], d->avg_time[g], d->var[g], d->success_cts[g]);
-        //double* time_arr = d->time_arrs[g];
+        double* time_arr = malloc(sizeof(double) * (d->success_cts[g] > 0 ? d->success_cts[g] : 1));
+        samples_read(d->sample_at[g], d->success_cts[g], time_arr);
         for (int r = 0; r < d->success_cts[g]; r++) {
-            printf("%lf%s", d->time_arrs[g][r],(r<(d->success_cts[g]-1)?",":"\n"));
+            printf("%lf%s", time_arr[r],(r<(d->success_cts[g]-1)?",":"\n"));
         }
+        free(time_arr);
     }
 
 }
 
 void free_node(DataNode* d) {
-    for (int i = 0; i < d->num_eval; i++) {
-        free(d->time_arrs[i]);
-    }
     generate_free_individual(d->seq);
-    free(d->time_arrs);
+    genome_free(d->genome);
+    free(d->sample_at);
     free(d->success_cts);
     free(d->avg_time);
     free(d->var);
+    free(d->utime);
+    free(d->stime);
+    free(d->maxrss);
+    free(d->instructions);
+    free(d->cycles);
+    free(d->branch_misses);
+    free(d->cache_misses);
+    free(d->status);
     free(d->gens);
     free(d);
 }
 
 void free_all_nodes(DataNode** all_indiv, int max_id) {
+    pthread_mutex_lock(&node_index_lock);
+    free(node_index);
+    node_index = NULL;
+    node_index_capacity = 0;
+    node_index_count = 0;
+    node_index_registry = NULL;
+    pthread_mutex_unlock(&node_index_lock);
     for (int i = 0; i < max_id; i++) {
         free_node(all_indiv[i]);
         //printf("Freed node #%d\n", i);
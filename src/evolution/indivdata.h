@@ -9,26 +9,65 @@
 #include "../support/visualization.h"
 #include "../support/utility.h"
 #include "generation.h"
+#include "genome.h"
+#include "runstats.h"
+#include "samples.h"
 
+#define NODE_MAX_ROWS 16        //Evaluations of an individual kept with their own row, the oldest half is folded into the totals when they are full
+
+typedef enum {
+    EVAL_OK,                //Enough runs succeeded
+    EVAL_COMPILE_FAILED,    //opt, llc or linking failed, nothing was run
+    EVAL_RUN_FAILED,        //Too many runs crashed or returned an error
+    EVAL_TIMEOUT,           //A run exceeded its timeout and was killed
+    EVAL_FILTERED           //The static proxy of the optimized module was clearly worse than the elites', or the surrogate model predicted it slow, nothing was run
+} eval_status;
 
 typedef struct DataNode {
-    struct node_str *seq;   //Osaka pass sequence
+    struct node_str *seq;   //Osaka pass sequence, shared by every population that contains the individual
+    Genome* genome;         //Flat form of seq, copies of the population for breeding share it
     int seq_len;            //Length of the Osaka structure
     int seq_id;             //Unique ID for the individual, starting at 0
     double fitness;         //Fitness for the individual
+    double fitness_low;     //95% confidence interval of the fitness, UINT32_MAX as high end before two runs are counted
+    double fitness_high;
+    double proxy;           //Static proxy score of the optimized module, lower is better, -1 until it is computed
     int num_eval;           //Number of times that this pass sequence is being run / num_runs
-    double** time_arrs;     //Runtime for every time the sequence is run, dimension: num_eval x num_runs(40)
-    int* success_cts;       //Number of success_runs for each evaluation, dimension: num_eval x 1
-    double* avg_time;       //Average runtime for each evaluation, dimension: num_eval x 1
-    double* var;            //Variance over num_runs(40) for each evaluation, dimension: num_eval x 1
-    int* gens;              //Generations that it's in, -1 if individual is produced but not selected
+    int learned;            //Evaluations the surrogate model has learned from, not checkpointed
+    int folded;             //Oldest evaluations that only count through the totals, row r of the arrays below holds evaluation folded + r
+    int folded_runs;        //Successful runs of the folded evaluations that count towards fitness
+    double folded_time;     //Sum of their runtimes
+    uint64_t folded_at;     //Position of their runtimes in the sample buffer, one block, only kept if the estimator reads runtimes back
+    uint64_t* sample_at;    //Position of the runtimes of each evaluation in the sample buffer, dimension: num_eval - folded x 1
+    int* success_cts;       //Number of success_runs for each evaluation, dimension: num_eval - folded x 1
+    double* avg_time;       //Average runtime for each evaluation, dimension: num_eval - folded x 1
+    double* var;            //Variance over num_runs(40) for each evaluation, dimension: num_eval - folded x 1
+    double* utime;          //Average user CPU time of the successful runs for each evaluation, dimension: num_eval - folded x 1
+    double* stime;          //Average system CPU time of the successful runs for each evaluation, dimension: num_eval - folded x 1
+    long* maxrss;           //Largest max RSS (KB) of the successful runs for each evaluation, dimension: num_eval - folded x 1
+    double* instructions;   //Average instructions retired per successful run for each evaluation, -1 if not counted, dimension: num_eval - folded x 1
+    double* cycles;         //Average CPU cycles per successful run for each evaluation, -1 if not counted, dimension: num_eval - folded x 1
+    double* branch_misses;  //Average branch misses per successful run for each evaluation, -1 if not counted, dimension: num_eval - folded x 1
+    double* cache_misses;   //Average cache misses per successful run for each evaluation, -1 if not counted, dimension: num_eval - folded x 1
+    eval_status* status;    //Outcome of each evaluation, dimension: num_eval - folded x 1
+    int* gens;              //Generation of each evaluation, dimension: num_eval - folded x 1
     int tot_gen;            //Total number of generations this individual appeared in
-    int capacity;           //Counter variable for allocating space for arrays
+    int capacity;           //Rows allocated in the arrays, at most NODE_MAX_ROWS
+    int total_run;          //Successful runs of the evaluations that count towards fitness (avg_time != UINT32_MAX)
+    double total_time;      //Sum of avg_time * success_cts over those evaluations
+    double total_var;       //Sum of var over those evaluations
+    RunStats stats;         //Mean and variance of every runtime of those evaluations
 } DataNode;
 
 DataNode* node_new_allele(node_str* seq, int id);
 double node_record_data(DataNode* d, node_str* sequence, double* all_runtime, double avg_runtime, int success_runs, int gen, bool fitness_with_var);
+void node_add_runs(DataNode* d, double* all_runtime);
+void node_record_usage(DataNode* d, double utime, double stime, long maxrss);
+void node_record_counters(DataNode* d, double instructions, double cycles, double branch_misses, double cache_misses);
+void node_record_status(DataNode* d, eval_status status);
 void node_check_overflow(DataNode* d);
+int node_last_row(DataNode* d);
+bool node_reads_runs();
 bool node_match(DataNode* d, node_str* sequence);
 int node_find(DataNode** all_indiv, int max_id, node_str* sequence);
 void node_increment_gen(DataNode* d);
@@ -37,12 +76,17 @@ void node_print(DataNode* d, int id);
 void node_add_new_generation(node_str** gen, uint32_t population_size, int* gen_id, int* max_id, int* hash_cap, DataNode*** all_indiv_ptr);
 void node_add_group(node_str** gen, int* current_gen_id, uint32_t group_size, int* max_id_ptr, int* hash_cap_ptr, DataNode*** all_indiv_ptr);
 int node_add(node_str* sequence, int* max_id_ptr, int* hash_cap_ptr, DataNode*** all_indiv_ptr);
+int node_adopt(node_str** sequence_ptr, int* max_id_ptr, int* hash_cap_ptr, DataNode*** all_indiv_ptr);
 void node_add_indiv(node_str* sequence, int new_indiv_id, int* hash_cap_ptr, DataNode*** all_indiv_ptr);
 int node_find_by_id(DataNode*** all_indiv_ptr, int* hash_cap_ptr, node_str* sequence, int new_indiv_id);
 void node_check_overflow_array(int new_indiv_id, int* hash_cap_ptr, DataNode*** all_indiv_ptr);
 double node_calculate_var(double* all_runtime, double avg_runtime, int success_runs);
+bool node_timed_in_gen(DataNode* d, int gen);
 bool node_reeval_by_chance(DataNode* d, int gen);
+double node_estimate(DataNode* d);
 double node_update_fitness(DataNode* d, bool fitness_with_var);
+double node_rank_value(DataNode* d);
+void node_rank_values(DataNode** all_indiv, int* gen_id, uint32_t size, double* rank_values);
 void node_cache_llvm_pass(char* file_name, node_str* indiv, double fitness, int unique_id);
 void node_cache_best(bool cache, char* main_folder, uint32_t gen, uint32_t pop_size, node_str** current_gen, double* fitness_values, int* current_gen_id, double* track_fitness);
 void free_node(DataNode* d);
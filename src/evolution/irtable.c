@@ -0,0 +1,160 @@
+#include <pthread.h>
+#include "irtable.h"
+
+#define IRTABLE_INITIAL_BUCKETS 256
+
+static IREntry** buckets = NULL;
+static uint32_t num_buckets = 0;
+static uint32_t num_entries = 0;
+static uint64_t hits = 0;          //Individuals that reused the runs of an identical module
+static uint64_t misses = 0;        //Individuals that were timed
+static uint64_t runs_saved = 0;    //Timed runs not needed because of hits
+static pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+
+/*
+ * FNV-1a over the whole file. Returns 0 and a size of -1 if the file cannot be read
+ */
+uint64_t irtable_hash_file(char* file, long* size) {
+
+    unsigned char chunk[65536];
+    uint64_t hash = 14695981039346656037ULL;
+    size_t n;
+
+    *size = -1;
+    FILE* file_ptr = fopen(file, "rb");
+    if (file_ptr == NULL) {
+        return 0;
+    }
+    *size = 0;
+    while ((n = fread(chunk, 1, sizeof(chunk), file_ptr)) > 0) {
+        for (size_t i = 0; i < n; i++) {
+            hash ^= chunk[i];
+            hash *= 1099511628211ULL;
+        }
+        *size += n;
+    }
+    fclose(file_ptr);
+    return hash;
+
+}
+
+static void irtable_grow() {
+
+    uint32_t new_num_buckets = num_buckets == 0 ? IRTABLE_INITIAL_BUCKETS : num_buckets * 2;
+    IREntry** new_buckets = calloc(new_num_buckets, sizeof(IREntry*));
+
+    for (uint32_t b = 0; b < num_buckets; b++) {
+        IREntry* e = buckets[b];
+        while (e != NULL) {
+            IREntry* next = e->next;
+            e->next = new_buckets[e->hash & (new_num_buckets - 1)];
+            new_buckets[e->hash & (new_num_buckets - 1)] = e;
+            e = next;
+        }
+    }
+    free(buckets);
+    buckets = new_buckets;
+    num_buckets = new_num_buckets;
+
+}
+
+/*
+ * Looks up the entry of a module, adding an empty one if the module was never seen.
+ * Safe to call from several compile workers at once
+ */
+IREntry* irtable_find_or_add(uint64_t hash, long size, bool* found) {
+
+    pthread_mutex_lock(&lock);
+    if (num_entries >= num_buckets) {
+        irtable_grow();
+    }
+    IREntry* e = buckets[hash & (num_buckets - 1)];
+    while (e != NULL && (e->hash != hash || e->size != size)) {
+        e = e->next;
+    }
+    *found = e != NULL;
+    if (e == NULL) {
+        e = malloc(sizeof(IREntry));
+        e->hash = hash;
+        e->size = size;
+        e->capacity = 64;
+        e->runtimes = malloc(sizeof(double) * e->capacity);
+        e->num_samples = 0;
+        e->measured = false;
+        e->status = EVAL_OK;
+        memset(&e->usage, 0, sizeof(LaunchResult));
+        e->next = buckets[hash & (num_buckets - 1)];
+        buckets[hash & (num_buckets - 1)] = e;
+        num_entries++;
+    }
+    pthread_mutex_unlock(&lock);
+    return e;
+
+}
+
+void irtable_add_samples(IREntry* e, double* runtimes, uint32_t success_runs, eval_status status, LaunchResult* usage) {
+
+    pthread_mutex_lock(&lock);
+    while (e->num_samples + success_runs > e->capacity) {
+        e->capacity *= 2;
+        e->runtimes = realloc(e->runtimes, sizeof(double) * e->capacity);
+    }
+    memcpy(e->runtimes + e->num_samples, runtimes, sizeof(double) * success_runs);
+    e->num_samples += success_runs;
+    e->measured = true;
+    e->status = status;
+    e->usage = *usage;
+    pthread_mutex_unlock(&lock);
+
+}
+
+/*
+ * Copies the most recent runs of a module, at most num_runs of them.
+ * Returns the number of runs copied
+ */
+uint32_t irtable_get_samples(IREntry* e, double* runtimes, uint32_t num_runs) {
+
+    pthread_mutex_lock(&lock);
+    uint32_t n = e->num_samples < num_runs ? e->num_samples : num_runs;
+    memcpy(runtimes, e->runtimes + e->num_samples - n, sizeof(double) * n);
+    pthread_mutex_unlock(&lock);
+    return n;
+
+}
+
+void irtable_count(bool hit, uint32_t num_runs) {
+
+    pthread_mutex_lock(&lock);
+    if (hit) {
+        hits++;
+        runs_saved += num_runs;
+    } else {
+        misses++;
+    }
+    pthread_mutex_unlock(&lock);
+
+}
+
+void irtable_print_stats() {
+
+    printf("Optimized module reuse: %lu hits, %lu misses, %u distinct modules, %lu timed runs saved\n", (unsigned long)hits, (unsigned long)misses, num_entries, (unsigned long)runs_saved);
+
+}
+
+void irtable_free() {
+
+    for (uint32_t b = 0; b < num_buckets; b++) {
+        IREntry* e = buckets[b];
+        while (e != NULL) {
+            IREntry* next = e->next;
+            free(e->runtimes);
+            free(e);
+            e = next;
+        }
+    }
+    free(buckets);
+    buckets = NULL;
+    num_buckets = 0;
+    num_entries = 0;
+
+}
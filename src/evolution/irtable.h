@@ -0,0 +1,36 @@
+#ifndef EVOLUTION_IRTABLE_H_
+#define EVOLUTION_IRTABLE_H_
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include "../support/launcher.h"
+#include "indivdata.h"
+
+/*
+ * Measurements of one optimized module, shared by every pass sequence that
+ * produces a byte-identical module
+ */
+typedef struct IREntry {
+    uint64_t hash;              //FNV-1a hash of the optimized module
+    long size;                  //Size of the optimized module in bytes, guards against hash collisions
+    double* runtimes;           //Every successful run timed for this module so far
+    int num_samples;
+    int capacity;
+    bool measured;              //False until the first timed runs of the module are added
+    eval_status status;         //Outcome of the last timed runs of the module
+    LaunchResult usage;         //CPU times and max RSS of the last timed runs
+    struct IREntry* next;       //Next entry in the same bucket
+} IREntry;
+
+uint64_t irtable_hash_file(char* file, long* size);
+IREntry* irtable_find_or_add(uint64_t hash, long size, bool* found);
+void irtable_add_samples(IREntry* e, double* runtimes, uint32_t success_runs, eval_status status, LaunchResult* usage);
+uint32_t irtable_get_samples(IREntry* e, double* runtimes, uint32_t num_runs);
+void irtable_count(bool hit, uint32_t num_runs);
+void irtable_print_stats();
+void irtable_free();
+
+#endif /* EVOLUTION_IRTABLE_H_ */
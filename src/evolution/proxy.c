@@ -0,0 +1,295 @@
+#include <unistd.h>
+#include "proxy.h"
+#include "../support/llvm.h"
+
+#define PROXY_CALL_WEIGHT 4         //Instructions a call is taken to cost
+#define PROXY_LOOP_WEIGHT 10        //Iterations assumed for every instruction inside a loop
+#define PROXY_MCA_ITERATIONS 100
+
+/*
+ * Blocks of the function that is being read, open addressing from the hash of
+ * the block name to the number of instructions before the block
+ */
+typedef struct ProxyBlocks {
+    uint64_t* hash;                 //0 for a free slot
+    uint32_t* at;
+    uint32_t capacity;
+    uint32_t count;
+} ProxyBlocks;
+
+static uint64_t proxy_hash(const char* name, size_t len) {
+
+    uint64_t hash = 14695981039346656037ULL;
+
+    for (size_t i = 0; i < len; i++) {
+        hash ^= (unsigned char)name[i];
+        hash *= 1099511628211ULL;
+    }
+    return hash == 0 ? 1 : hash;
+
+}
+
+static void proxy_blocks_add(ProxyBlocks* blocks, uint64_t hash, uint32_t at);
+
+static void proxy_blocks_grow(ProxyBlocks* blocks) {
+
+    ProxyBlocks old = *blocks;
+
+    blocks->capacity = old.capacity == 0 ? 256 : old.capacity * 2;
+    blocks->hash = calloc(blocks->capacity, sizeof(uint64_t));
+    blocks->at = malloc(sizeof(uint32_t) * blocks->capacity);
+    blocks->count = 0;
+    for (uint32_t i = 0; i < old.capacity; i++) {
+        if (old.hash[i] != 0) {
+            proxy_blocks_add(blocks, old.hash[i], old.at[i]);
+        }
+    }
+    free(old.hash);
+    free(old.at);
+
+}
+
+static void proxy_blocks_add(ProxyBlocks* blocks, uint64_t hash, uint32_t at) {
+
+    if ((blocks->count + 1) * 2 > blocks->capacity) {
+        proxy_blocks_grow(blocks);
+    }
+    uint32_t i = hash % blocks->capacity;
+    while (blocks->hash[i] != 0 && blocks->hash[i] != hash) {
+        i = (i + 1) % blocks->capacity;
+    }
+    blocks->count += blocks->hash[i] == 0;
+    blocks->hash[i] = hash;
+    blocks->at[i] = at;
+
+}
+
+// instructions before the block, -1 if the block was not seen yet
+static int64_t proxy_blocks_find(ProxyBlocks* blocks, uint64_t hash) {
+
+    if (blocks->capacity == 0) {
+        return -1;
+    }
+    uint32_t i = hash % blocks->capacity;
+    while (blocks->hash[i] != 0) {
+        if (blocks->hash[i] == hash) {
+            return blocks->at[i];
+        }
+        i = (i + 1) % blocks->capacity;
+    }
+    return -1;
+
+}
+
+static void proxy_blocks_clear(ProxyBlocks* blocks) {
+
+    if (blocks->capacity > 0) {
+        memset(blocks->hash, 0, sizeof(uint64_t) * blocks->capacity);
+    }
+    blocks->count = 0;
+
+}
+
+/*
+ * Whether a line of a function body starts a block, both as "name:" and as the
+ * "; <label>:name:" of older LLVM versions
+ */
+static bool proxy_block_label(char* line, uint64_t* hash) {
+
+    char* name = line;
+
+    if (strncmp(line, "; <label>:", 10) == 0) {
+        name = line + 10;
+    } else if (line[0] == ' ' || line[0] == ';' || line[0] == '}' || line[0] == '\n' || line[0] == 0) {
+        return false;
+    }
+    char* end = strchr(name, ':');
+    if (end == NULL) {
+        return false;
+    }
+    *hash = proxy_hash(name, end - name);
+    return true;
+
+}
+
+/*
+ * Rewrites the assembly llc wrote into code regions of llvm-mca, named loop for
+ * every run of blocks llc marks as part of a loop and straight for the others
+ */
+static bool proxy_mark_regions(char* asm_file, char* region_file) {
+
+    FILE* in = fopen(asm_file, "r");
+    FILE* out = in == NULL ? NULL : fopen(region_file, "w");
+    char* line = NULL;
+    size_t size = 0;
+    const char* region = NULL;      //Kind of the open region, NULL outside of one
+
+    if (out == NULL) {
+        if (in != NULL) {
+            fclose(in);
+        }
+        return false;
+    }
+    while (getline(&line, &size, in) != -1) {
+        bool block = strncmp(line, ".LBB", 4) == 0 || strncmp(line, "# %bb", 5) == 0;
+        const char* kind = !block ? region : strstr(line, "Loop") != NULL ? "loop" : "straight";
+        if (region != NULL && (kind != region || strncmp(line, ".Lfunc_end", 10) == 0)) {
+            fprintf(out, "# LLVM-MCA-END %s\n", region);
+            region = NULL;
+        }
+        if (region == NULL && block) {
+            fprintf(out, "# LLVM-MCA-BEGIN %s\n", kind);
+            region = kind;
+        }
+        fputs(line, out);
+    }
+    if (region != NULL) {
+        fprintf(out, "# LLVM-MCA-END %s\n", region);
+    }
+    free(line);
+    fclose(in);
+    return fclose(out) == 0;
+
+}
+
+/*
+ * Cycles llvm-mca predicts for the module, with the cycles of its loops counted
+ * as often as a loop is assumed to run
+ */
+static bool proxy_mca(char* ll_file, double* cycles) {
+
+    char asm_file[300];
+    char region_file[300];
+    char command[1000];
+    char* line = NULL;
+    size_t size = 0;
+    int regions = 0;
+
+    strcpy(asm_file, ll_file);
+    strcat(asm_file, ".s");
+    strcpy(region_file, ll_file);
+    strcat(region_file, ".mca.s");
+    sprintf(command, "llc -O2 %s -o %s 2>/dev/null", ll_file, asm_file);
+    bool ok = llvm_run_command(command) == 0 && proxy_mark_regions(asm_file, region_file);
+
+    *cycles = 0.0;
+    if (ok) {
+        sprintf(command, "llvm-mca -iterations=%d %s 2>/dev/null", PROXY_MCA_ITERATIONS, region_file);
+        FILE* mca = popen(command, "r");
+        double c;
+        bool loop = false;
+        ok = mca != NULL;
+        while (ok && getline(&line, &size, mca) != -1) {
+            if (strstr(line, "Code Region - ") != NULL) {
+                loop = strstr(line, "Code Region - loop") != NULL;
+            } else if (sscanf(line, "Total Cycles: %lf", &c) == 1) {
+                *cycles += loop ? PROXY_LOOP_WEIGHT * c : c;
+                regions++;
+            }
+        }
+        ok = ok && pclose(mca) == 0 && regions > 0;
+    }
+    free(line);
+    unlink(asm_file);
+    unlink(region_file);
+    return ok;
+
+}
+
+/*
+ * Reads the static signals of an optimized textual module. With mca the loops are
+ * also compiled with llc and their throughput predicted by llvm-mca. Returns false
+ * if the module cannot be read, bitcode included, or llvm-mca gives no prediction
+ */
+bool proxy_measure(char* ll_file, bool mca, ProxyStats* stats) {
+
+    size_t len = strlen(ll_file);
+    ProxyBlocks blocks = {NULL, NULL, 0, 0};
+    char* line = NULL;
+    size_t size = 0;
+    bool in_function = false;
+    uint32_t function_instructions = 0;
+
+    memset(stats, 0, sizeof(ProxyStats));
+    stats->mca_cycles = -1;
+    if (len < 3 || strcmp(ll_file + len - 3, ".ll") != 0) {
+        return false;
+    }
+    FILE* f = fopen(ll_file, "r");
+    if (f == NULL) {
+        return false;
+    }
+
+    while (getline(&line, &size, f) != -1) {
+        uint64_t hash;
+        if (strncmp(line, "define ", 7) == 0) {
+            in_function = true;
+            function_instructions = 0;
+            proxy_blocks_clear(&blocks);
+            continue;
+        }
+        if (!in_function) {
+            continue;
+        }
+        if (line[0] == '}') {
+            in_function = false;
+            continue;
+        }
+        if (proxy_block_label(line, &hash)) {
+            proxy_blocks_add(&blocks, hash, function_instructions);
+            continue;
+        }
+        // instructions are indented by two spaces, deeper lines continue a switch
+        if (line[0] != ' ' || line[1] != ' ' || line[2] == ' ' || line[2] == ';' || line[2] == '\n') {
+            continue;
+        }
+        char* t = line + 2;
+        stats->instructions++;
+        function_instructions++;
+        if (strncmp(t, "call ", 5) == 0 || strstr(t, " call ") != NULL || strstr(t, "invoke ") != NULL) {
+            stats->calls++;
+        }
+        if (strncmp(t, "store ", 6) == 0 || strstr(t, "= load ") != NULL) {
+            stats->memory++;
+        }
+        if (strncmp(t, "br ", 3) != 0) {
+            continue;
+        }
+        stats->branches++;
+        // a branch back to a block seen before closes a loop
+        for (char* target = strstr(t, "label %"); target != NULL; target = strstr(target, "label %")) {
+            target += 7;
+            size_t n = strcspn(target, ", \n");
+            int64_t at = proxy_blocks_find(&blocks, proxy_hash(target, n));
+            if (at >= 0) {
+                stats->loops++;
+                stats->loop_instructions += function_instructions - (uint32_t)at;
+            }
+        }
+    }
+    free(line);
+    free(blocks.hash);
+    free(blocks.at);
+    fclose(f);
+
+    // a score without llvm-mca would not compare with the ones that have it
+    if (mca && !proxy_mca(ll_file, &stats->mca_cycles)) {
+        stats->mca_cycles = -1;
+        return false;
+    }
+    return true;
+
+}
+
+/*
+ * Lower is better, like a runtime. The prediction of llvm-mca when there is one,
+ * otherwise the instructions weighted by how often they are likely to run
+ */
+double proxy_score(ProxyStats* stats) {
+
+    if (stats->mca_cycles >= 0) {
+        return stats->mca_cycles;
+    }
+    return stats->instructions + stats->memory + PROXY_CALL_WEIGHT * stats->calls + PROXY_LOOP_WEIGHT * (double)stats->loop_instructions;
+
+}
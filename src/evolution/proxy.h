@@ -0,0 +1,28 @@
+#ifndef EVOLUTION_PROXY_H_
+#define EVOLUTION_PROXY_H_
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdbool.h>
+
+/*
+ * Static signals of an optimized module that are cheap next to timing it, in
+ * the spirit of opt -instcount. Loops are found as back edges, branches to a
+ * block that comes earlier in the same function
+ */
+typedef struct ProxyStats {
+    uint32_t instructions;          //Instructions in function bodies
+    uint32_t calls;                 //Calls and invokes
+    uint32_t memory;                //Loads and stores
+    uint32_t branches;
+    uint32_t loops;                 //Back edges
+    uint32_t loop_instructions;     //Instructions from each back edge's target up to the back edge, once per nesting level
+    double mca_cycles;              //Cycles llvm-mca predicts for 100 iterations of every loop, -1 if it was not run
+} ProxyStats;
+
+bool proxy_measure(char* ll_file, bool mca, ProxyStats* stats);
+double proxy_score(ProxyStats* stats);
+
+#endif /* EVOLUTION_PROXY_H_ */
@@ -0,0 +1,189 @@
+#include <math.h>
+#include "runstats.h"
+
+EstimatorSettings estimator_settings = {.estimator = ESTIMATOR_MEAN, .trim = 0.1, .min_of = 5,
+                                        .interval = INTERVAL_ANALYTIC, .resamples = 200, .compare_intervals = false};
+
+// two-sided 95% quantile of the t distribution, the normal one beyond 30 degrees of freedom
+double runstats_t95(uint32_t df) {
+
+    const double t95[30] = {12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+                            2.201, 2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086,
+                            2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042};
+    return df == 0 ? INFINITY : df <= 30 ? t95[df - 1] : 1.960;
+
+}
+
+void runstats_init(RunStats* s) {
+
+    s->count = 0;
+    s->mean = 0.0;
+    s->m2 = 0.0;
+
+}
+
+void runstats_add(RunStats* s, double x) {
+
+    s->count++;
+    double delta = x - s->mean;
+    s->mean += delta / s->count;
+    s->m2 += delta * (x - s->mean);
+
+}
+
+// sample variance, 0 for fewer than two runtimes
+double runstats_var(RunStats* s) {
+
+    return s->count > 1 ? s->m2 / (s->count - 1) : 0.0;
+
+}
+
+static int runstats_compare(const void* a, const void* b) {
+
+    double x = *(const double*)a;
+    double y = *(const double*)b;
+    return (x > y) - (x < y);
+
+}
+
+// mean and half-width of the t interval of values, the half-width has no bound for a single value
+static double runstats_mean_interval(double* values, uint32_t n, double* half_width) {
+
+    RunStats stats;
+
+    runstats_init(&stats);
+    for (uint32_t i = 0; i < n; i++) {
+        runstats_add(&stats, values[i]);
+    }
+    *half_width = n > 1 ? runstats_t95(n - 1) * sqrt(runstats_var(&stats) / n) : INFINITY;
+    return stats.mean;
+
+}
+
+/*
+ * Point estimate of the configured estimator. sorted is runtimes in increasing order,
+ * ESTIMATOR_MIN_OF groups the runtimes in the order they were taken. With interval
+ * set, the analytic 95% interval is written to low and high
+ */
+static double runstats_point(double* runtimes, double* sorted, uint32_t n, bool interval, double* low, double* high) {
+
+    double half_width = 0.0;
+    double estimate;
+
+    switch (estimator_settings.estimator) {
+        case ESTIMATOR_MEDIAN: {
+            estimate = n % 2 == 1 ? sorted[n / 2] : (sorted[n / 2 - 1] + sorted[n / 2]) / 2;
+            if (interval) {
+                // ranks of the distribution-free interval of the median, counting from 0
+                double spread = 1.96 * sqrt(n) / 2;
+                int lo = (int)floor(n / 2.0 - spread) - 1;
+                int hi = (int)ceil(n / 2.0 + spread);
+                *low = sorted[lo < 0 ? 0 : lo];
+                *high = sorted[hi >= (int)n ? (int)n - 1 : hi];
+            }
+            return estimate;
+        }
+        case ESTIMATOR_TRIMMED: {
+            uint32_t g = (uint32_t)(estimator_settings.trim * n);
+            if (2 * g >= n) {
+                g = (n - 1) / 2;
+            }
+            uint32_t h = n - 2 * g;
+            estimate = 0.0;
+            for (uint32_t i = g; i < n - g; i++) {
+                estimate += sorted[i];
+            }
+            estimate /= h;
+            if (interval) {
+                // Yuen's standard error from the winsorized variance
+                RunStats stats;
+                runstats_init(&stats);
+                for (uint32_t i = 0; i < n; i++) {
+                    runstats_add(&stats, i < g ? sorted[g] : i >= n - g ? sorted[n - g - 1] : sorted[i]);
+                }
+                half_width = h > 1 ? runstats_t95(h - 1) * sqrt((n - 1) * runstats_var(&stats) / ((double)h * (h - 1))) : INFINITY;
+            }
+            break;
+        }
+        case ESTIMATOR_MIN_OF: {
+            uint32_t k = estimator_settings.min_of > 0 ? estimator_settings.min_of : 1;
+            uint32_t m = (n + k - 1) / k;
+            double* minima = malloc(sizeof(double) * m);
+            for (uint32_t j = 0; j < m; j++) {
+                minima[j] = runtimes[j * k];
+                for (uint32_t i = j * k + 1; i < n && i < (j + 1) * k; i++) {
+                    minima[j] = runtimes[i] < minima[j] ? runtimes[i] : minima[j];
+                }
+            }
+            estimate = runstats_mean_interval(minima, m, &half_width);
+            free(minima);
+            break;
+        }
+        default:
+            estimate = runstats_mean_interval(runtimes, n, &half_width);
+            break;
+    }
+    if (interval) {
+        *low = estimate - half_width;
+        *high = estimate + half_width;
+    }
+    return estimate;
+
+}
+
+// xorshift64*, the resamples must not move rand() and with it the evolution
+static uint64_t runstats_random(uint64_t* state) {
+
+    *state ^= *state >> 12;
+    *state ^= *state << 25;
+    *state ^= *state >> 27;
+    return *state * 2685821657736338717ULL;
+
+}
+
+/*
+ * Estimate of the runtime from n runtimes with the configured estimator, and its 95%
+ * confidence interval in low and high. The same seed gives the same bootstrap interval.
+ * Fewer than two runtimes give an interval up to UINT32_MAX, the fitness of a failed individual
+ */
+double runstats_estimate(double* runtimes, uint32_t n, double* low, double* high, uint64_t seed) {
+
+    if (n == 0) {
+        *low = 0.0;
+        *high = UINT32_MAX;
+        return UINT32_MAX;
+    }
+    double* sorted = malloc(sizeof(double) * n);
+    memcpy(sorted, runtimes, sizeof(double) * n);
+    qsort(sorted, n, sizeof(double), runstats_compare);
+    bool analytic = estimator_settings.interval == INTERVAL_ANALYTIC;
+    double estimate = runstats_point(runtimes, sorted, n, analytic, low, high);
+
+    if (n < 2) {
+        *low = 0.0;
+        *high = UINT32_MAX;
+    } else if (!analytic) {
+        uint32_t b = estimator_settings.resamples > 0 ? estimator_settings.resamples : 1;
+        double* estimates = malloc(sizeof(double) * b);
+        double* resample = malloc(sizeof(double) * n);
+        uint64_t state = seed * 0x9e3779b97f4a7c15ULL + 1;
+        for (uint32_t r = 0; r < b; r++) {
+            for (uint32_t i = 0; i < n; i++) {
+                resample[i] = runtimes[runstats_random(&state) % n];
+            }
+            memcpy(sorted, resample, sizeof(double) * n);
+            qsort(sorted, n, sizeof(double), runstats_compare);
+            estimates[r] = runstats_point(resample, sorted, n, false, NULL, NULL);
+        }
+        qsort(estimates, b, sizeof(double), runstats_compare);
+        *low = estimates[(uint32_t)(0.025 * b)];
+        *high = estimates[(uint32_t)ceil(0.975 * b) - 1];
+        free(estimates);
+        free(resample);
+    }
+    *low = *low < 0.0 ? 0.0 : *low;
+    *high = *high > UINT32_MAX ? UINT32_MAX : *high;
+    free(sorted);
+    return estimate;
+
+}
@@ -0,0 +1,53 @@
+#ifndef EVOLUTION_RUNSTATS_H_
+#define EVOLUTION_RUNSTATS_H_
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdbool.h>
+
+typedef enum {
+    ESTIMATOR_MEAN,             //mean of every runtime
+    ESTIMATOR_MEDIAN,           //median of every runtime
+    ESTIMATOR_TRIMMED,          //mean of the runtimes left after trimming both ends
+    ESTIMATOR_MIN_OF            //mean of the fastest runtime of each group of consecutive runs
+} fitness_estimator;
+
+typedef enum {
+    INTERVAL_ANALYTIC,          //from the spread of the runtimes, Student t or order statistics
+    INTERVAL_BOOTSTRAP          //percentiles of the estimate over resampled runtimes
+} interval_method;
+
+/*
+ * How the runtimes of an individual are turned into its fitness and the 95%
+ * confidence interval of that fitness
+ */
+typedef struct EstimatorSettings {
+    fitness_estimator estimator;
+    double trim;                //Fraction of the runtimes trimmed from each end by ESTIMATOR_TRIMMED
+    uint32_t min_of;            //Runs per group of ESTIMATOR_MIN_OF
+    interval_method interval;
+    uint32_t resamples;         //Resamples of INTERVAL_BOOTSTRAP
+    bool compare_intervals;     //Whether elites and tournaments rank individuals by the upper end of their interval
+} EstimatorSettings;
+
+extern EstimatorSettings estimator_settings;
+
+/*
+ * Count, mean and sum of squared deviations of a stream of runtimes, updated
+ * one runtime at a time (Welford)
+ */
+typedef struct RunStats {
+    uint32_t count;
+    double mean;
+    double m2;                  //Sum of squared deviations from the mean
+} RunStats;
+
+double runstats_t95(uint32_t df);
+double runstats_estimate(double* runtimes, uint32_t n, double* low, double* high, uint64_t seed);
+void runstats_init(RunStats* s);
+void runstats_add(RunStats* s, double x);
+double runstats_var(RunStats* s);
+
+#endif /* EVOLUTION_RUNSTATS_H_ */
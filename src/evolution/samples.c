@@ -0,0 +1,274 @@
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
+#include "samples.h"
+
+#define SAMPLES_SEGMENT 8192        //Runtimes per segment, 64 KB
+#define SAMPLES_FILE "/samples.bin"
+
+SampleSettings sample_settings = {.memory_mb = 64};
+
+// every runtime ever recorded in one append-only array of fixed size segments, the
+// runtime at position i of the array is at byte 8*i of the spill file once written out
+static double** segments = NULL;            //NULL for segments that are only in the spill file
+static uint64_t* last_used = NULL;          //Value of use_clock when each segment was last appended to or read
+static uint32_t* in_file = NULL;            //Runtimes at the start of each segment that are already in the spill file
+static uint64_t segments_capacity = 0;
+static uint64_t length = 0;                 //Runtimes appended so far
+static uint64_t resident = 0;               //Segments in memory
+static uint64_t spilled = 0;                //Segments in the spill file
+static uint64_t use_clock = 0;
+static int spill_fd = -1;
+static bool spilling = false;               //Cleared if the spill file cannot be written, what is in it can still be read
+static bool kept = false;                   //Whether a checkpoint refers to the spill file, it is then not removed
+static char spill_file[300] = "";
+static pthread_mutex_t samples_lock = PTHREAD_MUTEX_INITIALIZER;
+
+// makes room for segment s in the arrays over the segments
+static void samples_reserve(uint64_t s) {
+
+    if (s >= segments_capacity) {
+        uint64_t capacity = segments_capacity == 0 ? 64 : segments_capacity;
+        while (capacity <= s) {
+            capacity *= 2;
+        }
+        segments = realloc(segments, sizeof(double*) * capacity);
+        last_used = realloc(last_used, sizeof(uint64_t) * capacity);
+        in_file = realloc(in_file, sizeof(uint32_t) * capacity);
+        memset(segments + segments_capacity, 0, sizeof(double*) * (capacity - segments_capacity));
+        memset(last_used + segments_capacity, 0, sizeof(uint64_t) * (capacity - segments_capacity));
+        memset(in_file + segments_capacity, 0, sizeof(uint32_t) * (capacity - segments_capacity));
+        segments_capacity = capacity;
+    }
+
+}
+
+static double* samples_segment(uint64_t s) {
+
+    samples_reserve(s);
+    if (segments[s] == NULL) {
+        segments[s] = malloc(sizeof(double) * SAMPLES_SEGMENT);
+        if (segments[s] == NULL) {
+            printf("error: failed to alloc memory for runtimes\n\nAborting code\n\n");
+            exit(0);
+        }
+        resident++;
+    }
+    last_used[s] = ++use_clock;
+    return segments[s];
+
+}
+
+// writes the part of segment s that is not in the spill file yet, up to runtime end of the segment
+static bool samples_write_segment(uint64_t s, uint32_t end) {
+
+    size_t size = sizeof(double) * (end - in_file[s]);
+    off_t at = (off_t)(sizeof(double) * (s * SAMPLES_SEGMENT + in_file[s]));
+    if (end > in_file[s] && pwrite(spill_fd, segments[s] + in_file[s], size, at) != (ssize_t)size) {
+        return false;
+    }
+    in_file[s] = end;
+    return true;
+
+}
+
+/*
+ * Writes the full segments that were least recently appended to or read out until
+ * the rest fits in memory_mb. Every fitness update of a re-evaluated individual reads
+ * its runtimes, so the segments of individuals that are still timed stay in memory,
+ * and those of individuals that dropped out of the population go to the spill file.
+ * The segment that is being filled always stays in memory. A full segment does not
+ * change anymore, so it is written once and read from the file from then on
+ */
+static void samples_spill() {
+
+    if (!spilling || sample_settings.memory_mb == 0 || length == 0) {
+        return;
+    }
+    uint64_t max_resident = (uint64_t)sample_settings.memory_mb * 1024 * 1024 / (sizeof(double) * SAMPLES_SEGMENT);
+    uint64_t last = (length - 1) / SAMPLES_SEGMENT;
+    if (max_resident == 0) {
+        max_resident = 1;
+    }
+    while (resident > max_resident) {
+        uint64_t coldest = last;
+        for (uint64_t s = 0; s < last; s++) {
+            if (segments[s] != NULL && (coldest == last || last_used[s] < last_used[coldest])) {
+                coldest = s;
+            }
+        }
+        if (coldest == last) {
+            return;
+        }
+        if (!samples_write_segment(coldest, SAMPLES_SEGMENT)) {
+            printf("WARNING: could not write runtimes to %s, keeping them in memory\n", spill_file);
+            spilling = false;
+            return;
+        }
+        free(segments[coldest]);
+        segments[coldest] = NULL;
+        resident--;
+        spilled++;
+    }
+
+}
+
+/*
+ * Lets runtimes beyond memory_mb be written to the run folder. Without a run
+ * folder every runtime stays in memory
+ */
+void samples_open(char* main_folder) {
+
+    pthread_mutex_lock(&samples_lock);
+    strcpy(spill_file, main_folder);
+    strcat(spill_file, SAMPLES_FILE);
+    spill_fd = open(spill_file, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    spilling = spill_fd >= 0;
+    if (!spilling) {
+        printf("WARNING: could not open %s, keeping every runtime in memory\n", spill_file);
+    }
+    samples_spill();
+    pthread_mutex_unlock(&samples_lock);
+
+}
+
+/*
+ * Continues with the spill file of a checkpointed run, cut back to the first n runtimes.
+ * They stay in the file, only the segment that is being filled is read back into memory
+ */
+bool samples_resume(char* main_folder, uint64_t n) {
+
+    pthread_mutex_lock(&samples_lock);
+    strcpy(spill_file, main_folder);
+    strcat(spill_file, SAMPLES_FILE);
+    spill_fd = open(spill_file, O_RDWR);
+    bool ok = spill_fd >= 0 && lseek(spill_fd, 0, SEEK_END) >= (off_t)(sizeof(double) * n) && ftruncate(spill_fd, (off_t)(sizeof(double) * n)) == 0;
+    if (ok) {
+        length = n;
+        spilled = n / SAMPLES_SEGMENT;
+        samples_reserve(spilled);
+        for (uint64_t s = 0; s < spilled; s++) {
+            in_file[s] = SAMPLES_SEGMENT;
+        }
+        uint32_t tail = n % SAMPLES_SEGMENT;
+        if (tail > 0) {
+            double* segment = samples_segment(spilled);
+            ok = pread(spill_fd, segment, sizeof(double) * tail, (off_t)(sizeof(double) * spilled * SAMPLES_SEGMENT)) == (ssize_t)(sizeof(double) * tail);
+            in_file[spilled] = tail;
+        }
+    }
+    spilling = ok;
+    kept = ok;
+    pthread_mutex_unlock(&samples_lock);
+    return ok;
+
+}
+
+// returns the position of the first of the n runtimes, they are read back with it
+uint64_t samples_append(double* runtimes, uint32_t n) {
+
+    pthread_mutex_lock(&samples_lock);
+    uint64_t at = length;
+    while (n > 0) {
+        uint64_t offset = length % SAMPLES_SEGMENT;
+        uint32_t take = SAMPLES_SEGMENT - offset < n ? SAMPLES_SEGMENT - offset : n;
+        memcpy(samples_segment(length / SAMPLES_SEGMENT) + offset, runtimes, sizeof(double) * take);
+        runtimes += take;
+        length += take;
+        n -= take;
+    }
+    samples_spill();
+    pthread_mutex_unlock(&samples_lock);
+    return at;
+
+}
+
+void samples_read(uint64_t at, uint32_t n, double* runtimes) {
+
+    pthread_mutex_lock(&samples_lock);
+    while (n > 0) {
+        uint64_t s = at / SAMPLES_SEGMENT;
+        uint64_t offset = at % SAMPLES_SEGMENT;
+        uint32_t take = SAMPLES_SEGMENT - offset < n ? SAMPLES_SEGMENT - offset : n;
+        if (segments[s] != NULL) {
+            memcpy(runtimes, segments[s] + offset, sizeof(double) * take);
+            last_used[s] = ++use_clock;
+        } else if (pread(spill_fd, runtimes, sizeof(double) * take, (off_t)(at * sizeof(double))) != (ssize_t)(sizeof(double) * take)) {
+            printf("error: could not read runtimes back from %s\n\nAborting code\n\n", spill_file);
+            exit(0);
+        }
+        runtimes += take;
+        at += take;
+        n -= take;
+    }
+    pthread_mutex_unlock(&samples_lock);
+
+}
+
+/*
+ * Writes every runtime that is only in memory to the spill file and syncs it, so a
+ * checkpoint can refer to runtimes by their position. The file is kept from then on
+ */
+bool samples_flush() {
+
+    pthread_mutex_lock(&samples_lock);
+    bool ok = spill_fd >= 0;
+    for (uint64_t s = 0; ok && s * SAMPLES_SEGMENT < length; s++) {
+        if (segments[s] != NULL) {
+            uint64_t end = length - s * SAMPLES_SEGMENT;
+            ok = samples_write_segment(s, end < SAMPLES_SEGMENT ? (uint32_t)end : SAMPLES_SEGMENT);
+        }
+    }
+    ok = ok && fdatasync(spill_fd) == 0;
+    kept = kept || ok;
+    pthread_mutex_unlock(&samples_lock);
+    return ok;
+
+}
+
+uint64_t samples_length() {
+
+    pthread_mutex_lock(&samples_lock);
+    uint64_t n = length;
+    pthread_mutex_unlock(&samples_lock);
+    return n;
+
+}
+
+void samples_print_stats() {
+
+    uint64_t in_file = spilled * SAMPLES_SEGMENT;
+    printf("Runtimes: %lu recorded, %lu in memory, %lu in %s\n", (unsigned long)length, (unsigned long)(length - in_file), (unsigned long)in_file, spill_fd >= 0 ? spill_file : "no file");
+
+}
+
+// drops every runtime, the spill file is removed unless a checkpoint refers to it
+void samples_close() {
+
+    pthread_mutex_lock(&samples_lock);
+    for (uint64_t s = 0; s < segments_capacity; s++) {
+        free(segments[s]);
+    }
+    free(segments);
+    free(last_used);
+    free(in_file);
+    segments = NULL;
+    last_used = NULL;
+    in_file = NULL;
+    segments_capacity = 0;
+    length = 0;
+    resident = 0;
+    spilled = 0;
+    use_clock = 0;
+    if (spill_fd >= 0) {
+        close(spill_fd);
+        spill_fd = -1;
+        if (!kept) {
+            unlink(spill_file);
+        }
+    }
+    spilling = false;
+    kept = false;
+    pthread_mutex_unlock(&samples_lock);
+
+}
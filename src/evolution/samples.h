@@ -0,0 +1,29 @@
+#ifndef EVOLUTION_SAMPLES_H_
+#define EVOLUTION_SAMPLES_H_
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdbool.h>
+
+/*
+ * How many runtimes are kept in memory. Older runtimes are written to the run folder
+ * and read back from there when a log or checkpoint needs them
+ */
+typedef struct SampleSettings {
+    uint32_t memory_mb;         //Megabytes of runtimes kept in memory once a run folder is open, 0 to keep all of them
+} SampleSettings;
+
+extern SampleSettings sample_settings;
+
+void samples_open(char* main_folder);
+bool samples_resume(char* main_folder, uint64_t n);
+uint64_t samples_append(double* runtimes, uint32_t n);
+void samples_read(uint64_t at, uint32_t n, double* runtimes);
+bool samples_flush();
+uint64_t samples_length();
+void samples_print_stats();
+void samples_close();
+
+#endif /* EVOLUTION_SAMPLES_H_ */
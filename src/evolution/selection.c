@@ -182,8 +182,6 @@ uint32_t selection_tournament(node_str** population, double* fitness_values_all,
     uint32_t fitness_indices[tournament_size];
     double max_fitness = 0;
     uint32_t max_fitness_ind = -1;
-    bool repeat_index = false;
-    uint32_t num_chosen = 0;
     osaka_object_typ type = OBJECT_TYPE(population[0]);
 
     if (selection_get_min_max(type)) {
@@ -191,24 +189,7 @@ uint32_t selection_tournament(node_str** population, double* fitness_values_all,
     }
 
     // choose indexes of contestants in the tournament first
-    while (num_chosen < tournament_size) {
-        uint32_t index = (uint32_t) (pop_size * (rand() / (RAND_MAX + 1.0))); 
-        for (int curr = 0; curr < num_chosen; curr++) {
-            if (fitness_indices[curr] == index) {
-                // repeated index, mark as such
-                repeat_index = true;
-            }
-        }
-        if (repeat_index) {
-            // repeated index, need to pick another one
-        }
-        else {
-            //not chosen yet, can add new index
-            fitness_indices[num_chosen] = index;
-            num_chosen++;
-        }
-        repeat_index = false;
-    }
+    selection_tournament_contestants(fitness_indices, pop_size, tournament_size);
 
     for (uint32_t c = 0; c < tournament_size; c++) {
         fitness_values[c] = fitness_values_all[fitness_indices[c]];
@@ -232,4 +213,60 @@ uint32_t selection_tournament(node_str** population, double* fitness_values_all,
     result = population[max_fitness_ind];
     return max_fitness_ind;
 
-}
\ No newline at end of file
+}
+
+/*
+ * NAME
+ *
+ *   selection_tournament_contestants
+ *
+ * DESCRIPTION
+ *
+ *  Draws the contestants of a tournament the way
+ *  selection_tournament does, without replacement
+ *
+ * PARAMETERS
+ *
+ *  uint32_t* indices - set to the index of every contestant, dimension: tournament_size
+ *  uint32_t pop_size - size of the population
+ *  uint32_t tournament_size - number of contestants in the tournament
+ *
+ * RETURN
+ *
+ *  none
+ *
+ * EXAMPLE
+ *
+ * selection_tournament_contestants(indices, 50, 2);
+ *
+ * SIDE-EFFECT
+ *
+ * none
+ *
+ */
+
+void selection_tournament_contestants(uint32_t* indices, uint32_t pop_size, uint32_t tournament_size) {
+
+    bool repeat_index = false;
+    uint32_t num_chosen = 0;
+
+    while (num_chosen < tournament_size) {
+        uint32_t index = (uint32_t) (pop_size * (rand() / (RAND_MAX + 1.0))); 
+        for (int curr = 0; curr < num_chosen; curr++) {
+            if (indices[curr] == index) {
+                // repeated index, mark as such
+                repeat_index = true;
+            }
+        }
+        if (repeat_index) {
+            // repeated index, need to pick another one
+        }
+        else {
+            //not chosen yet, can add new index
+            indices[num_chosen] = index;
+            num_chosen++;
+        }
+        repeat_index = false;
+    }
+
+}
@@ -153,4 +153,36 @@ bool selection_compare_fitness(double fitness1, double fitness2, osaka_object_ty
 
 uint32_t selection_tournament(node_str** population, double* fitness_values_all, node_str* result, uint32_t pop_size, uint32_t tournament_size, bool vis);
 
+/*
+ * NAME
+ *
+ *   selection_tournament_contestants
+ *
+ * DESCRIPTION
+ *
+ *  Draws the contestants of a tournament the way
+ *  selection_tournament does, without replacement
+ *
+ * PARAMETERS
+ *
+ *  uint32_t* indices - set to the index of every contestant, dimension: tournament_size
+ *  uint32_t pop_size - size of the population
+ *  uint32_t tournament_size - number of contestants in the tournament
+ *
+ * RETURN
+ *
+ *  none
+ *
+ * EXAMPLE
+ *
+ * selection_tournament_contestants(indices, 50, 2);
+ *
+ * SIDE-EFFECT
+ *
+ * none
+ *
+ */
+
+void selection_tournament_contestants(uint32_t* indices, uint32_t pop_size, uint32_t tournament_size);
+
 #endif /* EVOLUTION_SELECTION_H_ */
\ No newline at end of file
@@ -0,0 +1,353 @@
+#include <math.h>
+#include "surrogate.h"
+
+#define SURROGATE_FEATURES 512      //Hashed pass unigrams and bigrams, feature 0 is the bias
+
+SurrogateSettings surrogate_settings = {.enabled = false, .keep = 0.5, .ridge = 1.0, .min_samples = 20};
+
+// ridge regression of the log runtime on the features, kept as the sums of the normal equations
+static double* gram = NULL;         //Sum of x x^T over the learned evaluations, dimension: SURROGATE_FEATURES x SURROGATE_FEATURES
+static double* moment = NULL;       //Sum of x y, dimension: SURROGATE_FEATURES
+static double weights[SURROGATE_FEATURES];
+static uint32_t num_samples = 0;
+static bool solved = false;
+
+// new individuals that were timed with a prediction, compared with their fitness at the end of the generation
+static DataNode** tracked = NULL;
+static double* tracked_predicted = NULL;
+static uint32_t num_tracked = 0;
+static uint32_t tracked_capacity = 0;
+static uint32_t num_skipped = 0;    //New offspring of the generation that were not timed
+
+typedef struct SurrogateRank {
+    double value;
+    uint32_t index;
+} SurrogateRank;
+
+static uint32_t surrogate_hash(uint64_t key) {
+
+    key ^= key >> 33;
+    key *= 0xff51afd7ed558ccdULL;
+    key ^= key >> 33;
+    return 1 + (uint32_t)(key % (SURROGATE_FEATURES - 1));
+
+}
+
+// index of every feature of the genome, repeated as often as it occurs
+static uint32_t surrogate_features(Genome* genome, uint32_t* index) {
+
+    uint32_t n = 0;
+
+    index[n++] = 0;
+    for (uint32_t i = 0; i < genome->length; i++) {
+        index[n++] = surrogate_hash(genome->pass[i] + 1);
+    }
+    for (uint32_t i = 0; i + 1 < genome->length; i++) {
+        index[n++] = surrogate_hash((uint64_t)(genome->pass[i] + 1) << 16 | (genome->pass[i + 1] + 1));
+    }
+    return n;
+
+}
+
+static void surrogate_add(Genome* genome, double y) {
+
+    uint32_t index[2 * genome->length + 1];
+    uint32_t n = surrogate_features(genome, index);
+
+    if (gram == NULL) {
+        gram = calloc((size_t)SURROGATE_FEATURES * SURROGATE_FEATURES, sizeof(double));
+        moment = calloc(SURROGATE_FEATURES, sizeof(double));
+    }
+    for (uint32_t i = 0; i < n; i++) {
+        moment[index[i]] += y;
+        for (uint32_t j = 0; j < n; j++) {
+            gram[(size_t)index[i] * SURROGATE_FEATURES + index[j]] += 1.0;
+        }
+    }
+    num_samples++;
+
+}
+
+// solves (gram + ridge I) w = moment by Cholesky, the bias is barely regularized
+static bool surrogate_solve() {
+
+    uint32_t f = SURROGATE_FEATURES;
+    double* l = malloc(sizeof(double) * f * f);
+
+    memcpy(l, gram, sizeof(double) * f * f);
+    for (uint32_t i = 0; i < f; i++) {
+        l[i * f + i] += i == 0 ? 1e-6 : surrogate_settings.ridge;
+    }
+    for (uint32_t j = 0; j < f; j++) {
+        double d = l[j * f + j];
+        for (uint32_t k = 0; k < j; k++) {
+            d -= l[j * f + k] * l[j * f + k];
+        }
+        if (d <= 0) {
+            free(l);
+            return false;
+        }
+        l[j * f + j] = sqrt(d);
+        for (uint32_t i = j + 1; i < f; i++) {
+            double s = l[i * f + j];
+            for (uint32_t k = 0; k < j; k++) {
+                s -= l[i * f + k] * l[j * f + k];
+            }
+            l[i * f + j] = s / l[j * f + j];
+        }
+    }
+    for (uint32_t i = 0; i < f; i++) {
+        double s = moment[i];
+        for (uint32_t k = 0; k < i; k++) {
+            s -= l[i * f + k] * weights[k];
+        }
+        weights[i] = s / l[i * f + i];
+    }
+    for (uint32_t i = f; i-- > 0; ) {
+        double s = weights[i];
+        for (uint32_t k = i + 1; k < f; k++) {
+            s -= l[k * f + i] * weights[k];
+        }
+        weights[i] = s / l[i * f + i];
+    }
+    free(l);
+    return true;
+
+}
+
+/*
+ * Learns every successful evaluation in all_indiv it has not seen yet, and fits
+ * the model again. After a resume the whole history is learned at once
+ */
+void surrogate_learn(DataNode** all_indiv, int max_id) {
+
+    uint32_t before = num_samples;
+
+    if (!surrogate_settings.enabled) {
+        return;
+    }
+    for (int id = 0; id < max_id; id++) {
+        DataNode* d = all_indiv[id];
+        if (d->genome->list != NULL) {
+            continue;
+        }
+        // evaluations folded before they were learned from are skipped
+        for (int e = d->learned > d->folded ? d->learned - d->folded : 0; e < d->num_eval - d->folded; e++) {
+            if (d->status[e] == EVAL_OK && d->avg_time[e] > 0 && d->avg_time[e] < UINT32_MAX) {
+                surrogate_add(d->genome, log(d->avg_time[e]));
+            }
+        }
+        d->learned = d->num_eval;
+    }
+    if (num_samples > before && num_samples >= surrogate_settings.min_samples) {
+        solved = surrogate_solve();
+    }
+
+}
+
+bool surrogate_ready() {
+
+    return surrogate_settings.enabled && solved;
+
+}
+
+// predicted log runtime, only meaningful to compare with other predictions
+double surrogate_predict(Genome* genome) {
+
+    uint32_t index[2 * genome->length + 1];
+    uint32_t n = surrogate_features(genome, index);
+    double y = 0.0;
+
+    for (uint32_t i = 0; i < n; i++) {
+        y += weights[index[i]];
+    }
+    return y;
+
+}
+
+static int surrogate_compare(const void* a, const void* b) {
+
+    double x = ((const SurrogateRank*)a)->value;
+    double y = ((const SurrogateRank*)b)->value;
+    return (x > y) - (x < y);
+
+}
+
+/*
+ * Decides which individuals of a batch are timed. The individuals compete in races,
+ * race[i] being the race of individual i: of the individuals of a race never evaluated,
+ * only the keep fraction predicted to be fastest is timed, and always the best one, so
+ * no race is left to untimed individuals alone. An individual in several races is timed
+ * if any of them keeps it. Returns how many are not timed
+ */
+uint32_t surrogate_select(DataNode** indiv_data, int* race, uint32_t n, bool* timed) {
+
+    DataNode* fresh[n];
+    double predicted[n];
+    bool keep[n];
+    int fresh_index[n];         //Index of individual i in fresh, -1 if it was evaluated before
+    uint32_t num_fresh = 0;
+    uint32_t num_skipped_now = 0;
+
+    for (uint32_t i = 0; i < n; i++) {
+        timed[i] = true;
+    }
+    if (!surrogate_ready()) {
+        return 0;
+    }
+    for (uint32_t i = 0; i < n; i++) {
+        DataNode* d = indiv_data[i];
+        fresh_index[i] = -1;
+        if (d->num_eval > 0 || d->genome->list != NULL) {
+            continue;
+        }
+        for (uint32_t k = 0; k < num_fresh && fresh_index[i] < 0; k++) {
+            if (fresh[k] == d) {
+                fresh_index[i] = k;
+            }
+        }
+        if (fresh_index[i] < 0) {
+            predicted[num_fresh] = surrogate_predict(d->genome);
+            keep[num_fresh] = false;
+            fresh_index[i] = num_fresh;
+            fresh[num_fresh++] = d;
+        }
+    }
+    for (uint32_t i = 0; i < n; i++) {
+        bool first = true;
+        for (uint32_t j = 0; j < i && first; j++) {
+            first = race[j] != race[i];
+        }
+        if (!first) {
+            continue;
+        }
+        // the distinct new individuals of the race of individual i, ranked by prediction
+        SurrogateRank ranks[n];
+        uint32_t num_ranked = 0;
+        for (uint32_t j = i; j < n; j++) {
+            bool seen = race[j] != race[i] || fresh_index[j] < 0;
+            for (uint32_t r = 0; r < num_ranked && !seen; r++) {
+                seen = ranks[r].index == (uint32_t)fresh_index[j];
+            }
+            if (!seen) {
+                ranks[num_ranked].value = predicted[fresh_index[j]];
+                ranks[num_ranked++].index = fresh_index[j];
+            }
+        }
+        qsort(ranks, num_ranked, sizeof(SurrogateRank), surrogate_compare);
+        uint32_t num_keep = (uint32_t)ceil(surrogate_settings.keep * num_ranked);
+        num_keep = num_keep < 1 ? 1 : num_keep;
+        for (uint32_t r = 0; r < num_ranked && r < num_keep; r++) {
+            keep[ranks[r].index] = true;
+        }
+    }
+    for (uint32_t k = 0; k < num_fresh; k++) {
+        if (keep[k]) {
+            surrogate_track(fresh[k], predicted[k]);
+        } else {
+            num_skipped_now++;
+        }
+    }
+    for (uint32_t i = 0; i < n; i++) {
+        timed[i] = fresh_index[i] < 0 || keep[fresh_index[i]];
+    }
+    num_skipped += num_skipped_now;
+    return num_skipped_now;
+
+}
+
+void surrogate_track(DataNode* d, double predicted) {
+
+    if (num_tracked == tracked_capacity) {
+        tracked_capacity = tracked_capacity == 0 ? 64 : tracked_capacity * 2;
+        tracked = realloc(tracked, sizeof(DataNode*) * tracked_capacity);
+        tracked_predicted = realloc(tracked_predicted, sizeof(double) * tracked_capacity);
+    }
+    tracked[num_tracked] = d;
+    tracked_predicted[num_tracked++] = predicted;
+
+}
+
+// rank of every value, ties share their average rank
+static void surrogate_ranks(double* values, uint32_t n, double* rank) {
+
+    SurrogateRank order[n];
+
+    for (uint32_t i = 0; i < n; i++) {
+        order[i].value = values[i];
+        order[i].index = i;
+    }
+    qsort(order, n, sizeof(SurrogateRank), surrogate_compare);
+    for (uint32_t i = 0; i < n; ) {
+        uint32_t j = i;
+        while (j + 1 < n && order[j + 1].value == order[i].value) {
+            j++;
+        }
+        for (uint32_t k = i; k <= j; k++) {
+            rank[order[k].index] = (i + j) / 2.0;
+        }
+        i = j + 1;
+    }
+
+}
+
+/*
+ * Prints the Spearman rank correlation between the predictions and the fitness
+ * the new individuals of the generation were measured to have
+ */
+void surrogate_report(int gen) {
+
+    double predicted[num_tracked > 0 ? num_tracked : 1];
+    double measured[num_tracked > 0 ? num_tracked : 1];
+    uint32_t n = 0;
+
+    if (!surrogate_settings.enabled) {
+        return;
+    }
+    for (uint32_t i = 0; i < num_tracked; i++) {
+        if (tracked[i]->num_eval > 0 && tracked[i]->fitness < UINT32_MAX) {
+            predicted[n] = tracked_predicted[i];
+            measured[n++] = tracked[i]->fitness;
+        }
+    }
+    uint32_t skipped = num_skipped;
+    num_tracked = 0;
+    num_skipped = 0;
+    if (n < 3) {
+        printf("Surrogate after generation %d: %u evaluations learned, %s\n", gen + 1, num_samples, solved ? "too few new individuals timed to rank" : "not ranking yet");
+        return;
+    }
+
+    double predicted_rank[n];
+    double measured_rank[n];
+    double mean = (n - 1) / 2.0;
+    double cov = 0.0, var_p = 0.0, var_m = 0.0;
+    surrogate_ranks(predicted, n, predicted_rank);
+    surrogate_ranks(measured, n, measured_rank);
+    for (uint32_t i = 0; i < n; i++) {
+        cov += (predicted_rank[i] - mean) * (measured_rank[i] - mean);
+        var_p += (predicted_rank[i] - mean) * (predicted_rank[i] - mean);
+        var_m += (measured_rank[i] - mean) * (measured_rank[i] - mean);
+    }
+    double rho = var_p > 0 && var_m > 0 ? cov / sqrt(var_p * var_m) : 0.0;
+    printf("Surrogate after generation %d: rank correlation %.3f over %u new individuals, %u offspring not timed, %u evaluations learned\n", gen + 1, rho, n, skipped, num_samples);
+
+}
+
+void surrogate_free() {
+
+    free(gram);
+    free(moment);
+    free(tracked);
+    free(tracked_predicted);
+    gram = NULL;
+    moment = NULL;
+    tracked = NULL;
+    tracked_predicted = NULL;
+    num_tracked = 0;
+    tracked_capacity = 0;
+    num_skipped = 0;
+    num_samples = 0;
+    solved = false;
+
+}
@@ -0,0 +1,33 @@
+#ifndef EVOLUTION_SURROGATE_H_
+#define EVOLUTION_SURROGATE_H_
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include "indivdata.h"
+#include "genome.h"
+
+/*
+ * Online model of the runtime of a pass sequence, learned from every evaluation in
+ * all_indiv. New offspring and random individuals it predicts to be slow are not timed
+ */
+typedef struct SurrogateSettings {
+    bool enabled;
+    double keep;                //Fraction of the new offspring that is timed, and of the random candidates that is kept
+    double ridge;               //Regularization of the regression
+    uint32_t min_samples;       //Evaluations learned before the model ranks anything
+} SurrogateSettings;
+
+extern SurrogateSettings surrogate_settings;
+
+void surrogate_learn(DataNode** all_indiv, int max_id);
+bool surrogate_ready();
+double surrogate_predict(Genome* genome);
+uint32_t surrogate_select(DataNode** indiv_data, int* race, uint32_t n, bool* timed);
+void surrogate_track(DataNode* d, double predicted);
+void surrogate_report(int gen);
+void surrogate_free();
+
+#endif /* EVOLUTION_SURROGATE_H_ */
@@ -39,6 +39,23 @@
 #include <stdint.h>
 #include <assert.h>
 #include <string.h>
+#include <pthread.h>
+
+#define LLVM_PASS_POOL_CHUNK 1024
+
+/*
+ * DATATYPES
+ */
+
+// a pass object and its pass_struct, allocated together and kept for reuse once deleted
+typedef struct llvm_pass_block {
+    object_llvm_pass_str object;
+    pass_struct pass;
+    struct llvm_pass_block* next;   //Next deleted block in the pool
+} llvm_pass_block;
+
+static llvm_pass_block* pass_pool = NULL;
+static pthread_mutex_t pass_pool_lock = PTHREAD_MUTEX_INITIALIZER;
 
 /*
  * ROUTINES
@@ -542,87 +559,87 @@ int* llvm_default_level_string_lengths(const int num_levels) {
     return default_string_lengths;
 }
 
+// one catalog of passes shared by every pass object, never changed or freed
+char* llvm_pass_catalog[LLVM_NUM_PASSES] = {
+    "-adce", 
+    "-always-inline",
+    "-argpromotion",
+    "-basicaa", 
+    "-break-crit-edges",
+    "-codegenprepare", 
+    "-constmerge",
+    "-constprop", 
+    "-da", 
+    "-dce", 
+    "-deadargelim",
+    "-die", 
+    "-domfrontier",
+    "-domtree", 
+    "-dse",
+    "-functionattrs", 
+    "-globaldce", 
+    "-globalopt",
+    "-gvn", 
+    "-indvars", 
+    "-inline",
+    "-instcombine", 
+    "-instcount",
+    "-intervals", 
+    "-ipconstprop", 
+    "-ipsccp", 
+    "-iv-users",
+    "-jump-threading",
+    "-lazy-value-info",
+    "-lcssa", 
+    "-licm", 
+    //"-lint", 
+    "-simplifycfg", 
+    "-loop-deletion",
+    "-loop-extract", 
+    "-loop-extract-single", 
+    "-loop-reduce",
+    "-loop-rotate", 
+    "-loop-simplify", 
+    "-loop-unroll",
+    "-loop-unswitch", 
+    "-loops", 
+    "-loweratomic",
+    "-lowerinvoke", 
+    "-lowerswitch",
+    "-mem2reg",
+    "-memcpyopt",
+    "-memdep",  
+    "-mergefunc",
+    "-mergereturn",
+    "-module-debuginfo", 
+    "-partial-inliner", 
+    "-postdomtree", 
+    //"-print-dom-info", 
+    //"-print-function",
+    //"-print-module",  
+    "-prune-eh",
+    "-reassociate",
+    "-reg2mem", 
+    "-regions",
+    "-scalar-evolution", 
+    "-sccp",
+    "-scev-aa", 
+    "-simplifycfg", 
+    "-sink", 
+    "-sroa", 
+    "-strip",
+    "-strip-dead-debug-info", 
+    "-strip-dead-prototypes", 
+    "-strip-debug-declare",
+    "-strip-nondebug", 
+    "-tailcallelim"
+};
+
 void llvm_pass_set_valid_values(object_llvm_pass_str* o) {
-    
-    int num_passes = 68;
-    char** values = malloc(sizeof(char*) * num_passes);
-    //values[0] = "-aa-eval"; 
-    values[0] = "-adce"; 
-    values[1] = "-always-inline";
-    values[2] = "-argpromotion";
-    values[3] = "-basicaa"; 
-    values[4] = "-break-crit-edges";
-    values[5] = "-codegenprepare"; 
-    values[6] = "-constmerge";
-    values[7] = "-constprop"; 
-    values[8] = "-da"; 
-    values[9] = "-dce"; 
-    values[10] = "-deadargelim";
-    values[11] = "-die"; 
-    values[12] = "-domfrontier";
-    values[13] = "-domtree"; 
-    values[14] = "-dse";
-    values[15] = "-functionattrs"; 
-    values[16] = "-globaldce"; 
-    values[17] = "-globalopt";
-    values[18] = "-gvn"; 
-    values[19] = "-indvars"; 
-    values[20] = "-inline";
-    values[21] = "-instcombine"; 
-    values[22] = "-instcount";
-    values[23] = "-intervals"; 
-    values[24] = "-ipconstprop"; 
-    values[25] = "-ipsccp"; 
-    values[26] = "-iv-users";
-    values[27] = "-jump-threading";
-    values[28] = "-lazy-value-info";
-    values[29] = "-lcssa"; 
-    values[30] = "-licm"; 
-    //values[31] = "-lint"; 
-    values[31] = "-simplifycfg"; 
-    values[32] = "-loop-deletion";
-    values[33] = "-loop-extract"; 
-    values[34] = "-loop-extract-single"; 
-    values[35] = "-loop-reduce";
-    values[36] = "-loop-rotate"; 
-    values[37] = "-loop-simplify"; 
-    values[38] = "-loop-unroll";
-    values[39] = "-loop-unswitch"; 
-    values[40] = "-loops"; 
-    values[41] = "-loweratomic";
-    values[42] = "-lowerinvoke"; 
-    values[43] = "-lowerswitch";
-    values[44] = "-mem2reg";
-    values[45] = "-memcpyopt";
-    values[46] = "-memdep";  
-    values[47] = "-mergefunc";
-    values[48] = "-mergereturn";
-    values[49] = "-module-debuginfo"; 
-    values[50] = "-partial-inliner"; 
-    values[51] = "-postdomtree"; 
-    //values[53] = "-print-dom-info"; 
-    //values[54] = "-print-function";
-    //values[55] = "-print-module";  
-    values[52] = "-prune-eh";
-    values[53] = "-reassociate";
-    values[54] = "-reg2mem"; 
-    values[55] = "-regions";
-    values[56] = "-scalar-evolution"; 
-    values[57] = "-sccp";
-    values[58] = "-scev-aa"; 
-    values[59] = "-simplifycfg"; 
-    values[60] = "-sink"; 
-    values[61] = "-sroa"; 
-    values[62] = "-strip";
-    values[63] = "-strip-dead-debug-info"; 
-    values[64] = "-strip-dead-prototypes"; 
-    values[65] = "-strip-debug-declare";
-    values[66] = "-strip-nondebug"; 
-    values[67] = "-tailcallelim";
-
-    PASS_VALID_VALUES(o) = values;
+
+    PASS_VALID_VALUES(o) = llvm_pass_catalog;
     PASS_CONSTRAINED(o) = true;
-    PASS_NUM_VALID_VALUES(o) = num_passes;
+    PASS_NUM_VALID_VALUES(o) = LLVM_NUM_PASSES;
 
     return;
 
@@ -630,16 +647,26 @@ void llvm_pass_set_valid_values(object_llvm_pass_str* o) {
 
 object_llvm_pass_str *llvm_pass_createobject(void)    {
 
-    object_llvm_pass_str *o;
-    pass_struct *s;
+    llvm_pass_block *b;
 
-    o = malloc(sizeof(object_llvm_pass_str));
-    s = malloc(sizeof(pass_struct));
+    pthread_mutex_lock(&pass_pool_lock);
+    if (pass_pool == NULL) {
+        // blocks are allocated a chunk at a time and never freed
+        llvm_pass_block *chunk = malloc(sizeof(llvm_pass_block) * LLVM_PASS_POOL_CHUNK);
+        assert(chunk!=NULL);
+        for (int i = 0; i < LLVM_PASS_POOL_CHUNK - 1; i++) {
+            chunk[i].next = &chunk[i + 1];
+        }
+        chunk[LLVM_PASS_POOL_CHUNK - 1].next = NULL;
+        pass_pool = chunk;
+    }
+    b = pass_pool;
+    pass_pool = b->next;
+    pthread_mutex_unlock(&pass_pool_lock);
 
-    assert(o!=NULL);
-    assert(s!=NULL);
+    object_llvm_pass_str *o = &b->object;
 
-    PASS_STRUCT(o) = s;
+    PASS_STRUCT(o) = &b->pass;
     PASS_INDEX(o) = -1;
     PASS(o) = "not set";
     
@@ -711,9 +738,18 @@ void llvm_pass_deleteobject(object_llvm_pass_str *s)  {
 
     assert(s!=NULL);
 
-    free(PASS_VALID_VALUES(s));
-    free(PASS_STRUCT(s));
-    free(s);
+    llvm_pass_block *b = (llvm_pass_block*)s;
+
+    // objects from llvm_pass_readobject are not pool blocks
+    if (PASS_STRUCT(s) != &b->pass) {
+        free(PASS_STRUCT(s));
+        free(s);
+        return;
+    }
+    pthread_mutex_lock(&pass_pool_lock);
+    b->next = pass_pool;
+    pass_pool = b;
+    pthread_mutex_unlock(&pass_pool_lock);
 
 }
 
@@ -68,6 +68,14 @@ typedef struct object_llvm_pass_str {
 #define PASS_VALID_VALUES(s) s->pass->valid_values
 #define PASS_NUM_VALID_VALUES(s) s->pass->num_values
 
+#define LLVM_NUM_PASSES 68
+
+/*
+ * GLOBALS
+ */
+
+extern char* llvm_pass_catalog[LLVM_NUM_PASSES];
+
 /*
  * ROUTINES
  */
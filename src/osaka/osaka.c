@@ -45,6 +45,9 @@
 #include "osaka.h"
 #include "osaka_test.h"
 #include <string.h>
+#include <pthread.h>
+
+#define OSAKA_POOL_CHUNK 1024
 
 /*
  * STATIC
@@ -54,6 +57,10 @@ bool OSAKA_INIT = false;
 bool debug = false;
 uint32_t global_nth;
 
+// released nodes, chained through their next pointers, are handed out again before new ones are allocated
+static node_str *node_pool = NULL;
+static pthread_mutex_t node_pool_lock = PTHREAD_MUTEX_INITIALIZER;
+
 /*
  * ROUTINES
  */
@@ -145,6 +152,195 @@ osaka_node_typ osaka_whatisnode(node_str *n)  {
 
 }
 
+/*
+ * NAME
+ *
+ *  xosaka_poolnode
+ *
+ * DESCRIPTION
+ *
+ *  Internal function which takes a node from the node pool. When the
+ *  pool is empty, OSAKA_POOL_CHUNK nodes are allocated with one malloc
+ *  and added to it. The fields of the node are not set.
+ *
+ * PARAMETERS
+ *
+ *  none...
+ *
+ * RETURN
+ *
+ *  node_str * - unused node
+ *
+ * EXAMPLE
+ *
+ *  n = xosaka_poolnode();
+ *
+ * SIDE-EFFECT
+ *
+ *  may allocate a chunk of nodes that is never freed
+ *
+ */
+
+static node_str *xosaka_poolnode(void) {
+
+    node_str *n;
+
+    pthread_mutex_lock(&node_pool_lock);
+    if (node_pool == NULL) {
+        node_str *chunk = malloc(sizeof(node_str) * OSAKA_POOL_CHUNK);
+        if (chunk == NULL)  {
+            printf ("error: failed to alloc memory for node_str [file:\'%s\',line:%d]\n",__FILE__,__LINE__);
+            exit(0);
+        }
+        for (int i = 0; i < OSAKA_POOL_CHUNK - 1; i++) {
+            chunk[i].next_ptr = &chunk[i + 1];
+        }
+        chunk[OSAKA_POOL_CHUNK - 1].next_ptr = NULL;
+        node_pool = chunk;
+    }
+    n = node_pool;
+    node_pool = NEXT(n);
+    pthread_mutex_unlock(&node_pool_lock);
+
+    return n;
+
+}
+
+/*
+ * NAME
+ *
+ *  xosaka_poolrelease
+ *
+ * DESCRIPTION
+ *
+ *  Internal function which returns the nodes first to last, linked
+ *  through their next pointers, to the node pool in one step.
+ *
+ * PARAMETERS
+ *
+ *  node_str *first - first node to be released
+ *  node_str *last - last node to be released
+ *
+ * RETURN
+ *
+ *  none...
+ *
+ * EXAMPLE
+ *
+ *  xosaka_poolrelease(n, n);
+ *
+ * SIDE-EFFECT
+ *
+ *  the nodes must not be used anymore
+ *
+ */
+
+static void xosaka_poolrelease(node_str *first, node_str *last) {
+
+    pthread_mutex_lock(&node_pool_lock);
+    NEXT(last) = node_pool;
+    node_pool = first;
+    pthread_mutex_unlock(&node_pool_lock);
+
+}
+
+/*
+ * NAME
+ *
+ *  xosaka_dropindex
+ *
+ * DESCRIPTION
+ *
+ *  Internal function which frees the index kept by a root, for changes
+ *  to the list that the index does not follow. It is built again when
+ *  needed.
+ *
+ * PARAMETERS
+ *
+ *  node_str *r - root of the list
+ *
+ * RETURN
+ *
+ *  none...
+ *
+ * EXAMPLE
+ *
+ *  xosaka_dropindex(r);
+ *
+ * SIDE-EFFECT
+ *
+ *  frees the index of the list
+ *
+ */
+
+static void xosaka_dropindex(node_str *r) {
+
+    if (r==NULL || LIST_INDEX(r)==NULL) {
+        return;
+    }
+    free(LIST_INDEX(r)->nodes);
+    free(LIST_INDEX(r));
+    LIST_INDEX(r)=NULL;
+
+}
+
+/*
+ * NAME
+ *
+ *  xosaka_buildindex
+ *
+ * DESCRIPTION
+ *
+ *  Internal function which returns the index of a list, walking the
+ *  list once to build it if the root has none yet.
+ *
+ * PARAMETERS
+ *
+ *  node_str *r - root of the list
+ *
+ * RETURN
+ *
+ *  osaka_index_str * - index of the list
+ *
+ * EXAMPLE
+ *
+ *  index = xosaka_buildindex(r);
+ *
+ * SIDE-EFFECT
+ *
+ *  allocates the index, it is freed with the list
+ *
+ */
+
+static osaka_index_str *xosaka_buildindex(node_str *r) {
+
+    osaka_index_str *index;
+    node_str *n;
+    uint32_t length = 0;
+
+    if (LIST_INDEX(r)!=NULL) {
+        return LIST_INDEX(r);
+    }
+
+    for (n=r; n!=NULL; n=NEXT(n)) {
+        length++;
+    }
+    index = malloc(sizeof(osaka_index_str));
+    assert(index!=NULL);
+    index->length = length;
+    index->capacity = length < 16 ? 16 : length;
+    index->nodes = malloc(sizeof(node_str*) * index->capacity);
+    assert(index->nodes!=NULL);
+    length = 0;
+    for (n=r; n!=NULL; n=NEXT(n)) {
+        index->nodes[length++] = n;
+    }
+    LIST_INDEX(r)=index;
+
+    return index;
+
+}
+
 /*
  * NAME
  *
@@ -184,18 +380,14 @@ node_str *__osaka_createnode(osaka_object_typ ot) {
 
     node_str *n;
 
-    n = malloc(sizeof(node_str));
-
-    if (n == NULL)  {
-        printf ("error: failed to alloc memory for node_str [file:\'%s\',line:%d]\n",__FILE__,__LINE__);
-        exit(0);
-    }
+    n = xosaka_poolnode();
 
     UID(n)=osaka_uid();
     NEXT(n)=NULL;
     LAST(n)=NULL;
     NEXT_LINK(n)=NULL;
     LAST_LINK(n)=NULL;
+    LIST_INDEX(n)=NULL;
     OBJECT_TYPE(n)=NOTSET;
     OBJECT(n)=NULL;
 
@@ -324,8 +516,22 @@ node_str *osaka_addnodetotail(node_str *r,node_str *n)  {
     node_str *tail;
     assert(r!=NULL);
 
-    tail=osaka_findtailnode(r);
+    if (LAST(r)!=NULL) {
+        tail=osaka_findtailnode(r);
+    }
+    else {
+        // the root keeps the tail in its index, the new node is added to it
+        osaka_index_str *index = xosaka_buildindex(r);
+        tail=index->nodes[index->length-1];
+        if (index->length==index->capacity) {
+            index->capacity*=2;
+            index->nodes=realloc(index->nodes,sizeof(node_str*) * index->capacity);
+            assert(index->nodes!=NULL);
+        }
+        index->nodes[index->length++]=n;
+    }
 
+    xosaka_dropindex(n);
     NEXT(tail)=n;
     LAST(n)=tail;
     NEXT(n)=NULL; // makes it only a node addition
@@ -368,6 +574,8 @@ node_str *osaka_addnodetohead(node_str *r,node_str *n)  {
     assert(n!=NULL);
     assert(r!=NULL);
 
+    xosaka_dropindex(r);
+    xosaka_dropindex(n);
     LAST(r)=n;
     NEXT(n)=r;
     LAST(n)=NULL; // makes it only a node addition
@@ -732,6 +940,7 @@ void osaka_postfix_mapto(node_str *n,void (*fun)(node_str *n))  {
  * DESCRIPTION
  *
  *  osaka_listlength takes a list and returns the length. Return zero if list has no nodes.
+ *  The length of a list whose root keeps an index is not counted again.
  *
  * PARAMETERS
  *
@@ -755,6 +964,10 @@ uint32_t osaka_listlength(node_str *r)  {
 
     uint32_t i = 0;
 
+    if (r!=NULL && LIST_INDEX(r)!=NULL) {
+        return LIST_INDEX(r)->length;
+    }
+
     while (r!=NULL) {
         r = NEXT(r);
         i++;
@@ -772,7 +985,8 @@ uint32_t osaka_listlength(node_str *r)  {
  *
  * DESCRIPTION
  *
- *  osaka_freenode takes a node_ptr and frees the memory area.
+ *  osaka_freenode takes a node_ptr, frees its object and returns the
+ *  node to the node pool.
  *
  * PARAMETERS
  *
@@ -798,7 +1012,8 @@ void osaka_freenode(node_str *n)  {
 
     object_table_function[OBJECT_TYPE(n)].osaka_deleteobject(OBJECT(n));
 
-    free(n);
+    xosaka_dropindex(n);
+    xosaka_poolrelease(n, n);
 
 }
 
@@ -905,7 +1120,8 @@ uint32_t osaka_fitness(node_str *n) {
  *
  * DESCRIPTION
  *
- *  osaka_nthnode return nth node in the list.
+ *  osaka_nthnode return nth node in the list. Called with the root of a list,
+ *  the node is looked up in the index of the list, which is built first if needed.
  *
  * PARAMETERS
  *
@@ -931,6 +1147,11 @@ node_str *osaka_nthnode(node_str *r,uint32_t nth) {
     assert(r!=NULL);
     assert(nth!=0);
 
+    if (LAST(r)==NULL) {
+        osaka_index_str *index = xosaka_buildindex(r);
+        return nth<=index->length ? index->nodes[nth-1] : NULL;
+    }
+
     while(r!=NULL)  {
         --nth;
         if (nth==0) {
@@ -943,6 +1164,71 @@ node_str *osaka_nthnode(node_str *r,uint32_t nth) {
 
 }
 
+/*
+ * NAME
+ *
+ *  osaka_splice
+ *
+ * DESCRIPTION
+ *
+ *  Swaps the nodes of two lists from the nth node on, the crossover of
+ *  two individuals at one point. Only the pointers around the nth nodes
+ *  are changed and the indexes of both lists are kept.
+ *
+ * PARAMETERS
+ *
+ *  node_str *r0 - root of the first list
+ *  node_str *r1 - root of the second list
+ *  uint32_t nth - first node that is swapped, at least 2 and at most the
+ *                 length of the shorter list
+ *
+ * RETURN
+ *
+ *  none...
+ *
+ * EXAMPLE
+ *
+ *  osaka_splice(r0, r1, 3);
+ *
+ * SIDE-EFFECT
+ *
+ *  both lists keep their roots, their lengths are swapped
+ *
+ */
+
+void osaka_splice(node_str *r0, node_str *r1, uint32_t nth) {
+
+    osaka_index_str *index0,*index1;
+    node_str *n0,*n1,*l0,*l1,*swap;
+
+    assert(r0!=NULL && r1!=NULL && r0!=r1);
+    assert(nth>1);
+
+    index0 = xosaka_buildindex(r0);
+    index1 = xosaka_buildindex(r1);
+    assert(nth<=index0->length && nth<=index1->length);
+
+    n0 = index0->nodes[nth-1];
+    n1 = index1->nodes[nth-1];
+    l0 = LAST(n0);
+    l1 = LAST(n1);
+    NEXT(l0) = n1;
+    NEXT(l1) = n0;
+    LAST(n0) = l1;
+    LAST(n1) = l0;
+
+    // each list now ends with the nodes of the other index, so the indexes swap
+    // roots once the nodes before the nth node are swapped back
+    for (uint32_t i = 0; i < nth-1; i++) {
+        swap = index0->nodes[i];
+        index0->nodes[i] = index1->nodes[i];
+        index1->nodes[i] = swap;
+    }
+    LIST_INDEX(r0) = index1;
+    LIST_INDEX(r1) = index0;
+
+}
+
 /*
  * NAME
  *
@@ -987,6 +1273,7 @@ node_str *osaka_deletenode(node_str *n) {
             break;
         case HEADNODE:
             //if(debug) printf ("--osaka: deleting HEADNODE\n");
+            xosaka_dropindex(n);
             t = NEXT(n);
             LAST(t) = NULL;
             osaka_freenode(n);
@@ -997,7 +1284,9 @@ node_str *osaka_deletenode(node_str *n) {
             t = LAST(n);
             NEXT(t) = NULL;
             osaka_freenode(n);
-            return osaka_findheadnode(t);
+            t = osaka_findheadnode(t);
+            xosaka_dropindex(t);
+            return t;
             break;
         case INTERMEDIATE:
             //if(debug) printf ("--osaka: deleting INTERMEDIATE node \n");
@@ -1006,7 +1295,9 @@ node_str *osaka_deletenode(node_str *n) {
             NEXT(l) = t;
             LAST(t) = l;
             osaka_freenode(n);
-            return osaka_findheadnode(l);
+            l = osaka_findheadnode(l);
+            xosaka_dropindex(l);
+            return l;
             break;
     }
 
@@ -1126,6 +1417,7 @@ node_str *osaka_deserialize(char *filepath) {
     while(!feof(handle))  {
         tmp = __osaka_createnode(NOTSET);
         fread(tmp,sizeof(node_str),1,handle);
+        LIST_INDEX(tmp)=NULL;
 
         if(OBJECT_TYPE(tmp)!=NOTSET)  {
             if(OBJECT_TYPE(tmp)>=0 && OBJECT_TYPE(tmp)<MAXTYPE) {
@@ -1325,9 +1617,9 @@ node_str *osaka_copylist(node_str *r) {
     node_str *c=NULL,*cr=NULL,*nc=NULL;
     
     while(r!=NULL)  {
-        c=malloc(sizeof(node_str));
-        assert(c!=NULL);
+        c=xosaka_poolnode();
         memcpy(c,r,sizeof(node_str));
+        LIST_INDEX(c)=NULL;
 
         if (nc==NULL) {
             nc=cr=c;
@@ -1383,7 +1675,7 @@ node_str *osaka_copylist(node_str *r) {
 void xosaka_innerfree(node_str *n)  {
 
     assert(OBJECT(n)!=NULL); // node cannot be set and have no point to object
-    free(OBJECT(n));
+    object_table_function[OBJECT_TYPE(n)].osaka_deleteobject(OBJECT(n));
 
 }
    
@@ -1422,7 +1714,8 @@ void xosaka_outerfree(node_str *n)  {
     if(OBJECT_TYPE(n)!=NOTSET)
     xosaka_innerfree(n);
 
-    free(n);
+    xosaka_dropindex(n);
+    xosaka_poolrelease(n, n);
 
 }
 
@@ -1433,7 +1726,8 @@ void xosaka_outerfree(node_str *n)  {
  *
  * DESCRIPTION
  *
- *  This function recursively frees the nodes of a list. 
+ *  This function frees the objects of the nodes of a list, starting at
+ *  the root, and returns all the nodes to the node pool at once.
  *
  * PARAMETERS
  *
@@ -1455,7 +1749,20 @@ void xosaka_outerfree(node_str *n)  {
 
 node_str *osaka_freelist(node_str *r) {
 
-    osaka_postfix_mapto(r,xosaka_outerfree); // free list
+    node_str *n,*l=NULL;
+
+    xosaka_dropindex(r);
+
+    // objects are deleted walking down the list, the nodes go back to the pool together
+    for (n=r; n!=NULL; n=NEXT(n))  {
+        if(OBJECT_TYPE(n)!=NOTSET)
+        xosaka_innerfree(n);
+        l=n;
+    }
+
+    if (l!=NULL) {
+        xosaka_poolrelease(r,l);
+    }
 
     return NULL;
 
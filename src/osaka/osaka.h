@@ -84,8 +84,21 @@ typedef struct node_str {
     struct node_str *next_ptr;
     struct node_str *last_link;
     struct node_str *next_link;
+    struct osaka_index_str *index;
 } node_str;
 
+/*
+ * Array of the nodes of a list, kept by the head node of the list. Built on
+ * the first osaka_nthnode or osaka_addnodetotail and kept up to date by the
+ * osaka routines that change the list
+ */
+
+typedef struct osaka_index_str {
+    uint32_t length;
+    uint32_t capacity;
+    node_str **nodes;
+} osaka_index_str;
+
 /*
  * MACROS
  */
@@ -94,6 +107,7 @@ typedef struct node_str {
 #define LAST(s) s->last_ptr
 #define NEXT_LINK(s) s->next_link
 #define LAST_LINK(s) s->last_link
+#define LIST_INDEX(s) s->index
 #define OBJECT(s) s->object_ptr
 #define OBJECT_TYPE(s) s->objtype
 #define UID(s) s->uid
@@ -542,6 +556,7 @@ void osaka_postfix_mapto(node_str *n,void (*fun)(node_str *n));
  * DESCRIPTION
  *
  *  osaka_listlength takes a list and returns the length. Return zero if list has no nodes.
+ *  The length of a list whose root keeps an index is not counted again.
  *
  * PARAMETERS
  *
@@ -570,7 +585,8 @@ uint32_t osaka_listlength(node_str *r);
  *
  * DESCRIPTION
  *
- *  osaka_freenode takes a node_ptr and frees the memory area.
+ *  osaka_freenode takes a node_ptr, frees its object and returns the
+ *  node to the node pool.
  *
  * PARAMETERS
  *
@@ -664,7 +680,8 @@ uint32_t osaka_fitness(node_str *n);
  *
  * DESCRIPTION
  *
- *  osaka_nthnode return nth node in the list.
+ *  osaka_nthnode return nth node in the list. Called with the root of a list,
+ *  the node is looked up in the index of the list, which is built first if needed.
  *
  * PARAMETERS
  *
@@ -687,6 +704,40 @@ uint32_t osaka_fitness(node_str *n);
 
 node_str *osaka_nthnode(node_str *r,uint32_t nth);
 
+/*
+ * NAME
+ *
+ *  osaka_splice
+ *
+ * DESCRIPTION
+ *
+ *  Swaps the nodes of two lists from the nth node on, the crossover of
+ *  two individuals at one point. Only the pointers around the nth nodes
+ *  are changed and the indexes of both lists are kept.
+ *
+ * PARAMETERS
+ *
+ *  node_str *r0 - root of the first list
+ *  node_str *r1 - root of the second list
+ *  uint32_t nth - first node that is swapped, at least 2 and at most the
+ *                 length of the shorter list
+ *
+ * RETURN
+ *
+ *  none...
+ *
+ * EXAMPLE
+ *
+ *  osaka_splice(r0, r1, 3);
+ *
+ * SIDE-EFFECT
+ *
+ *  both lists keep their roots, their lengths are swapped
+ *
+ */
+
+void osaka_splice(node_str *r0, node_str *r1, uint32_t nth);
+
 /*
  * NAME
  *
@@ -853,7 +904,8 @@ node_str *osaka_copylist(node_str *r);
  *
  * DESCRIPTION
  *
- *  This function recursively frees the nodes of a list. 
+ *  This function frees the objects of the nodes of a list, starting at
+ *  the root, and returns all the nodes to the node pool at once.
  *
  * PARAMETERS
  *
@@ -0,0 +1,354 @@
+#define _GNU_SOURCE
+#include <poll.h>
+#include <fcntl.h>
+#include <time.h>
+#include <errno.h>
+#include <sched.h>
+#include <signal.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <sys/ioctl.h>
+#include <linux/perf_event.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include "launcher.h"
+
+// counters read for every run, in the order of the LaunchResult fields
+static const uint64_t launcher_events[LAUNCH_EVENTS] = {
+    PERF_COUNT_HW_INSTRUCTIONS,
+    PERF_COUNT_HW_CPU_CYCLES,
+    PERF_COUNT_HW_BRANCH_MISSES,
+    PERF_COUNT_HW_CACHE_MISSES
+};
+
+/*
+ * Splits a command on whitespace. Commands that need a shell (pipes,
+ * redirection, &&, quoting, variables) are refused, the caller then
+ * has to fall back to system()
+ */
+bool launcher_parse_command(char* command, LaunchCommand* launch) {
+
+    int argc = 0;
+
+    if (strlen(command) >= sizeof(launch->buffer) || strpbrk(command, "|&;<>()$`'\"\\*?~") != NULL) {
+        return false;
+    }
+    strcpy(launch->buffer, command);
+    launch->count_events = false;
+    launch->limits.timeout = 0.0;
+    launch->limits.mem_limit = 0;
+    char* save = NULL;
+    for (char* arg = strtok_r(launch->buffer, " \t\n", &save); arg != NULL; arg = strtok_r(NULL, " \t\n", &save)) {
+        if (argc == MAX_LAUNCH_ARGS - 1) {
+            return false;
+        }
+        launch->argv[argc++] = arg;
+    }
+    launch->argv[argc] = NULL;
+    return argc > 0;
+
+}
+
+static double launcher_seconds(struct timespec* start, struct timespec* end) {
+
+    return (end->tv_sec - start->tv_sec) + (end->tv_nsec - start->tv_nsec) * 1e-9;
+
+}
+
+static void launcher_close_events(int* events) {
+
+    for (int e = 0; e < LAUNCH_EVENTS; e++) {
+        if (events[e] >= 0) {
+            close(events[e]);
+        }
+    }
+
+}
+
+static int launcher_pidfd_open(pid_t pid) {
+
+#ifdef SYS_pidfd_open
+    return syscall(SYS_pidfd_open, pid, 0);
+#else
+    errno = ENOSYS;
+    return -1;
+#endif
+
+}
+
+/*
+ * Opens a counter on the calling thread that is inherited by the programs it
+ * spawns. It stays disabled in this thread and only starts counting when the
+ * spawned program calls exec, so the launcher itself is never counted
+ */
+static int launcher_open_event(uint64_t config) {
+
+    struct perf_event_attr attr;
+
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.config = config;
+    attr.disabled = 1;
+    attr.inherit = 1;
+    attr.enable_on_exec = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+    return syscall(SYS_perf_event_open, &attr, 0, -1, -1, PERF_FLAG_FD_CLOEXEC);
+
+}
+
+/*
+ * Reads a counter, scaled up if the kernel had to multiplex it with other events
+ */
+static bool launcher_read_event(int fd, double* value) {
+
+    uint64_t data[3];   //value, time enabled, time running
+
+    if (read(fd, data, sizeof(data)) != sizeof(data) || data[2] == 0) {
+        return false;
+    }
+    *value = (double)data[0];
+    if (data[2] < data[1]) {
+        *value *= (double)data[1] / data[2];
+    }
+    return true;
+
+}
+
+/*
+ * Containers and perf_event_paranoid often forbid perf_event_open. Returns
+ * false, with the error in reason, if no counter can be opened here
+ */
+bool launcher_counters_available(char* reason) {
+
+    for (int e = 0; e < LAUNCH_EVENTS; e++) {
+        int fd = launcher_open_event(launcher_events[e]);
+        if (fd < 0) {
+            strcpy(reason, strerror(errno));
+            return false;
+        }
+        close(fd);
+    }
+    return true;
+
+}
+
+static double launcher_remaining(struct timespec* deadline) {
+
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return launcher_seconds(&now, deadline);
+
+}
+
+/*
+ * Sets the limits of the calling process, in the child between spawn and exec so
+ * they are in place before the program runs its first instruction. The CPU limit
+ * is a backstop for the wall time limit, a program that is killed by it has spent
+ * more than the timeout computing anyway
+ */
+static void launcher_set_limits(LaunchLimits* limits) {
+
+    struct rlimit limit;
+
+    if (limits->mem_limit > 0) {
+        limit.rlim_cur = limit.rlim_max = (rlim_t)limits->mem_limit << 20;
+        setrlimit(RLIMIT_AS, &limit);
+    }
+    if (limits->timeout > 0) {
+        limit.rlim_cur = limit.rlim_max = (rlim_t)limits->timeout + 1;
+        setrlimit(RLIMIT_CPU, &limit);
+    }
+
+}
+
+#define LAUNCH_STACK_SIZE (64 * 1024)
+
+typedef struct LaunchChild {
+    LaunchCommand* launch;
+    int report;             //Write end of the close-on-exec pipe
+    sigset_t* mask;         //Signal mask of the parent, restored in the child before exec
+} LaunchChild;
+
+/*
+ * Runs in the child on its own stack, sharing the memory of the parent until exec.
+ * It only makes system calls, and writes errno to the report pipe if exec fails
+ */
+static int launcher_child(void* arg) {
+
+    LaunchChild* child = (LaunchChild*)arg;
+    int child_errno;
+
+    setpgid(0, 0);
+    launcher_set_limits(&child->launch->limits);
+    sigprocmask(SIG_SETMASK, child->mask, NULL);
+    execvp(child->launch->argv[0], child->launch->argv);
+    child_errno = errno;
+    ssize_t reported = write(child->report, &child_errno, sizeof(child_errno));
+    _exit(reported < 0 ? 126 : 127);
+
+}
+
+/*
+ * Starts the program in its own process group with its limits set, the way
+ * posix_spawn does: the child shares the memory of the parent (CLONE_VM) and
+ * the parent waits until it has called exec (CLONE_VFORK), so the page tables
+ * of the parent, sample buffer and fitness store included, are never copied.
+ * Signals are blocked meanwhile, so no handler of the parent runs on the shared
+ * memory in the child. A close-on-exec pipe tells the parent whether the exec
+ * succeeded, it is closed by a successful exec and carries errno otherwise
+ */
+static bool launcher_spawn(LaunchCommand* launch, pid_t* pid) {
+
+    int report[2];
+    int child_errno;
+    sigset_t all, mask;
+
+    if (pipe2(report, O_CLOEXEC) != 0) {
+        return false;
+    }
+    char* stack = malloc(LAUNCH_STACK_SIZE);
+    if (stack == NULL) {
+        close(report[0]);
+        close(report[1]);
+        return false;
+    }
+    LaunchChild child = {launch, report[1], &mask};
+    sigfillset(&all);
+    pthread_sigmask(SIG_BLOCK, &all, &mask);
+    // the stack grows down on every architecture Shackleton runs on
+    *pid = clone(launcher_child, stack + LAUNCH_STACK_SIZE, CLONE_VM | CLONE_VFORK | SIGCHLD, &child);
+    pthread_sigmask(SIG_SETMASK, &mask, NULL);
+    free(stack);
+    close(report[1]);
+    if (*pid < 0) {
+        close(report[0]);
+        return false;
+    }
+    ssize_t got;
+    do {
+        got = read(report[0], &child_errno, sizeof(child_errno));
+    } while (got < 0 && errno == EINTR);
+    close(report[0]);
+    if (got > 0) {
+        waitpid(*pid, NULL, 0);
+        return false;
+    }
+    return true;
+
+}
+
+/*
+ * Starts the program without a shell and waits for it. The start time is taken
+ * once the exec is known to have succeeded, and the end time when the pidfd
+ * reports the exit, before the child is reaped, so neither the spawn nor the
+ * bookkeeping of wait4 is part of the elapsed time. Kernels without pidfd
+ * support are waited on with wait4 alone. The program runs in its own process
+ * group, so whatever it started is killed with it when it exceeds its timeout
+ */
+bool launcher_run(LaunchCommand* launch, LaunchResult* result) {
+
+    struct timespec start, end;
+    struct rusage usage;
+    int status;
+    pid_t pid;
+
+    result->status = -1;
+    result->elapsed = 0.0;
+    result->utime = 0.0;
+    result->stime = 0.0;
+    result->maxrss = 0;
+    result->timed_out = false;
+
+    result->counted = false;
+    result->instructions = 0.0;
+    result->cycles = 0.0;
+    result->branch_misses = 0.0;
+    result->cache_misses = 0.0;
+
+    // opened per run, so every run starts from zero and counts only its own program
+    int events[LAUNCH_EVENTS];
+    for (int e = 0; e < LAUNCH_EVENTS; e++) {
+        events[e] = launch->count_events ? launcher_open_event(launcher_events[e]) : -1;
+    }
+
+    if (!launcher_spawn(launch, &pid)) {
+        launcher_close_events(events);
+        return false;
+    }
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    struct timespec deadline = start;
+    double timeout = launch->limits.timeout;
+    deadline.tv_sec += (time_t)timeout;
+    deadline.tv_nsec += (long)((timeout - (time_t)timeout) * 1e9);
+    if (deadline.tv_nsec >= 1000000000L) {
+        deadline.tv_sec++;
+        deadline.tv_nsec -= 1000000000L;
+    }
+
+    bool reaped = false;
+    int pidfd = launcher_pidfd_open(pid);
+    if (pidfd >= 0) {
+        struct pollfd exited = {pidfd, POLLIN, 0};
+        int ready;
+        do {
+            int wait_ms = -1;
+            if (timeout > 0) {
+                double remaining = launcher_remaining(&deadline);
+                wait_ms = remaining > 0 ? (int)(remaining * 1000) + 1 : 0;
+            }
+            ready = poll(&exited, 1, wait_ms);
+        } while (ready < 0 && errno == EINTR);
+        clock_gettime(CLOCK_MONOTONIC, &end);
+        close(pidfd);
+        if (ready == 0) {
+            kill(-pid, SIGKILL);
+            result->timed_out = true;
+        }
+    } else if (timeout > 0) {
+        // without a pidfd the child is polled until it exits or runs out of time
+        struct timespec pause = {0, 100000};
+        pid_t done;
+        while ((done = wait4(pid, &status, WNOHANG, &usage)) == 0 && launcher_remaining(&deadline) > 0) {
+            nanosleep(&pause, NULL);
+        }
+        clock_gettime(CLOCK_MONOTONIC, &end);
+        reaped = done == pid;
+        if (done == 0) {
+            kill(-pid, SIGKILL);
+            result->timed_out = true;
+        }
+    }
+    while (!reaped && wait4(pid, &status, 0, &usage) < 0) {
+        if (errno != EINTR) {
+            launcher_close_events(events);
+            return false;
+        }
+    }
+    if (pidfd < 0 && timeout <= 0) {
+        clock_gettime(CLOCK_MONOTONIC, &end);
+    }
+
+    result->elapsed = launcher_seconds(&start, &end);
+    result->utime = usage.ru_utime.tv_sec + usage.ru_utime.tv_usec * 1e-6;
+    result->stime = usage.ru_stime.tv_sec + usage.ru_stime.tv_usec * 1e-6;
+    result->maxrss = usage.ru_maxrss;
+    if (WIFEXITED(status)) {
+        result->status = WEXITSTATUS(status);
+    }
+    // the counts of the exited program have been folded into the inherited counters
+    if (launch->count_events) {
+        result->counted = events[0] >= 0 && launcher_read_event(events[0], &result->instructions)
+                          && events[1] >= 0 && launcher_read_event(events[1], &result->cycles)
+                          && events[2] >= 0 && launcher_read_event(events[2], &result->branch_misses)
+                          && events[3] >= 0 && launcher_read_event(events[3], &result->cache_misses);
+    }
+    launcher_close_events(events);
+    return true;
+
+}
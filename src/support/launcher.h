@@ -0,0 +1,52 @@
+#ifndef SUPPORT_LAUNCHER_H_
+#define SUPPORT_LAUNCHER_H_
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdbool.h>
+
+#define MAX_LAUNCH_ARGS 64
+#define LAUNCH_EVENTS 4
+
+/*
+ * Measurements of one run of a program started by the launcher
+ */
+typedef struct LaunchResult {
+    int status;         //Exit code of the program, -1 if it could not be started or was killed by a signal
+    double elapsed;     //Wall time from the exec of the program until it exited, in seconds (CLOCK_MONOTONIC)
+    double utime;       //User CPU time of the program, in seconds
+    double stime;       //System CPU time of the program, in seconds
+    long maxrss;        //Maximum resident set size of the program, in kilobytes
+    bool timed_out;     //Whether the program was killed for exceeding its wall time limit
+    bool counted;       //Whether the hardware counters below were read
+    double instructions;    //Instructions retired in user space
+    double cycles;          //CPU cycles in user space
+    double branch_misses;   //Mispredicted branches
+    double cache_misses;    //Last level cache misses
+} LaunchResult;
+
+/*
+ * Limits a program is started with, 0 for no limit
+ */
+typedef struct LaunchLimits {
+    double timeout;     //Wall time after which the process group of the program is killed, in seconds
+    long mem_limit;     //RLIMIT_AS of the program, in megabytes
+} LaunchLimits;
+
+/*
+ * A command split into an argv vector once, so it can be started many times without a shell
+ */
+typedef struct LaunchCommand {
+    char buffer[1000];              //Copy of the command, the arguments point into it
+    char* argv[MAX_LAUNCH_ARGS];    //NULL terminated argument vector
+    bool count_events;              //Whether hardware counters are opened for every run
+    LaunchLimits limits;            //Limits of every run, none unless set after parsing
+} LaunchCommand;
+
+bool launcher_parse_command(char* command, LaunchCommand* launch);
+bool launcher_run(LaunchCommand* launch, LaunchResult* result);
+bool launcher_counters_available(char* reason);
+
+#endif /* SUPPORT_LAUNCHER_H_ */
@@ -529,6 +529,82 @@ void llvm_form_exec_code_command_from_ll(char* file, char* command) {
 
 }
 
+/*
+ * NAME
+ *
+ *   llvm_form_measure_commands
+ *
+ * DESCRIPTION
+ *
+ *  Given an optimized .ll or .bc file, creates the command that
+ *  prepares it for timing and the command that is timed. Natively, llc
+ *  generates an object file that is linked into an executable next to the
+ *  input, and only that executable is timed. Otherwise the module is
+ *  assembled to bitcode if needed and the timed command runs it with lli.
+ *  Either way no assembling or code generation happens in the timed command
+ *
+ * PARAMETERS
+ *
+ *  char* file - the .ll or .bc file that will be timed
+ *  bool native - whether an executable is built instead of using lli
+ *  char* build_command - the variable that will hold the preparation, empty if nothing is needed
+ *  char* run_command - the variable that will hold the command that is timed
+ *
+ * RETURN
+ *
+ *  none
+ *
+ * EXAMPLE
+ *
+ *  llvm_form_measure_commands("hello.ll", true, build_command, run_command);
+ *
+ * SIDE-EFFECT
+ *
+ *  Alters the build_command and run_command variables with the final result
+ *
+ */
+
+void llvm_form_measure_commands(char* file, bool native, char* build_command, char* run_command) {
+
+    char file_name[300];
+
+    strcpy(file_name, file);
+    char* p = strrchr(file_name, '.');
+    if (!p || (strcmp(p, ".ll") != 0 && strcmp(p, ".bc") != 0)) {
+        printf("File type of %s used with llvm is not supported.\n\nAborting code\n\n", file);
+        exit(0);
+    }
+    bool assembled = strcmp(p, ".bc") == 0;
+    *p = 0;
+
+    strcpy(build_command, "");
+    if (native) {
+        strcat(build_command, "llc -O2 -filetype=obj -relocation-model=pic ");
+        strcat(build_command, file);
+        strcat(build_command, " -o ");
+        strcat(build_command, file_name);
+        strcat(build_command, ".o && clang++ ");
+        strcat(build_command, file_name);
+        strcat(build_command, ".o -o ");
+        strcat(build_command, file_name);
+        strcat(build_command, " && rm -f ");
+        strcat(build_command, file_name);
+        strcat(build_command, ".o");
+
+        strcpy(run_command, file_name);
+    }
+    else {
+        if (!assembled) {
+            strcat(build_command, "llvm-as ");
+            strcat(build_command, file);
+        }
+        strcpy(run_command, "lli ");
+        strcat(run_command, file_name);
+        strcat(run_command, ".bc");
+    }
+
+}
+
 /*
  * NAME
  *
@@ -569,6 +645,64 @@ void llvm_form_test_command(char** src_files, uint32_t num_src_files, char* test
 
 }
 
+/*
+ * NAME
+ *
+ *   llvm_form_base_file
+ *
+ * DESCRIPTION
+ *
+ *  Forms the prefix shared by every file generated for a test file
+ *  during a run, src/files/llvm/junk_output/<test file name>_<id>. The
+ *  linked module, optimized outputs and worker scratch files all start
+ *  with this prefix
+ *
+ * PARAMETERS
+ *
+ *  char* file - the test file, with extension
+ *  const char* id - unique id of that run
+ *  char* base_file - the variable that will hold the prefix
+ *
+ * RETURN
+ *
+ *  none
+ *
+ * EXAMPLE
+ *
+ *  llvm_form_base_file("test.cpp", "42", base_file);
+ *
+ * SIDE-EFFECT
+ *
+ *  Alters the base_file variable with the final result
+ *
+ */
+
+void llvm_form_base_file(char* file, const char* id, char* base_file) {
+
+    char file_name[300];
+    char file_name_no_path[300];
+
+    strcpy(file_name, file);
+    char* p = strchr(file_name, '.');
+    if (!p) {
+        printf("File must have valid extension such as .c or .cpp.\n\nAborting code\n\n");
+        exit(0);
+    }
+    *p = 0;
+
+    char *t = strrchr(file_name, '/');
+    if (!t) {
+        strcpy(file_name_no_path, file_name);
+    } else strcpy(file_name_no_path, t+1);
+
+    strcpy(base_file, "src/files/llvm/junk_output/");
+    strcat(base_file, file_name_no_path);
+    strcat(base_file, "_");
+    strcat(base_file, id);
+
+}
+
+
 /*
  * NAME
  *
@@ -659,13 +793,19 @@ uint32_t llvm_clean_up(char *file, const char* id, bool cache) {
     strcat(base_file, id);
 
     strcpy(clean_up_command, "");
-    strcpy(clean_up_command, "rm ");
+    strcpy(clean_up_command, "rm -f ");
     strcat(clean_up_command, base_file);
     strcat(clean_up_command, "_linked.ll ");
     strcat(clean_up_command, base_file);
     strcat(clean_up_command, "_shackleton.ll ");
     strcat(clean_up_command, base_file);
     strcat(clean_up_command, "_shackleton.bc ");
+    // scratch files of the evaluation workers, only left behind if a run was interrupted
+    strcat(clean_up_command, base_file);
+    strcat(clean_up_command, "_w*_shackleton.* ");
+    // executables of the native measurement mode
+    strcat(clean_up_command, base_file);
+    strcat(clean_up_command, "_linked ");
     if (cache) {
         strcat(clean_up_command, base_file);
         strcat(clean_up_command, "_linked.bc ");
@@ -673,6 +813,8 @@ uint32_t llvm_clean_up(char *file, const char* id, bool cache) {
         strcat(clean_up_command, "_opt_O*.ll ");
         strcat(clean_up_command, base_file);
         strcat(clean_up_command, "_opt_O*.bc ");
+        strcat(clean_up_command, base_file);
+        strcat(clean_up_command, "_opt_O? ");
     }
     printf("Running clean up command: %s\n", clean_up_command);
 
@@ -214,6 +214,43 @@ void llvm_form_exec_code_command(char* file, char* command);
 
 void llvm_form_exec_code_command_from_ll(char* file, char* command);
 
+/*
+ * NAME
+ *
+ *   llvm_form_measure_commands
+ *
+ * DESCRIPTION
+ *
+ *  Given an optimized .ll or .bc file, creates the command that
+ *  prepares it for timing and the command that is timed. Natively, llc
+ *  generates an object file that is linked into an executable next to the
+ *  input, and only that executable is timed. Otherwise the module is
+ *  assembled to bitcode if needed and the timed command runs it with lli.
+ *  Either way no assembling or code generation happens in the timed command
+ *
+ * PARAMETERS
+ *
+ *  char* file - the .ll or .bc file that will be timed
+ *  bool native - whether an executable is built instead of using lli
+ *  char* build_command - the variable that will hold the preparation, empty if nothing is needed
+ *  char* run_command - the variable that will hold the command that is timed
+ *
+ * RETURN
+ *
+ *  none
+ *
+ * EXAMPLE
+ *
+ *  llvm_form_measure_commands("hello.ll", true, build_command, run_command);
+ *
+ * SIDE-EFFECT
+ *
+ *  Alters the build_command and run_command variables with the final result
+ *
+ */
+
+void llvm_form_measure_commands(char* file, bool native, char* build_command, char* run_command);
+
 /*
  * NAME
  *
@@ -249,6 +286,40 @@ void llvm_form_exec_code_command_from_ll(char* file, char* command);
 
 void llvm_form_test_command(char** src_files, uint32_t num_src_files, char* test_file, char* build_command, char* run_command, const char* id);
 
+/*
+ * NAME
+ *
+ *   llvm_form_base_file
+ *
+ * DESCRIPTION
+ *
+ *  Forms the prefix shared by every file generated for a test file
+ *  during a run, src/files/llvm/junk_output/<test file name>_<id>. The
+ *  linked module, optimized outputs and worker scratch files all start
+ *  with this prefix
+ *
+ * PARAMETERS
+ *
+ *  char* file - the test file, with extension
+ *  const char* id - unique id of that run
+ *  char* base_file - the variable that will hold the prefix
+ *
+ * RETURN
+ *
+ *  none
+ *
+ * EXAMPLE
+ *
+ *  llvm_form_base_file("test.cpp", "42", base_file);
+ *
+ * SIDE-EFFECT
+ *
+ *  Alters the base_file variable with the final result
+ *
+ */
+
+void llvm_form_base_file(char* file, const char* id, char* base_file);
+
 /*
  * NAME
  *
@@ -0,0 +1,276 @@
+#include "llvm_api.h"
+
+#ifdef SHACKLETON_LLVM_API
+
+#include <pthread.h>
+#include <llvm-c/Core.h>
+#include <llvm-c/Error.h>
+#include <llvm-c/IRReader.h>
+#include <llvm-c/BitWriter.h>
+#include <llvm-c/Target.h>
+#include <llvm-c/TargetMachine.h>
+#include <llvm-c/Transforms/PassBuilder.h>
+
+#define MAX_SKIPPED_PASSES 128
+
+struct LLVMApiModule {
+    LLVMContextRef context;         //Context owned by this module, never shared between threads
+    LLVMModuleRef module;           //Linked module as parsed from file, cloned for every candidate
+    LLVMTargetMachineRef machine;   //Host target machine, NULL if it could not be created
+    char file[300];                 //File the module was parsed from
+    char skipped[MAX_SKIPPED_PASSES][50];  //Passes the pass builder did not accept, left out of every pipeline
+    int num_skipped;
+};
+
+// legacy opt names that are spelled differently by the new pass manager
+static const char* llvm_api_renamed[][2] = {
+    {"functionattrs", "function-attrs"},
+    {"rpo-functionattrs", "rpo-function-attrs"},
+    {"loop-unswitch", "simple-loop-unswitch"},
+    {"scoped-noalias", "scoped-noalias-aa"},
+    {"basicaa", "basic-aa"}
+};
+
+static pthread_once_t llvm_api_once = PTHREAD_ONCE_INIT;
+
+static void llvm_api_init() {
+
+    LLVMInitializeNativeTarget();
+    LLVMInitializeNativeAsmPrinter();
+
+}
+
+bool llvm_api_enabled() {
+
+    return true;
+
+}
+
+static void llvm_api_pass_name(node_str* n, char* name) {
+
+    object_llvm_pass_str* pass = (object_llvm_pass_str*)OBJECT(n);
+    char* value = PASS(pass);
+
+    // opt takes -licm, the pass builder takes licm
+    while (*value == '-') {
+        value++;
+    }
+    strcpy(name, value);
+    for (int i = 0; i < sizeof(llvm_api_renamed) / sizeof(llvm_api_renamed[0]); i++) {
+        if (strcmp(name, llvm_api_renamed[i][0]) == 0) {
+            strcpy(name, llvm_api_renamed[i][1]);
+        }
+    }
+
+}
+
+static bool llvm_api_is_skipped(LLVMApiModule* m, char* name) {
+
+    for (int i = 0; i < m->num_skipped; i++) {
+        if (strcmp(m->skipped[i], name) == 0) {
+            return true;
+        }
+    }
+    return false;
+
+}
+
+static LLVMTargetMachineRef llvm_api_host_machine(LLVMModuleRef module) {
+
+    char* message = NULL;
+    char* triple = strlen(LLVMGetTarget(module)) > 0 ? LLVMCreateMessage(LLVMGetTarget(module)) : LLVMGetDefaultTargetTriple();
+    LLVMTargetRef target;
+    LLVMTargetMachineRef machine = NULL;
+
+    if (LLVMGetTargetFromTriple(triple, &target, &message) == 0) {
+        char* cpu = LLVMGetHostCPUName();
+        char* features = LLVMGetHostCPUFeatures();
+        machine = LLVMCreateTargetMachine(target, triple, cpu, features, LLVMCodeGenLevelDefault, LLVMRelocDefault, LLVMCodeModelDefault);
+        LLVMDisposeMessage(cpu);
+        LLVMDisposeMessage(features);
+    } else {
+        LLVMDisposeMessage(message);
+    }
+    LLVMDisposeMessage(triple);
+    return machine;
+
+}
+
+LLVMApiModule* llvm_api_load(char* ll_file) {
+
+    char* message = NULL;
+    LLVMMemoryBufferRef buffer;
+
+    pthread_once(&llvm_api_once, llvm_api_init);
+
+    LLVMApiModule* m = malloc(sizeof(LLVMApiModule));
+    m->context = LLVMContextCreate();
+    m->num_skipped = 0;
+    strcpy(m->file, ll_file);
+
+    if (LLVMCreateMemoryBufferWithContentsOfFile(ll_file, &buffer, &message) != 0) {
+        printf("Could not read %s for in-process optimization: %s\n", ll_file, message);
+        LLVMDisposeMessage(message);
+        LLVMContextDispose(m->context);
+        free(m);
+        return NULL;
+    }
+    // the buffer is owned by the module from here on
+    if (LLVMParseIRInContext(m->context, buffer, &m->module, &message) != 0) {
+        printf("Could not parse %s for in-process optimization: %s\n", ll_file, message);
+        LLVMDisposeMessage(message);
+        LLVMContextDispose(m->context);
+        free(m);
+        return NULL;
+    }
+    m->machine = llvm_api_host_machine(m->module);
+    return m;
+
+}
+
+bool llvm_api_loaded_from(LLVMApiModule* m, char* ll_file) {
+
+    return m != NULL && strcmp(m->file, ll_file) == 0;
+
+}
+
+/*
+ * Joins the passes of indiv that are not skipped into one pipeline string, sized from the genome
+ */
+static char* llvm_api_pipeline(LLVMApiModule* m, node_str* indiv) {
+
+    char name[50];
+    size_t length = 1;
+
+    for (node_str* n = indiv; n != NULL; n = NEXT(n)) {
+        llvm_api_pass_name(n, name);
+        length += strlen(name) + 1;
+    }
+    char* pipeline = malloc(length);
+    strcpy(pipeline, "");
+    for (node_str* n = indiv; n != NULL; n = NEXT(n)) {
+        llvm_api_pass_name(n, name);
+        if (!llvm_api_is_skipped(m, name)) {
+            if (strlen(pipeline) > 0) {
+                strcat(pipeline, ",");
+            }
+            strcat(pipeline, name);
+        }
+    }
+    return pipeline;
+
+}
+
+/*
+ * Adds every pass of indiv that the pass builder does not accept on its own to m->skipped.
+ * Each name is tried alone on an empty module, so only unknown names fail
+ */
+static void llvm_api_skip_unknown(LLVMApiModule* m, node_str* indiv, LLVMPassBuilderOptionsRef options) {
+
+    char name[50];
+    LLVMModuleRef probe = LLVMModuleCreateWithNameInContext("shackleton_probe", m->context);
+
+    for (node_str* n = indiv; n != NULL; n = NEXT(n)) {
+        llvm_api_pass_name(n, name);
+        if (llvm_api_is_skipped(m, name)) {
+            continue;
+        }
+        LLVMErrorRef error = LLVMRunPasses(probe, name, m->machine, options);
+        if (error != NULL) {
+            // analyses such as -domtree are no pipeline elements, opt only computes them on demand anyway
+            LLVMConsumeError(error);
+            if (m->num_skipped < MAX_SKIPPED_PASSES) {
+                strcpy(m->skipped[m->num_skipped++], name);
+            }
+        }
+    }
+    LLVMDisposeModule(probe);
+
+}
+
+bool llvm_api_optimize(LLVMApiModule* m, node_str* indiv, char* bc_file) {
+
+    if (OBJECT_TYPE(indiv) != LLVM_PASS) {
+        printf("Object type used was incompatible with this function. Aborting code.");
+        exit(0);
+    }
+
+    LLVMModuleRef clone = LLVMCloneModule(m->module);
+    LLVMPassBuilderOptionsRef options = LLVMCreatePassBuilderOptions();
+    char* pipeline = llvm_api_pipeline(m, indiv);
+
+    // the whole sequence is always one pipeline. If it contains a pass the pass builder does not know yet,
+    // that pass joins the skipped ones and the pipeline runs again without it on a fresh clone, so a
+    // sequence gives the same module on every worker, whichever worker met the unknown pass first
+    LLVMErrorRef error = LLVMRunPasses(clone, pipeline, m->machine, options);
+    if (error != NULL) {
+        LLVMConsumeError(error);
+        LLVMDisposeModule(clone);
+        free(pipeline);
+        llvm_api_skip_unknown(m, indiv, options);
+        clone = LLVMCloneModule(m->module);
+        pipeline = llvm_api_pipeline(m, indiv);
+        error = LLVMRunPasses(clone, pipeline, m->machine, options);
+    }
+
+    // a pipeline that still fails, for example a module pass after function passes, is left to opt
+    bool written = false;
+    if (error != NULL) {
+        LLVMConsumeError(error);
+    } else {
+        written = LLVMWriteBitcodeToFile(clone, bc_file) == 0;
+    }
+    free(pipeline);
+    LLVMDisposePassBuilderOptions(options);
+    LLVMDisposeModule(clone);
+    return written;
+
+}
+
+void llvm_api_free(LLVMApiModule* m) {
+
+    if (m == NULL) {
+        return;
+    }
+    if (m->machine != NULL) {
+        LLVMDisposeTargetMachine(m->machine);
+    }
+    LLVMDisposeModule(m->module);
+    LLVMContextDispose(m->context);
+    free(m);
+
+}
+
+#else
+
+// built without LLVM_API=1, every candidate goes through the opt binary
+
+bool llvm_api_enabled() {
+
+    return false;
+
+}
+
+LLVMApiModule* llvm_api_load(char* ll_file) {
+
+    return NULL;
+
+}
+
+bool llvm_api_loaded_from(LLVMApiModule* m, char* ll_file) {
+
+    return false;
+
+}
+
+bool llvm_api_optimize(LLVMApiModule* m, node_str* indiv, char* bc_file) {
+
+    return false;
+
+}
+
+void llvm_api_free(LLVMApiModule* m) {
+
+}
+
+#endif
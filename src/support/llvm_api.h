@@ -0,0 +1,26 @@
+#ifndef SUPPORT_LLVM_API_H_
+#define SUPPORT_LLVM_API_H_
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include "../osaka/osaka.h"
+#include "../module/llvm_pass.h"
+
+/*
+ * In-process replacement for the opt step, only available when Shackleton
+ * is built with LLVM_API=1 (see the makefile). The linked module is parsed
+ * once into an LLVMApiModule and every candidate is optimized on a clone of it.
+ * An LLVMApiModule owns its own LLVM context, so it may only be used by one
+ * thread at a time
+ */
+typedef struct LLVMApiModule LLVMApiModule;
+
+bool llvm_api_enabled();
+LLVMApiModule* llvm_api_load(char* ll_file);
+bool llvm_api_loaded_from(LLVMApiModule* m, char* ll_file);
+bool llvm_api_optimize(LLVMApiModule* m, node_str* indiv, char* bc_file);
+void llvm_api_free(LLVMApiModule* m);
+
+#endif /* SUPPORT_LLVM_API_H_ */
@@ -360,7 +360,7 @@ void test_llvm_form_test_command() {
 void test_onepoint_crossover(uint32_t indiv_size, osaka_object_typ ot, bool vis) {
 
     node_str* my_generation[2];
-    generate_new_generation(my_generation, 2, indiv_size, ot);
+    generate_new_generation(my_generation, 2, indiv_size, ot, false, NULL, 0);
 
     // perform twopoint crossover where the points do not have to be the same across both individuals
     crossover_onepoint_macro(my_generation[0], my_generation[1], vis);
@@ -405,7 +405,7 @@ void test_making_generation(uint32_t gen_size, uint32_t indiv_size, osaka_object
 
     // create generation of variable size of osaka structures
     node_str* my_generation[gen_size];
-    generate_new_generation(my_generation, gen_size, indiv_size, ot);
+    generate_new_generation(my_generation, gen_size, indiv_size, ot, false, NULL, 0);
 
     // print every individual in the generation
     if (vis) {
@@ -462,7 +462,7 @@ void test_basic_mutation(uint32_t indiv_size, osaka_object_typ ot, bool vis) {
 
     // initialize a generation with only 1 individual
     node_str* my_generation[1];
-    generate_new_generation(my_generation, 1, indiv_size, ot);
+    generate_new_generation(my_generation, 1, indiv_size, ot, false, NULL, 0);
 
     // changes all the parameters of a randomly chosen node in the individual
     uint32_t new_item = (uint32_t) (osaka_listlength(my_generation[0]) * (rand() / (RAND_MAX + 1.0)) + 1);
@@ -513,7 +513,7 @@ void test_crossover_twopoint_diff(uint32_t indiv_size, osaka_object_typ ot, bool
 
     // create generation with only 2 individuals
     node_str* my_generation[2];
-    generate_new_generation(my_generation, 2, indiv_size, ot);
+    generate_new_generation(my_generation, 2, indiv_size, ot, false, NULL, 0);
 
     // perform twopoint crossover where the points do not have to be the same across both individuals
     crossover_twopoint_diff(my_generation[0], my_generation[1], vis);
@@ -564,7 +564,7 @@ void test_copy_generation(uint32_t pop_size, uint32_t indiv_size, osaka_object_t
     node_str* orig_gen[pop_size];
     node_str* new_gen[pop_size];
 
-    generate_new_generation(orig_gen, pop_size, indiv_size, ot);
+    generate_new_generation(orig_gen, pop_size, indiv_size, ot, false, NULL, 0);
 
     if (vis) {
         
@@ -648,13 +648,13 @@ void test_selection_tournament(uint32_t pop_size, uint32_t indiv_size, uint32_t
     double fitness_values[pop_size];
 
     node_str* gen[pop_size];
-    generate_new_generation(gen, pop_size, indiv_size, ot);
+    generate_new_generation(gen, pop_size, indiv_size, ot, false, NULL, 0);
 
     for (uint32_t k = 0; k < pop_size; k++) {
-        fitness_values[k] = fitness_top(gen[k], false, file, src_files, num_src_files, false, NULL, NULL, NULL, 40);
+        fitness_values[k] = fitness_top(gen[k], false, file, src_files, num_src_files, false, NULL, NULL, NULL, 40, 0, false);
         printf("\n%f\n", fitness_values[k]);
 
-        fitness_top(gen[k], false, file, src_files, num_src_files, false, NULL, NULL, NULL, 40);
+        fitness_top(gen[k], false, file, src_files, num_src_files, false, NULL, NULL, NULL, 40, 0, false);
     }
 
     if (vis) {
@@ -746,10 +746,10 @@ void test_selection_tournament_multiple(uint32_t pop_size, uint32_t indiv_size,
 
     node_str* gen[pop_size];
     double fitness_values[pop_size];
-    generate_new_generation(gen, pop_size, indiv_size, ot);
+    generate_new_generation(gen, pop_size, indiv_size, ot, false, NULL, 0);
 
     for (uint32_t k = 0; k < pop_size; k++) {
-        fitness_values[k] = fitness_top(gen[k], false, file, src_files, num_src_files, false, NULL, NULL, NULL, 40);
+        fitness_values[k] = fitness_top(gen[k], false, file, src_files, num_src_files, false, NULL, NULL, NULL, 40, 0, false);
     }
 
     winner1_ind = selection_tournament(gen, fitness_values, winner1, pop_size, tourn_size, vis);
@@ -842,7 +842,7 @@ void test_generate_free_individual_inside_array(uint32_t pop_size, uint32_t indi
     uint32_t copy_size = pop_size;
 
     node_str* gen[pop_size];
-    generate_new_generation(gen, pop_size, indiv_size, ot);
+    generate_new_generation(gen, pop_size, indiv_size, ot, false, NULL, 0);
 
     if (vis) {
 
@@ -991,7 +991,7 @@ void test_evolution_basic_crossover_and_mutation(uint32_t num_gens, uint32_t pop
  *
  */
 
-void test_evolution_basic_crossover_and_mutation_with_replacement(uint32_t num_gens, uint32_t pop_size, uint32_t indiv_size, uint32_t tourn_size, uint32_t mut_perc, uint32_t cross_perc, uint32_t elite_perc, osaka_object_typ ot, bool vis, char* file, char** src_files, uint32_t num_src_files, bool cache, double* track_fitness) {
+void test_evolution_basic_crossover_and_mutation_with_replacement(uint32_t num_gens, uint32_t pop_size, uint32_t indiv_size, uint32_t tourn_size, uint32_t mut_perc, uint32_t cross_perc, uint32_t elite_perc, osaka_object_typ ot, bool vis, char* file, char** src_files, uint32_t num_src_files, bool cache, double* track_fitness, const char* cache_id, const char** levels, const int num_levels) {
 
     if (vis) {
 
@@ -999,13 +999,11 @@ void test_evolution_basic_crossover_and_mutation_with_replacement(uint32_t num_g
     
     }
 
-    node_str* best_indiv = evolution_basic_crossover_and_mutation_with_replacement(num_gens, pop_size, indiv_size, tourn_size, mut_perc, cross_perc, elite_perc, ot, vis, file, src_files, num_src_files, cache, track_fitness, NULL);
+    int gen_evolved = evolution_basic_crossover_and_mutation_with_replacement(num_gens, pop_size, indiv_size, tourn_size, mut_perc, cross_perc, elite_perc, ot, vis, file, src_files, num_src_files, cache, track_fitness, cache_id, levels, num_levels);
 
     if (vis) {
 
-        printf("Best individual that was passed back to the test: ------------------------------------\n\n");
-        visualization_print_individual_concise_details(best_indiv);
-        printf("\n\n--------------------------------------------------------------------------------------\n\n");
+        printf("Generations evolved by the run of the test: %d -------------------------------------------\n\n", gen_evolved);
 
     }
 
@@ -1015,7 +1013,740 @@ void test_evolution_basic_crossover_and_mutation_with_replacement(uint32_t num_g
 
     }
 
-    generate_free_individual(best_indiv);
+}
+
+/*
+ * NAME
+ *
+ *   test_osaka_splice_index
+ *
+ * DESCRIPTION
+ *
+ *  Tests that osaka_splice keeps the indexes of both lists right, so that
+ *  osaka_listlength and osaka_nthnode agree with walking the lists, for
+ *  every crossover point
+ *
+ * PARAMETERS
+ *
+ *  uint32_t indiv_size -- size of the shorter individual
+ *  osaka_object_typ ot -- object type to be created
+ *  bool vis -- whether or not visualization is enabled
+ *
+ * RETURN
+ *
+ *  none
+ *
+ * EXAMPLE
+ *
+ * test_osaka_splice_index(10, LLVM_PASS, false);
+ *
+ * SIDE-EFFECT
+ *
+ *  aborts the run if an index does not match its list
+ *
+ */
+
+void test_osaka_splice_index(uint32_t indiv_size, osaka_object_typ ot, bool vis) {
+
+    if (vis) {
+
+        printf("Testing the list index across osaka_splice -------------------------------------------\n\n");
+
+    }
+
+    uint32_t length[2] = {indiv_size, indiv_size + 3};
+
+    for (uint32_t nth = 2; nth <= indiv_size; nth++) {
+
+        node_str* indiv[2];
+        node_str* before[2][indiv_size + 3];
+
+        // the indexes are built before the splice, so it has to keep them up to date
+        for (uint32_t i = 0; i < 2; i++) {
+            indiv[i] = generate_new_individual(length[i], ot);
+            osaka_nthnode(indiv[i], 1);
+            node_str* n = indiv[i];
+            for (uint32_t k = 0; k < length[i]; k++) {
+                before[i][k] = n;
+                n = NEXT(n);
+            }
+        }
+
+        osaka_splice(indiv[0], indiv[1], nth);
+
+        for (uint32_t i = 0; i < 2; i++) {
+
+            // the head of list i is kept and the tail of the other list follows it from node nth on
+            uint32_t other = 1 - i;
+            if (osaka_listlength(indiv[i]) != length[other]) {
+                printf("osaka_splice at node %d left list %d with length %d instead of %d.\n\nAborting code\n\n", nth, i + 1, osaka_listlength(indiv[i]), length[other]);
+                exit(1);
+            }
+            node_str* n = indiv[i];
+            for (uint32_t k = 0; k < length[other]; k++) {
+                node_str* expected = k < nth - 1 ? before[i][k] : before[other][k];
+                if (n != expected || osaka_nthnode(indiv[i], k + 1) != expected) {
+                    printf("osaka_splice at node %d left node %d of list %d out of its index.\n\nAborting code\n\n", nth, k + 1, i + 1);
+                    exit(1);
+                }
+                n = NEXT(n);
+            }
+            if (n != NULL) {
+                printf("osaka_splice at node %d left list %d longer than its index.\n\nAborting code\n\n", nth, i + 1);
+                exit(1);
+            }
+
+        }
+
+        generate_free_individual(indiv[0]);
+        generate_free_individual(indiv[1]);
+
+    }
+
+    if (vis) {
+
+        printf("Testing the list index across osaka_splice complete ----------------------------------\n\n");
+
+    }
+
+}
+
+/*
+ * NAME
+ *
+ *   test_genome_crossover_onepoint
+ *
+ * DESCRIPTION
+ *
+ *  Tests that onepoint crossover of two flat genomes gives the same
+ *  individuals as crossover_onepoint_macro on their lists, when both
+ *  draw the crossover point from the same state of rand()
+ *
+ * PARAMETERS
+ *
+ *  uint32_t indiv_size -- size of the shorter individual
+ *  bool vis -- whether or not visualization is enabled
+ *
+ * RETURN
+ *
+ *  none
+ *
+ * EXAMPLE
+ *
+ * test_genome_crossover_onepoint(10, false);
+ *
+ * SIDE-EFFECT
+ *
+ *  aborts the run if the two crossovers differ
+ *
+ */
+
+void test_genome_crossover_onepoint(uint32_t indiv_size, bool vis) {
+
+    if (vis) {
+
+        printf("Testing onepoint crossover of flat genomes -------------------------------------------\n\n");
+
+    }
+
+    for (uint32_t t = 0; t < 20; t++) {
+
+        // the longer individual is the first one half of the time
+        node_str* indiv1 = generate_new_individual(t % 2 == 0 ? indiv_size : indiv_size + 4, LLVM_PASS);
+        node_str* indiv2 = generate_new_individual(t % 2 == 0 ? indiv_size + 4 : indiv_size, LLVM_PASS);
+        Genome* genome1 = genome_from_individual(indiv1);
+        Genome* genome2 = genome_from_individual(indiv2);
+
+        unsigned int seed = rand();
+        srand(seed);
+        genome_crossover_onepoint(&genome1, &genome2, false);
+        srand(seed);
+        crossover_onepoint_macro(indiv1, indiv2, false);
+
+        Genome* expected1 = genome_from_individual(indiv1);
+        Genome* expected2 = genome_from_individual(indiv2);
+        if (!genome_compare(genome1, expected1) || !genome_compare(genome2, expected2)) {
+            printf("genome_crossover_onepoint and crossover_onepoint_macro differ for seed %u.\n\nAborting code\n\n", seed);
+            exit(1);
+        }
+
+        genome_free(genome1);
+        genome_free(genome2);
+        genome_free(expected1);
+        genome_free(expected2);
+        generate_free_individual(indiv1);
+        generate_free_individual(indiv2);
+
+    }
+
+    if (vis) {
+
+        printf("Testing onepoint crossover of flat genomes complete ----------------------------------\n\n");
+
+    }
+
+}
+
+/*
+ * NAME
+ *
+ *   test_runstats_estimate
+ *
+ * DESCRIPTION
+ *
+ *  Tests every fitness estimator and its analytic interval on fixed
+ *  runtimes with one outlier, the bounds for fewer than two runtimes,
+ *  and that the same seed gives the same bootstrap interval
+ *
+ * PARAMETERS
+ *
+ *  bool vis -- whether or not visualization is enabled
+ *
+ * RETURN
+ *
+ *  none
+ *
+ * EXAMPLE
+ *
+ * test_runstats_estimate(false);
+ *
+ * SIDE-EFFECT
+ *
+ *  aborts the run if an estimate or interval is off, estimator_settings
+ *  is restored afterwards
+ *
+ */
+
+void test_runstats_estimate(bool vis) {
+
+    if (vis) {
+
+        printf("Testing the fitness estimators -------------------------------------------------------\n\n");
+
+    }
+
+    EstimatorSettings saved = estimator_settings;
+    double runtimes[10] = {5, 1, 4, 2, 3, 100, 6, 7, 8, 9};
+    double low, high;
+
+    // expected values worked out by hand, t quantiles as in runstats_t95
+    struct {
+        fitness_estimator estimator;
+        double estimate, low, high;
+    } cases[4] = {
+        {ESTIMATOR_MEAN, 14.5, 0.0, 36.068222388504810},               //t interval, its low end cut at 0
+        {ESTIMATOR_MEDIAN, 5.5, 1.0, 100.0},                           //order statistics 1 and 10 of 10
+        {ESTIMATOR_TRIMMED, 5.5, 2.922800999631576, 8.077199000368424}, //one runtime trimmed from each end, Yuen interval
+        {ESTIMATOR_MIN_OF, 3.5, 0.0, 35.265}                           //mean of the minima 1 and 6 of the two groups
+    };
+
+    estimator_settings.trim = 0.1;
+    estimator_settings.min_of = 5;
+    estimator_settings.interval = INTERVAL_ANALYTIC;
+    for (uint32_t c = 0; c < 4; c++) {
+        estimator_settings.estimator = cases[c].estimator;
+        double estimate = runstats_estimate(runtimes, 10, &low, &high, 1);
+        if (fabs(estimate - cases[c].estimate) > 1e-6 || fabs(low - cases[c].low) > 1e-6 || fabs(high - cases[c].high) > 1e-6) {
+            printf("Estimator %d gave %f in [%f, %f] instead of %f in [%f, %f].\n\nAborting code\n\n", cases[c].estimator, estimate, low, high, cases[c].estimate, cases[c].low, cases[c].high);
+            exit(1);
+        }
+    }
+
+    // a single runtime is its own estimate, without a bound on the interval, and no runtime is a failed individual
+    estimator_settings.estimator = ESTIMATOR_MEAN;
+    if (runstats_estimate(runtimes, 1, &low, &high, 1) != 5.0 || low != 0.0 || high != UINT32_MAX ||
+        runstats_estimate(runtimes, 0, &low, &high, 1) != UINT32_MAX || low != 0.0 || high != UINT32_MAX) {
+        printf("runstats_estimate of fewer than two runtimes has the wrong bounds.\n\nAborting code\n\n");
+        exit(1);
+    }
+
+    estimator_settings.estimator = ESTIMATOR_MEDIAN;
+    estimator_settings.interval = INTERVAL_BOOTSTRAP;
+    estimator_settings.resamples = 200;
+    double first_low, first_high;
+    double estimate = runstats_estimate(runtimes, 10, &first_low, &first_high, 42);
+    runstats_estimate(runtimes, 10, &low, &high, 42);
+    if (estimate != 5.5 || low != first_low || high != first_high || low > high || low < 1.0 || high > 100.0) {
+        printf("The bootstrap interval [%f, %f] of the median is not repeatable or out of range.\n\nAborting code\n\n", first_low, first_high);
+        exit(1);
+    }
+
+    estimator_settings = saved;
+
+    if (vis) {
+
+        printf("Testing the fitness estimators complete ----------------------------------------------\n\n");
+
+    }
+
+}
+
+/*
+ * NAME
+ *
+ *   test_node_find_index
+ *
+ * DESCRIPTION
+ *
+ *  Tests that node_find, which looks individuals up by the hash of their
+ *  passes, finds the same id as comparing the sequence to every individual
+ *  of the registry in order, while two registries grow side by side
+ *
+ * PARAMETERS
+ *
+ *  uint32_t num_lookups -- number of random sequences looked up
+ *  bool vis -- whether or not visualization is enabled
+ *
+ * RETURN
+ *
+ *  none
+ *
+ * EXAMPLE
+ *
+ * test_node_find_index(500, false);
+ *
+ * SIDE-EFFECT
+ *
+ *  aborts the run if the two lookups differ
+ *
+ */
+
+void test_node_find_index(uint32_t num_lookups, bool vis) {
+
+    if (vis) {
+
+        printf("Testing lookups in the individual registry -------------------------------------------\n\n");
+
+    }
+
+    // two registries are looked up in turn, as node_find and node_add take the registry they search
+    int hash_cap[2] = {16, 16};
+    int max_id[2] = {0, 0};
+    DataNode** all_indiv[2] = {calloc(hash_cap[0], sizeof(DataNode*)), calloc(hash_cap[1], sizeof(DataNode*))};
+
+    for (uint32_t t = 0; t < num_lookups; t++) {
+
+        // sequences of one to three passes, so the same sequence comes up again often
+        node_str* sequence = generate_new_individual(rand() % 3 + 1, LLVM_PASS);
+        uint32_t r = rand() % 2;
+
+        int expected = -1;
+        for (int i = 0; i < max_id[r]; i++) {
+            if (node_match(all_indiv[r][i], sequence)) {
+                expected = i;
+                break;
+            }
+        }
+        int found = node_find(all_indiv[r], max_id[r], sequence);
+        if (found != expected) {
+            printf("node_find gave id %d instead of %d after %d individuals.\n\nAborting code\n\n", found, expected, max_id[r]);
+            exit(1);
+        }
+
+        // half of the sequences join the registry, a known one keeps its id
+        if (rand() % 2 == 0) {
+            int added = node_add(sequence, &max_id[r], &hash_cap[r], &all_indiv[r]);
+            if (added != (expected >= 0 ? expected : max_id[r] - 1)) {
+                printf("node_add gave id %d to a sequence found at id %d.\n\nAborting code\n\n", added, expected);
+                exit(1);
+            }
+        }
+        generate_free_individual(sequence);
+
+    }
+
+    for (uint32_t r = 0; r < 2; r++) {
+        free_all_nodes(all_indiv[r], max_id[r]);
+        free(all_indiv[r]);
+    }
+
+    if (vis) {
+
+        printf("Testing lookups in the individual registry complete ----------------------------------\n\n");
+
+    }
+
+}
+
+/*
+ * NAME
+ *
+ *   test_node_fold
+ *
+ * DESCRIPTION
+ *
+ *  Tests that an individual evaluated many times keeps at most NODE_MAX_ROWS
+ *  rows, and that its median and mean over every runtime stay the same as
+ *  over a copy of all of them, while the runtimes of other individuals that
+ *  are never timed again push the sample buffer past its memory budget
+ *
+ * PARAMETERS
+ *
+ *  uint32_t num_evals -- number of evaluations of the individual
+ *  bool vis -- whether or not visualization is enabled
+ *
+ * RETURN
+ *
+ *  none
+ *
+ * EXAMPLE
+ *
+ * test_node_fold(60, false);
+ *
+ * SIDE-EFFECT
+ *
+ *  aborts the run if the rows grow or an estimate is off, estimator_settings
+ *  and sample_settings are restored and the sample buffer is emptied afterwards
+ *
+ */
+
+void test_node_fold(uint32_t num_evals, bool vis) {
+
+    if (vis) {
+
+        printf("Testing folded evaluations -----------------------------------------------------------\n\n");
+
+    }
+
+    EstimatorSettings saved_estimator = estimator_settings;
+    SampleSettings saved_samples = sample_settings;
+    char folder[] = "/tmp/shackleton_test_XXXXXX";
+    const uint32_t runs = 40;
+    const uint32_t cold_runs = 4096;
+
+    if (mkdtemp(folder) == NULL) {
+        printf("Could not create a folder for the sample buffer.\n\nAborting code\n\n");
+        exit(1);
+    }
+    // 1 MB holds 16 segments, the cold runtimes fill that after a few evaluations
+    sample_settings.memory_mb = 1;
+    samples_open(folder);
+    estimator_settings.estimator = ESTIMATOR_MEDIAN;
+    estimator_settings.interval = INTERVAL_ANALYTIC;
+
+    node_str* seq = generate_new_individual(5, LLVM_PASS);
+    DataNode* d = node_new_allele(seq, 0);
+    double* all = malloc(sizeof(double) * runs * num_evals);
+    double* copy = malloc(sizeof(double) * runs * num_evals);
+    double* runtimes = malloc(sizeof(double) * cold_runs);
+    double* first_cold = malloc(sizeof(double) * cold_runs);
+    uint64_t first_cold_at = 0;
+    uint32_t n = 0;
+
+    for (uint32_t e = 0; e < num_evals; e++) {
+
+        // the runtimes of an individual that is dropped right after it was timed
+        for (uint32_t r = 0; r < cold_runs; r++) {
+            runtimes[r] = rand() % 1000;
+        }
+        uint64_t at = samples_append(runtimes, cold_runs);
+        if (e == 0) {
+            first_cold_at = at;
+            memcpy(first_cold, runtimes, sizeof(double) * cold_runs);
+        }
+
+        double sum = 0.0;
+        for (uint32_t r = 0; r < runs; r++) {
+            runtimes[r] = (rand() % 1000) / 10.0 + e;
+            all[n + r] = runtimes[r];
+            sum += runtimes[r];
+        }
+        n += runs;
+        node_record_data(d, d->seq, runtimes, sum / runs, runs, e, false);
+
+        double low, high;
+        memcpy(copy, all, sizeof(double) * n);
+        double expected = runstats_estimate(copy, n, &low, &high, 1);
+        if (d->capacity > NODE_MAX_ROWS || d->num_eval != (int)e + 1 || d->num_eval - d->folded > NODE_MAX_ROWS) {
+            printf("After %u evaluations the individual has %d rows for %d evaluations.\n\nAborting code\n\n", e + 1, d->capacity, d->num_eval);
+            exit(1);
+        }
+        if (d->fitness != expected || d->fitness_low != low || d->fitness_high != high) {
+            printf("After %u evaluations the median is %f in [%f, %f] instead of %f in [%f, %f].\n\nAborting code\n\n", e + 1, d->fitness, d->fitness_low, d->fitness_high, expected, low, high);
+            exit(1);
+        }
+
+    }
+
+    // the mean comes from the totals, which still count the folded evaluations
+    estimator_settings.estimator = ESTIMATOR_MEAN;
+    double sum = 0.0;
+    for (uint32_t r = 0; r < n; r++) {
+        sum += all[r];
+    }
+    if (d->total_run != (int)n || fabs(node_estimate(d) - sum / n) > 1e-9) {
+        printf("The mean over %d runs is %f instead of %f over %u runs.\n\nAborting code\n\n", d->total_run, node_estimate(d), sum / n, n);
+        exit(1);
+    }
+
+    // the first cold runtimes were written out long ago and come back from the spill file
+    samples_read(first_cold_at, cold_runs, runtimes);
+    if (memcmp(runtimes, first_cold, sizeof(double) * cold_runs) != 0) {
+        printf("The runtimes read back from the spill file differ from the ones appended.\n\nAborting code\n\n");
+        exit(1);
+    }
+
+    free(all);
+    free(copy);
+    free(runtimes);
+    free(first_cold);
+    free_node(d);
+    generate_free_individual(seq);
+    samples_close();
+    rmdir(folder);
+    estimator_settings = saved_estimator;
+    sample_settings = saved_samples;
+
+    if (vis) {
+
+        printf("Testing folded evaluations complete --------------------------------------------------\n\n");
+
+    }
+
+}
+
+/*
+ * NAME
+ *
+ *   test_checkpoint_round_trip
+ *
+ * DESCRIPTION
+ *
+ *  Tests that a registry, population and rand() state written by two
+ *  checkpoints come back unchanged from checkpoint_load, that the second
+ *  checkpoint only appends the individuals that changed, and that what was
+ *  appended to the node log and samples.bin after it is dropped
+ *
+ * PARAMETERS
+ *
+ *  uint32_t num_indiv -- number of individuals in the first checkpoint
+ *  bool vis -- whether or not visualization is enabled
+ *
+ * RETURN
+ *
+ *  none
+ *
+ * EXAMPLE
+ *
+ * test_checkpoint_round_trip(40, false);
+ *
+ * SIDE-EFFECT
+ *
+ *  aborts the run if anything differs after loading, rand() is moved onto
+ *  the checkpoint state buffer and estimator_settings is restored afterwards
+ *
+ */
+
+void test_checkpoint_round_trip(uint32_t num_indiv, bool vis) {
+
+    if (vis) {
+
+        printf("Testing checkpoints --------------------------------------------------------------------\n\n");
+
+    }
+
+    EstimatorSettings saved_estimator = estimator_settings;
+    char folder[] = "/tmp/shackleton_test_XXXXXX";
+    char files[3][100];
+
+    if (mkdtemp(folder) == NULL) {
+        printf("Could not create a run folder for the checkpoint.\n\nAborting code\n\n");
+        exit(1);
+    }
+    snprintf(files[0], sizeof(files[0]), "%s/checkpoint.bin", folder);
+    snprintf(files[1], sizeof(files[1]), "%s/checkpoint_nodes.bin", folder);
+    snprintf(files[2], sizeof(files[2]), "%s/samples.bin", folder);
+    // the median keeps the runtimes of folded evaluations, so their block is checkpointed too
+    estimator_settings.estimator = ESTIMATOR_MEDIAN;
+    estimator_settings.interval = INTERVAL_ANALYTIC;
+    samples_open(folder);
+    checkpoint_init_random();
+
+    const uint32_t pop_size = 4;
+    const uint32_t num_elites = 2;
+    const uint32_t num_gens = 3;
+    const int num_levels = 2;
+    int hash_cap = 16;
+    int max_id = 0;
+    DataNode** all_indiv = calloc(hash_cap, sizeof(DataNode*));
+    node_str* current_generation[pop_size];
+    int current_gen_id[pop_size];
+    double fitness_values[pop_size];
+    int elite_indx[num_elites];
+    int elite_id[num_elites];
+    double track_fitness[num_levels + 1 + num_gens];
+    double lowest = UINT32_MAX;
+    int stale_counter = 0;
+    EvolutionState state = {.next_gen = 0, .pop_size = pop_size, .num_gens = num_gens, .ot = LLVM_PASS, .num_elites = num_elites, .num_levels = num_levels,
+                            .current_generation = current_generation, .current_gen_id = current_gen_id, .fitness_values = fitness_values,
+                            .elite_indx = elite_indx, .elite_id = elite_id, .all_indiv = &all_indiv, .max_id = &max_id, .hash_cap = &hash_cap,
+                            .track_fitness = track_fitness, .lowest = &lowest, .stale_counter = &stale_counter};
+    double runtimes[40];
+    long log_size[2];
+
+    for (int phase = 0; phase < 2; phase++) {
+
+        // the second checkpoint adds a few individuals and times a few known ones again
+        uint32_t num_new = phase == 0 ? num_indiv : num_indiv / 8;
+        for (uint32_t i = 0; i < num_new; i++) {
+            node_str* seq = generate_new_individual(rand() % 5 + 1, LLVM_PASS);
+            node_add(seq, &max_id, &hash_cap, &all_indiv);
+            generate_free_individual(seq);
+        }
+        for (int id = 0; id < max_id; id++) {
+            DataNode* d = all_indiv[id];
+            int num_evals = phase == 0 ? rand() % 20 : (rand() % 8 == 0);
+            for (int e = 0; e < num_evals; e++) {
+                // some evaluations fail without a successful run
+                int runs = rand() % 4 == 0 ? 0 : rand() % 40 + 1;
+                double sum = 0.0;
+                for (int r = 0; r < runs; r++) {
+                    runtimes[r] = (rand() % 1000) / 10.0;
+                    sum += runtimes[r];
+                }
+                node_record_data(d, d->seq, runtimes, runs > 0 ? sum / runs : UINT32_MAX, runs, phase * 20 + e, rand() % 2 == 0);
+                node_record_usage(d, rand() % 100 / 10.0, rand() % 100 / 10.0, rand() % 10000);
+            }
+            if (phase == 0 && rand() % 2 == 0) {
+                d->proxy = rand() % 1000;
+            }
+        }
+        for (uint32_t k = 0; k < pop_size; k++) {
+            current_gen_id[k] = rand() % max_id;
+            current_generation[k] = all_indiv[current_gen_id[k]]->seq;
+            fitness_values[k] = all_indiv[current_gen_id[k]]->fitness;
+            node_increment_gen(all_indiv[current_gen_id[k]]);
+        }
+        for (uint32_t k = 0; k < num_elites; k++) {
+            elite_indx[k] = k;
+            elite_id[k] = current_gen_id[k];
+        }
+        for (int t = 0; t < num_levels + 1 + (int)num_gens; t++) {
+            track_fitness[t] = rand() % 1000;
+        }
+        lowest = rand() % 1000;
+        stale_counter = phase + 1;
+        state.next_gen = phase + 1;
+        checkpoint_save(folder, &state);
+
+        FILE* log = fopen(files[1], "rb");
+        fseek(log, 0, SEEK_END);
+        log_size[phase] = ftell(log);
+        fclose(log);
+
+    }
+
+    // a full rewrite would write every individual again
+    if (log_size[1] - log_size[0] <= 0 || log_size[1] - log_size[0] >= log_size[0]) {
+        printf("The second checkpoint wrote %ld bytes of individuals after %ld for the first.\n\nAborting code\n\n", log_size[1] - log_size[0], log_size[0]);
+        exit(1);
+    }
+
+    // as if the run crashed while writing a later checkpoint
+    FILE* log = fopen(files[1], "ab");
+    fwrite(runtimes, sizeof(double), 5, log);
+    fclose(log);
+    uint64_t num_samples = samples_length();
+    double* all = malloc(sizeof(double) * (num_samples > 0 ? num_samples : 1));
+    samples_read(0, num_samples, all);
+    samples_append(runtimes, 40);
+    samples_flush();
+
+    int expected_rand[5];
+    for (int r = 0; r < 5; r++) {
+        expected_rand[r] = rand();
+    }
+    int saved_gen_id[pop_size];
+    double saved_fitness[pop_size];
+    int saved_elite_id[num_elites];
+    double saved_track[num_levels + 1 + num_gens];
+    memcpy(saved_gen_id, current_gen_id, sizeof(saved_gen_id));
+    memcpy(saved_fitness, fitness_values, sizeof(saved_fitness));
+    memcpy(saved_elite_id, elite_id, sizeof(saved_elite_id));
+    memcpy(saved_track, track_fitness, sizeof(saved_track));
+    double saved_lowest = lowest;
+
+    // everything is read back into a new registry, the old one is kept to compare with
+    samples_close();
+    srand(1);
+    memset(current_gen_id, 0, sizeof(current_gen_id));
+    memset(fitness_values, 0, sizeof(fitness_values));
+    memset(elite_id, 0, sizeof(elite_id));
+    memset(track_fitness, 0, sizeof(track_fitness));
+    lowest = 0;
+    stale_counter = 0;
+    int loaded_cap = 16;
+    int loaded_max_id = 0;
+    DataNode** loaded = calloc(loaded_cap, sizeof(DataNode*));
+    state.all_indiv = &loaded;
+    state.max_id = &loaded_max_id;
+    state.hash_cap = &loaded_cap;
+    state.next_gen = 0;
+    checkpoint_load(folder, &state);
+
+    if (loaded_max_id != max_id || state.next_gen != 2 || stale_counter != 2 || lowest != saved_lowest ||
+        memcmp(current_gen_id, saved_gen_id, sizeof(saved_gen_id)) != 0 || memcmp(fitness_values, saved_fitness, sizeof(saved_fitness)) != 0 ||
+        memcmp(elite_id, saved_elite_id, sizeof(saved_elite_id)) != 0 || memcmp(track_fitness, saved_track, sizeof(saved_track)) != 0) {
+        printf("The population or logged fitness values of the checkpoint did not come back.\n\nAborting code\n\n");
+        exit(1);
+    }
+    for (uint32_t k = 0; k < pop_size; k++) {
+        if (current_generation[k] != loaded[current_gen_id[k]]->seq) {
+            printf("Individual %u of the population is not the one in the registry.\n\nAborting code\n\n", k);
+            exit(1);
+        }
+    }
+    for (int id = 0; id < max_id; id++) {
+        DataNode* a = all_indiv[id];
+        DataNode* b = loaded[id];
+        int rows = a->num_eval - a->folded;
+        // compared bit for bit, the variance of an evaluation with a single run is not a number
+        double a_values[7] = {a->fitness, a->fitness_low, a->fitness_high, a->proxy, a->folded_time, a->total_time, a->total_var};
+        double b_values[7] = {b->fitness, b->fitness_low, b->fitness_high, b->proxy, b->folded_time, b->total_time, b->total_var};
+        bool same = osaka_compare(a->seq, b->seq) && a->seq_id == b->seq_id && memcmp(a_values, b_values, sizeof(a_values)) == 0 &&
+                    a->tot_gen == b->tot_gen && a->num_eval == b->num_eval && a->folded == b->folded && a->folded_runs == b->folded_runs &&
+                    a->folded_at == b->folded_at && a->total_run == b->total_run && memcmp(&a->stats, &b->stats, sizeof(a->stats)) == 0 &&
+                    memcmp(a->sample_at, b->sample_at, sizeof(uint64_t) * rows) == 0 && memcmp(a->success_cts, b->success_cts, sizeof(int) * rows) == 0 &&
+                    memcmp(a->avg_time, b->avg_time, sizeof(double) * rows) == 0 && memcmp(a->var, b->var, sizeof(double) * rows) == 0 &&
+                    memcmp(a->utime, b->utime, sizeof(double) * rows) == 0 && memcmp(a->stime, b->stime, sizeof(double) * rows) == 0 &&
+                    memcmp(a->maxrss, b->maxrss, sizeof(long) * rows) == 0 && memcmp(a->status, b->status, sizeof(eval_status) * rows) == 0 &&
+                    memcmp(a->gens, b->gens, sizeof(int) * rows) == 0;
+        if (!same) {
+            printf("Individual %d with %d evaluations differs after loading the checkpoint.\n\nAborting code\n\n", id, a->num_eval);
+            exit(1);
+        }
+    }
+    double* back = malloc(sizeof(double) * (num_samples > 0 ? num_samples : 1));
+    samples_read(0, num_samples, back);
+    if (samples_length() != num_samples || memcmp(all, back, sizeof(double) * num_samples) != 0) {
+        printf("samples.bin holds %lu runtimes after loading instead of the %lu of the checkpoint.\n\nAborting code\n\n", (unsigned long)samples_length(), (unsigned long)num_samples);
+        exit(1);
+    }
+    for (int r = 0; r < 5; r++) {
+        if (rand() != expected_rand[r]) {
+            printf("rand() does not continue where the checkpoint left it.\n\nAborting code\n\n");
+            exit(1);
+        }
+    }
+
+    free(all);
+    free(back);
+    free_all_nodes(all_indiv, max_id);
+    free(all_indiv);
+    free_all_nodes(loaded, loaded_max_id);
+    free(loaded);
+    samples_close();
+    for (int i = 0; i < 3; i++) {
+        unlink(files[i]);
+    }
+    rmdir(folder);
+    estimator_settings = saved_estimator;
+
+    if (vis) {
+
+        printf("Testing checkpoints complete -----------------------------------------------------------\n\n");
+
+    }
 
 }
 
@@ -1086,7 +1817,7 @@ void test_system() {
  *
  */
 
-void test_master(uint32_t num_gens, uint32_t pop_size, uint32_t indiv_size, uint32_t tourn_size, uint32_t mut_perc, uint32_t cross_perc, uint32_t elite_perc, osaka_object_typ ot, bool vis, char* file, char** src_files, uint32_t num_src_files, bool cache, double* track_fitness) {
+void test_master(uint32_t num_gens, uint32_t pop_size, uint32_t indiv_size, uint32_t tourn_size, uint32_t mut_perc, uint32_t cross_perc, uint32_t elite_perc, osaka_object_typ ot, bool vis, char* file, char** src_files, uint32_t num_src_files, bool cache, double* track_fitness, const char* cache_id, const char** levels, const int num_levels) {
 
     //* Main Shackleton tests 
     //test_basic_printing(indiv_size, ot, vis);
@@ -1098,7 +1829,13 @@ void test_master(uint32_t num_gens, uint32_t pop_size, uint32_t indiv_size, uint
     //test_selection_tournament(4, 4, 2, ot, vis, file, src_files, num_src_files);
     //test_selection_tournament_multiple(pop_size, 5, tourn_size, ot, vis, file, src_files, num_src_files);
     //test_generate_free_individual_inside_array(pop_size, 20, ot, vis);
-    test_evolution_basic_crossover_and_mutation_with_replacement(num_gens, pop_size, indiv_size, tourn_size, mut_perc, cross_perc, elite_perc, ot, vis, file, src_files, num_src_files, cache, track_fitness);
+    test_osaka_splice_index(10, ot, vis);
+    test_genome_crossover_onepoint(10, vis);
+    test_runstats_estimate(vis);
+    test_node_find_index(500, vis);
+    test_node_fold(60, vis);
+    test_checkpoint_round_trip(40, vis);
+    test_evolution_basic_crossover_and_mutation_with_replacement(num_gens, pop_size, indiv_size, tourn_size, mut_perc, cross_perc, elite_perc, ot, vis, file, src_files, num_src_files, cache, track_fitness, cache_id, levels, num_levels);
     //*/
 
     //* LLVM specific tests
@@ -498,7 +498,204 @@ void test_evolution_basic_crossover_and_mutation(uint32_t pop_size, uint32_t num
  *
  */
 
-void test_evolution_basic_crossover_and_mutation_with_replacement(uint32_t num_gens, uint32_t pop_size, uint32_t indiv_size, uint32_t tourn_size, uint32_t mut_perc, uint32_t cross_perc, uint32_t elite_perc, osaka_object_typ ot, bool vis, char* file, char** src_files, uint32_t num_src_files, bool cache, double* track_fitness);
+void test_evolution_basic_crossover_and_mutation_with_replacement(uint32_t num_gens, uint32_t pop_size, uint32_t indiv_size, uint32_t tourn_size, uint32_t mut_perc, uint32_t cross_perc, uint32_t elite_perc, osaka_object_typ ot, bool vis, char* file, char** src_files, uint32_t num_src_files, bool cache, double* track_fitness, const char* cache_id, const char** levels, const int num_levels);
+
+/*
+ * NAME
+ *
+ *   test_osaka_splice_index
+ *
+ * DESCRIPTION
+ *
+ *  Tests that osaka_splice keeps the indexes of both lists right, so that
+ *  osaka_listlength and osaka_nthnode agree with walking the lists, for
+ *  every crossover point
+ *
+ * PARAMETERS
+ *
+ *  uint32_t indiv_size -- size of the shorter individual
+ *  osaka_object_typ ot -- object type to be created
+ *  bool vis -- whether or not visualization is enabled
+ *
+ * RETURN
+ *
+ *  none
+ *
+ * EXAMPLE
+ *
+ * test_osaka_splice_index(10, LLVM_PASS, false);
+ *
+ * SIDE-EFFECT
+ *
+ *  aborts the run if an index does not match its list
+ *
+ */
+
+void test_osaka_splice_index(uint32_t indiv_size, osaka_object_typ ot, bool vis);
+
+/*
+ * NAME
+ *
+ *   test_genome_crossover_onepoint
+ *
+ * DESCRIPTION
+ *
+ *  Tests that onepoint crossover of two flat genomes gives the same
+ *  individuals as crossover_onepoint_macro on their lists, when both
+ *  draw the crossover point from the same state of rand()
+ *
+ * PARAMETERS
+ *
+ *  uint32_t indiv_size -- size of the shorter individual
+ *  bool vis -- whether or not visualization is enabled
+ *
+ * RETURN
+ *
+ *  none
+ *
+ * EXAMPLE
+ *
+ * test_genome_crossover_onepoint(10, false);
+ *
+ * SIDE-EFFECT
+ *
+ *  aborts the run if the two crossovers differ
+ *
+ */
+
+void test_genome_crossover_onepoint(uint32_t indiv_size, bool vis);
+
+/*
+ * NAME
+ *
+ *   test_runstats_estimate
+ *
+ * DESCRIPTION
+ *
+ *  Tests every fitness estimator and its analytic interval on fixed
+ *  runtimes with one outlier, the bounds for fewer than two runtimes,
+ *  and that the same seed gives the same bootstrap interval
+ *
+ * PARAMETERS
+ *
+ *  bool vis -- whether or not visualization is enabled
+ *
+ * RETURN
+ *
+ *  none
+ *
+ * EXAMPLE
+ *
+ * test_runstats_estimate(false);
+ *
+ * SIDE-EFFECT
+ *
+ *  aborts the run if an estimate or interval is off, estimator_settings
+ *  is restored afterwards
+ *
+ */
+
+void test_runstats_estimate(bool vis);
+
+/*
+ * NAME
+ *
+ *   test_node_find_index
+ *
+ * DESCRIPTION
+ *
+ *  Tests that node_find, which looks individuals up by the hash of their
+ *  passes, finds the same id as comparing the sequence to every individual
+ *  of the registry in order, while two registries grow side by side
+ *
+ * PARAMETERS
+ *
+ *  uint32_t num_lookups -- number of random sequences looked up
+ *  bool vis -- whether or not visualization is enabled
+ *
+ * RETURN
+ *
+ *  none
+ *
+ * EXAMPLE
+ *
+ * test_node_find_index(500, false);
+ *
+ * SIDE-EFFECT
+ *
+ *  aborts the run if the two lookups differ
+ *
+ */
+
+void test_node_find_index(uint32_t num_lookups, bool vis);
+
+/*
+ * NAME
+ *
+ *   test_node_fold
+ *
+ * DESCRIPTION
+ *
+ *  Tests that an individual evaluated many times keeps at most NODE_MAX_ROWS
+ *  rows, and that its median and mean over every runtime stay the same as
+ *  over a copy of all of them, while the runtimes of other individuals that
+ *  are never timed again push the sample buffer past its memory budget
+ *
+ * PARAMETERS
+ *
+ *  uint32_t num_evals -- number of evaluations of the individual
+ *  bool vis -- whether or not visualization is enabled
+ *
+ * RETURN
+ *
+ *  none
+ *
+ * EXAMPLE
+ *
+ * test_node_fold(60, false);
+ *
+ * SIDE-EFFECT
+ *
+ *  aborts the run if the rows grow or an estimate is off, estimator_settings
+ *  and sample_settings are restored and the sample buffer is emptied afterwards
+ *
+ */
+
+void test_node_fold(uint32_t num_evals, bool vis);
+
+/*
+ * NAME
+ *
+ *   test_checkpoint_round_trip
+ *
+ * DESCRIPTION
+ *
+ *  Tests that a registry, population and rand() state written by two
+ *  checkpoints come back unchanged from checkpoint_load, that the second
+ *  checkpoint only appends the individuals that changed, and that what was
+ *  appended to the node log and samples.bin after it is dropped
+ *
+ * PARAMETERS
+ *
+ *  uint32_t num_indiv -- number of individuals in the first checkpoint
+ *  bool vis -- whether or not visualization is enabled
+ *
+ * RETURN
+ *
+ *  none
+ *
+ * EXAMPLE
+ *
+ * test_checkpoint_round_trip(40, false);
+ *
+ * SIDE-EFFECT
+ *
+ *  aborts the run if anything differs after loading, rand() is moved onto
+ *  the checkpoint state buffer and estimator_settings is restored afterwards
+ *
+ */
+
+void test_checkpoint_round_trip(uint32_t num_indiv, bool vis);
 
 /*
  * NAME
@@ -534,6 +731,6 @@ void test_evolution_basic_crossover_and_mutation_with_replacement(uint32_t num_g
  *
  */
 
-void test_master(uint32_t num_gens, uint32_t pop_size, uint32_t indiv_size, uint32_t tourn_size, uint32_t mut_perc, uint32_t cross_perc, uint32_t elite_perc, osaka_object_typ ot, bool vis, char* file, char** src_files, uint32_t num_src_files, bool cache, double* track_fitness);
+void test_master(uint32_t num_gens, uint32_t pop_size, uint32_t indiv_size, uint32_t tourn_size, uint32_t mut_perc, uint32_t cross_perc, uint32_t elite_perc, osaka_object_typ ot, bool vis, char* file, char** src_files, uint32_t num_src_files, bool cache, double* track_fitness, const char* cache_id, const char** levels, const int num_levels);
 
 #endif /* SUPPORT_TEST_H_ */